@@ -0,0 +1,560 @@
+//
+// Created by docto on 10/19/2026.
+//
+// End-to-end crawl throughput against a local synthetic site, one CSV row per thread count:
+//   CrawlHarness [--threads 1,2,4,8] [--hosts n] [--pages-per-host n] [--page-size bytes]
+//                [--fanout n] [--shape random|tree|powerlaw] [--latency-us n] [--latency-spread x]
+//                [--error-rate x] [--sitemaps] [--traps] [--redirects] [--changing x] [--change-interval-ms n]
+//                [--recrawl seconds] [--budget pages/s] [--warc] [--store] [--dns] [--max-pages n] [--crawler path]
+//                [--serve] [--check]
+// Each run starts a fresh WebCrawler process, so CPU time and peak RSS cover that process alone
+// (graph analysis and export included). Pages/sec and latency come from its final metrics dump.
+// --sitemaps lists every page in gzipped sitemaps, so the crawl is seeded in bulk up front.
+// --traps adds crawler traps to every page (an endless calendar, faceted search, session IDs);
+// trap_dropped counts the links the crawler refused as a result.
+// --redirects adds links that redirect, many of them to the same page; redirects counts
+// the hops the crawler followed and redirect_dups the chains it cut short at a page
+// already crawled.
+// --warc runs every thread count a second time with WARC archiving on; warc_pages_per_sec
+// next to pages_per_sec shows what the archive costs the crawl. --store does the same
+// with the page store on, in store_pages_per_sec.
+// --dns names the hosts host<n>.crawl.test and has the crawler resolve them through a stub
+// DNS server (see StubDnsServer); pages also link to a host that does not exist.
+// --recrawl runs the crawler in continuous mode for that long instead of one pass; with
+// --changing some pages change over time, and the revisit columns show how many fetches
+// found new content.
+// --serve only runs the site and prints its URLs until interrupted.
+// --check runs short crawls that verify behaviour instead of measuring it, one line per
+// check, and exits with 1 if any fails.
+
+#include "export/pagestore.h"
+#include "stubdnsserver.h"
+#include "syntheticserver.h"
+#include <chrono>
+#include <csignal>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifndef WEBCRAWLER_BINARY
+#define WEBCRAWLER_BINARY "WebCrawler"
+#endif
+
+namespace {
+    constexpr const char* DNS_ZONE = "crawl.test";
+
+    struct RunResult {
+        bool ok = false;
+        double pages = 0;
+        double errors = 0;
+        double seconds = 0;
+        double p50 = 0;
+        double p99 = 0;
+        double wallSeconds = 0;  // Whole process lifetime, the denominator for cpu_percent
+        double cpuSeconds = 0;
+        double maxRssMb = 0;
+        double revisits = 0;
+        double unchangedRevisits = 0;
+        double trapDropped = 0;
+        double redirects = 0;
+        double redirectDuplicates = 0;
+    };
+
+    std::vector<size_t> parseList(const std::string& text) {
+        std::vector<size_t> values;
+        std::istringstream stream(text);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            if (!item.empty()) values.push_back(std::stoull(item));
+        }
+        return values;
+    }
+
+    // Picks single values out of the Prometheus text written by CrawlMetrics
+    double metricValue(const std::string& metrics, const std::string& name) {
+        const size_t pos = metrics.find("\n" + name + " ");
+        if (pos == std::string::npos) return 0.0;
+        return std::stod(metrics.substr(pos + name.size() + 2));
+    }
+
+    std::string readFile(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        std::stringstream content;
+        content << file.rdbuf();
+        return content.str();
+    }
+
+    // The crawler's standard output is kept in dir/crawl.log
+    RunResult runCrawler(const std::string& crawler, const std::string& seedUrl, size_t threads, size_t maxPages,
+                         const std::vector<std::string>& extraArgs, const std::filesystem::path& dir) {
+        RunResult result;
+        const std::string metricsFile = (dir / "metrics.prom").string();
+        const std::string outputFile = (dir / "results.json").string();
+        const std::string logFile = (dir / "crawl.log").string();
+        std::vector<std::string> args = {
+            crawler, "-u", seedUrl, "-d", "1000", "-p", std::to_string(maxPages),
+            "-t", std::to_string(threads), "--delay", "0", "-o", outputFile, "--metrics", metricsFile
+        };
+        args.insert(args.end(), extraArgs.begin(), extraArgs.end());
+
+        const auto start = std::chrono::steady_clock::now();
+        const pid_t pid = ::fork();
+        if (pid < 0) return result;
+        if (pid == 0) {
+            const int devNull = ::open("/dev/null", O_RDWR);
+            const int log = ::open(logFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            ::dup2(devNull, STDIN_FILENO);
+            ::dup2(log >= 0 ? log : devNull, STDOUT_FILENO);
+            ::dup2(devNull, STDERR_FILENO);
+            std::vector<char*> argv;
+            for (const auto& arg : args) argv.push_back(const_cast<char*>(arg.c_str()));
+            argv.push_back(nullptr);
+            ::execv(crawler.c_str(), argv.data());
+            ::_exit(127);
+        }
+
+        int status = 0;
+        rusage usage{};
+        if (::wait4(pid, &status, 0, &usage) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            return result;
+        }
+        result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.cpuSeconds = static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+                            static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+        result.maxRssMb = static_cast<double>(usage.ru_maxrss) / 1024.0;  // Kilobytes on Linux
+
+        const std::string text = "\n" + readFile(metricsFile);
+        result.pages = metricValue(text, "webcrawler_pages_total");
+        result.errors = metricValue(text, "webcrawler_errors_total");
+        result.seconds = metricValue(text, "webcrawler_uptime_seconds");
+        result.p50 = metricValue(text, "webcrawler_stage_seconds{stage=\"total\",quantile=\"0.5\"}");
+        result.p99 = metricValue(text, "webcrawler_stage_seconds{stage=\"total\",quantile=\"0.99\"}");
+        result.revisits = metricValue(text, "webcrawler_revisits_total");
+        result.unchangedRevisits = metricValue(text, "webcrawler_unchanged_revisits_total");
+        result.trapDropped = metricValue(text, "webcrawler_trap_dropped_urls_total");
+        result.redirects = metricValue(text, "webcrawler_redirects_followed_total");
+        result.redirectDuplicates = metricValue(text, "webcrawler_redirect_duplicates_total");
+        result.ok = result.seconds > 0;
+        return result;
+    }
+
+    // A zone in which every host of the --dns site resolves to 127.0.0.1
+    StubDnsServer::Options dnsZone(size_t hosts) {
+        StubDnsServer::Options zone;
+        zone.zone = DNS_ZONE;
+        for (size_t host = 0; host < hosts; ++host) {
+            StubDnsServer::Record record;
+            record.addresses = {"127.0.0.1"};
+            zone.records["host" + std::to_string(host) + "." + DNS_ZONE] = record;
+        }
+        return zone;
+    }
+
+    std::vector<std::string> dnsArgs(const StubDnsServer& dns) {
+        return {"--dns-server", dns.address(), "--allow-host", std::string("*.") + DNS_ZONE};
+    }
+
+    bool reportCheck(const std::string& check, bool ok, const std::string& detail) {
+        std::cout << check << ": " << (ok ? "ok" : "FAILED") << " (" << detail << ")" << std::endl;
+        return ok;
+    }
+
+    // The resolver against the stub: record TTLs honoured, NXDOMAIN cached from the SOA and
+    // links to that host dropped, and a truncated answer still used
+    bool checkDns(const std::string& crawler, const std::filesystem::path& dir) {
+        SyntheticServer::Options site;
+        site.hosts = 3;
+        site.pagesPerHost = 100;
+        site.crossHostLinks = 0.2;
+        site.errorRate = 0.0;
+        site.domain = DNS_ZONE;
+        SyntheticServer server(site);
+
+        auto zone = dnsZone(site.hosts);
+        const std::string shortLived = server.hostName(0);
+        const std::string truncated = server.hostName(1);
+        const std::string missing = std::string("missing.") + DNS_ZONE;
+        zone.records[shortLived].ttl = 1;
+        zone.records[truncated].addresses = {"127.0.0.1", "127.0.0.2", "127.0.0.3"};
+        zone.records[truncated].truncated = true;
+        StubDnsServer dns(zone);
+
+        // Paced so the crawl outlives the short TTL a few times over
+        auto args = dnsArgs(dns);
+        args.insert(args.end(), {"--delay", "20"});
+        const auto run = runCrawler(crawler, server.hostUrl(0), 2, 200, args, dir);
+        if (!run.ok) return reportCheck("dns", false, "crawl failed");
+        const std::string log = readFile(dir / "crawl.log");
+
+        bool ok = true;
+        const size_t refreshes = dns.queries(shortLived);
+        const auto maxRefreshes = static_cast<size_t>(run.wallSeconds) + 2;
+        ok &= reportCheck("dns ttl", refreshes >= 2 && refreshes <= maxRefreshes,
+                     shortLived + " with a 1s TTL queried " + std::to_string(refreshes) + " times in " +
+                     std::to_string(run.wallSeconds) + "s");
+        const size_t stable = dns.queries(server.hostName(2));
+        ok &= reportCheck("dns cache", stable <= 1, server.hostName(2) + " queried " + std::to_string(stable) + " times");
+        const size_t negative = dns.queries(missing);
+        const bool dropped = log.find(" 0 links to missing hosts dropped") == std::string::npos &&
+                             log.find("links to missing hosts dropped") != std::string::npos;
+        ok &= reportCheck("dns nxdomain", negative == 1 && dropped,
+                     missing + " queried " + std::to_string(negative) + " times, its links " +
+                     (dropped ? "dropped" : "not dropped"));
+        size_t truncatedPages = 0;
+        std::istringstream lines(log);
+        for (std::string line; std::getline(lines, line);) {
+            if (line.rfind("Crawled: http://" + truncated, 0) == 0 && line.find("| Status: 200 |") != std::string::npos) {
+                ++truncatedPages;
+            }
+        }
+        const bool truncatedCrawled = truncatedPages > 0;
+        ok &= reportCheck("dns truncated", truncatedCrawled,
+                     std::to_string(truncatedPages) + " pages of " + truncated + " crawled from a truncated answer");
+        return ok;
+    }
+
+    // Seeds and --path targets given in a non-canonical form still name their graph nodes
+    bool checkSeedForms(const std::string& crawler, const std::filesystem::path& dir) {
+        SyntheticServer::Options site;
+        site.hosts = 1;
+        site.pagesPerHost = 50;
+        site.shape = SyntheticServer::Shape::Tree;  // So the root surely links to page 1
+        SyntheticServer server(site);
+
+        std::string seed = server.hostUrl(0);
+        seed.pop_back();  // No trailing slash
+        const std::string target = server.hostUrl(0) + "page/1#top";
+        const auto run = runCrawler(crawler, seed, 2, 20, {"--path", target}, dir);
+        if (!run.ok) return reportCheck("seed form", false, "crawl failed");
+
+        const std::string results = readFile(dir / "results.json");
+        size_t unreached = 0;
+        for (size_t pos = results.find("\"click_depth\": -1"); pos != std::string::npos;
+             pos = results.find("\"click_depth\": -1", pos + 1)) {
+            ++unreached;
+        }
+        const bool pathFound = readFile(dir / "crawl.log").find("Click path (1 clicks)") != std::string::npos;
+        bool ok = reportCheck("seed depth", unreached == 0,
+                              std::to_string(unreached) + " pages without a click depth from " + seed);
+        ok &= reportCheck("seed path", pathFound, std::string(pathFound ? "" : "no ") + "click path to " + target);
+        return ok;
+    }
+
+    // Number printed after label in the crawl log; -1 if it is missing
+    long long loggedCount(const std::string& log, const std::string& label) {
+        const size_t pos = log.find(label);
+        return pos == std::string::npos ? -1 : std::stoll(log.substr(pos + label.size()));
+    }
+
+    // Pages that redirect count once against --max-pages, however many hops they take
+    bool checkRedirectBudget(const std::string& crawler, const std::filesystem::path& dir) {
+        SyntheticServer::Options site;
+        site.hosts = 2;
+        site.pagesPerHost = 500;
+        site.redirects = true;
+        SyntheticServer server(site);
+
+        constexpr size_t MAX_PAGES = 600;
+        const auto run = runCrawler(crawler, server.hostUrl(0), 4, MAX_PAGES, {}, dir);
+        if (!run.ok) return reportCheck("redirect budget", false, "crawl failed");
+        const std::string log = readFile(dir / "crawl.log");
+        const long long visited = loggedCount(log, "crawl completed. Visited ");
+        const long long crawled = loggedCount(log, "Total pages crawled: ");
+        return reportCheck("redirect budget", visited == static_cast<long long>(MAX_PAGES) && crawled == visited,
+                           "visited " + std::to_string(visited) + ", crawled " + std::to_string(crawled) +
+                           " of " + std::to_string(MAX_PAGES) + " pages after " +
+                           std::to_string(static_cast<size_t>(run.redirects)) + " redirects");
+    }
+
+    // A 3xx with no Location is the page's final answer, not a hop back to itself
+    bool checkRedirectWithoutLocation(const std::string& crawler, const std::filesystem::path& dir) {
+        SyntheticServer::Options site;
+        site.hosts = 1;
+        site.pagesPerHost = 50;
+        site.redirects = true;
+        SyntheticServer server(site);
+
+        const auto run = runCrawler(crawler, server.hostUrl(0), 2, 100, {}, dir);
+        if (!run.ok) return reportCheck("redirect without location", false, "crawl failed");
+        size_t answered = 0;
+        std::istringstream lines(readFile(dir / "crawl.log"));
+        for (std::string line; std::getline(lines, line);) {
+            if (line.find("/choices/") != std::string::npos && line.find("| Status: 300 |") != std::string::npos) {
+                ++answered;
+            }
+        }
+        const bool hops = readFile(dir / "results.json").find("\"status_code\": 300}") != std::string::npos;
+        return reportCheck("redirect without location", answered > 0 && !hops,
+                           std::to_string(answered) + " pages answered 300, " +
+                           (hops ? "some recorded as a redirect hop" : "none recorded as a redirect hop"));
+    }
+
+    // Every hop of a redirect chain is archived, so a replay of the URL a chain started at
+    // finds its 3xx
+    bool checkWarcRedirects(const std::string& crawler, const std::filesystem::path& dir) {
+        SyntheticServer::Options site;
+        site.hosts = 1;
+        site.pagesPerHost = 50;
+        site.redirects = true;
+        SyntheticServer server(site);
+
+        const std::string prefix = (dir / "archive").string();
+        const auto run = runCrawler(crawler, server.hostUrl(0), 2, 100, {"--warc", prefix}, dir);
+        if (!run.ok) return reportCheck("warc redirects", false, "crawl failed");
+        const std::string cdx = readFile(prefix + ".cdx");
+        const std::string results = readFile(dir / "results.json");
+        size_t hops = 0;
+        size_t missing = 0;
+        const std::string key = "{\"from\": \"";
+        for (size_t pos = results.find(key); pos != std::string::npos; pos = results.find(key, pos + 1)) {
+            const size_t start = pos + key.size();
+            const std::string from = results.substr(start, results.find('"', start) - start);
+            ++hops;
+            if (cdx.find(" " + from + " ") == std::string::npos) ++missing;
+        }
+        return reportCheck("warc redirects", hops > 0 && missing == 0,
+                           std::to_string(hops - missing) + " of " + std::to_string(hops) + " redirect hops archived");
+    }
+
+    // The page store written during a crawl reads back every body as the site served it
+    bool checkPageStore(const std::string& crawler, const std::filesystem::path& dir) {
+        SyntheticServer::Options site;
+        site.hosts = 2;
+        site.pagesPerHost = 200;
+        site.redirects = true;
+        SyntheticServer server(site);
+
+        const std::filesystem::path storeDir = dir / "store";
+        const auto run = runCrawler(crawler, server.hostUrl(0), 2, 300, {"--store", storeDir.string()}, dir);
+        if (!run.ok) return reportCheck("page store", false, "crawl failed");
+        size_t pages = 0;
+        size_t mismatched = 0;
+        try {
+            const PageStore store = PageStore::open(storeDir.string());
+            for (const auto url : store.urls()) {
+                ++pages;
+                const auto body = store.get(url);
+                if (!body || *body != server.body(std::string(url))) ++mismatched;
+            }
+            return reportCheck("page store", pages > 0 && mismatched == 0,
+                               std::to_string(pages - mismatched) + " of " + std::to_string(pages) + " pages in " +
+                               std::to_string(store.bodyCount()) + " bodies read back as served");
+        } catch (const std::exception& e) {
+            return reportCheck("page store", false, e.what());
+        }
+    }
+
+    // In continuous mode a URL whose fetch throws (here: its host does not exist) is still
+    // rescheduled, backing off, instead of being left in flight for the rest of the run
+    bool checkRecrawlFailure(const std::string& crawler, const std::filesystem::path& dir) {
+        StubDnsServer dns(dnsZone(1));
+        const std::string seed = std::string("http://missing.") + DNS_ZONE + "/";
+        auto args = dnsArgs(dns);
+        args.insert(args.end(), {"--recrawl", "--duration", "5", "--budget", "50", "--min-revisit", "1"});
+        const auto run = runCrawler(crawler, seed, 1, 100, args, dir);
+        if (!run.ok) return reportCheck("recrawl failure", false, "crawl failed");
+
+        const std::string log = readFile(dir / "crawl.log");
+        size_t attempts = 0;
+        for (size_t pos = log.find("Crawling: " + seed); pos != std::string::npos;
+             pos = log.find("Crawling: " + seed, pos + 1)) {
+            ++attempts;
+        }
+        return reportCheck("recrawl failure", attempts >= 2,
+                           seed + " fetched " + std::to_string(attempts) + " times in 5s");
+    }
+
+    bool runChecks(const std::string& crawler, const std::filesystem::path& dir) {
+        bool ok = true;
+        ok &= checkSeedForms(crawler, dir);
+        ok &= checkRedirectBudget(crawler, dir);
+        ok &= checkRedirectWithoutLocation(crawler, dir);
+        ok &= checkWarcRedirects(crawler, dir);
+        ok &= checkPageStore(crawler, dir);
+        ok &= checkDns(crawler, dir);
+        ok &= checkRecrawlFailure(crawler, dir);
+        return ok;
+    }
+
+    void printUsage(const char* program) {
+        std::cout << "Usage: " << program << " [--threads 1,2,4,8] [--hosts n] [--pages-per-host n]"
+                  << " [--page-size bytes] [--fanout n] [--shape random|tree|powerlaw] [--latency-us n]"
+                  << " [--latency-spread x] [--error-rate x] [--sitemaps] [--traps] [--redirects] [--changing x] [--change-interval-ms n]"
+                  << " [--recrawl seconds] [--budget pages/s] [--warc] [--store] [--dns] [--max-pages n] [--crawler path]"
+                  << " [--serve] [--check]\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    SyntheticServer::Options site;
+    std::vector<size_t> threadCounts = {1, 2, 4, 8};
+    size_t maxPages = 0;
+    std::string crawler = WEBCRAWLER_BINARY;
+    bool serveOnly = false;
+    size_t recrawlSeconds = 0;
+    std::string budget = "50";
+    bool warc = false;
+    bool store = false;
+    bool dns = false;
+    bool check = false;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+            if (arg == "--threads" && hasValue) {
+                threadCounts = parseList(argv[++i]);
+            } else if (arg == "--hosts" && hasValue) {
+                site.hosts = std::stoull(argv[++i]);
+            } else if (arg == "--pages-per-host" && hasValue) {
+                site.pagesPerHost = std::stoull(argv[++i]);
+            } else if (arg == "--page-size" && hasValue) {
+                site.pageSize = std::stoull(argv[++i]);
+            } else if (arg == "--fanout" && hasValue) {
+                site.fanout = std::stoull(argv[++i]);
+            } else if (arg == "--shape" && hasValue) {
+                site.shape = SyntheticServer::parseShape(argv[++i]);
+            } else if (arg == "--latency-us" && hasValue) {
+                site.latency = std::chrono::microseconds(std::stoll(argv[++i]));
+            } else if (arg == "--latency-spread" && hasValue) {
+                site.latencySpread = std::stod(argv[++i]);
+            } else if (arg == "--error-rate" && hasValue) {
+                site.errorRate = std::stod(argv[++i]);
+            } else if (arg == "--changing" && hasValue) {
+                site.changingPages = std::stod(argv[++i]);
+            } else if (arg == "--change-interval-ms" && hasValue) {
+                site.changeInterval = std::chrono::milliseconds(std::stoll(argv[++i]));
+            } else if (arg == "--recrawl" && hasValue) {
+                recrawlSeconds = std::stoull(argv[++i]);
+            } else if (arg == "--budget" && hasValue) {
+                budget = argv[++i];
+            } else if (arg == "--sitemaps") {
+                site.sitemaps = true;
+            } else if (arg == "--traps") {
+                site.traps = true;
+            } else if (arg == "--redirects") {
+                site.redirects = true;
+            } else if (arg == "--warc") {
+                warc = true;
+            } else if (arg == "--store") {
+                store = true;
+            } else if (arg == "--dns") {
+                dns = true;
+                site.domain = DNS_ZONE;
+            } else if (arg == "--check") {
+                check = true;
+            } else if (arg == "--max-pages" && hasValue) {
+                maxPages = std::stoull(argv[++i]);
+            } else if (arg == "--crawler" && hasValue) {
+                crawler = argv[++i];
+            } else if (arg == "--serve") {
+                serveOnly = true;
+            } else {
+                printUsage(argv[0]);
+                return arg == "--help" ? 0 : 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    if (maxPages == 0) {
+        maxPages = site.hosts * site.pagesPerHost;
+    }
+
+    const std::filesystem::path scratch = std::filesystem::temp_directory_path() /
+                                          ("crawlharness-" + std::to_string(::getpid()));
+    if (check) {
+        std::filesystem::create_directories(scratch);
+        const bool passed = runChecks(crawler, scratch);
+        std::filesystem::remove_all(scratch);
+        return passed ? 0 : 1;
+    }
+
+    // Block the signals before any thread starts so --serve can wait for them synchronously
+    sigset_t stopSignals;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    if (serveOnly) {
+        pthread_sigmask(SIG_BLOCK, &stopSignals, nullptr);
+    }
+
+    SyntheticServer server(site);
+
+    if (serveOnly) {
+        for (size_t host = 0; host < site.hosts; ++host) {
+            std::cout << server.hostUrl(host) << "\n";
+        }
+        std::cout << "Serving until interrupted" << std::endl;
+        int signal = 0;
+        sigwait(&stopSignals, &signal);
+        std::cout << "Served " << server.requestsServed() << " requests\n";
+        return 0;
+    }
+
+    std::filesystem::create_directories(scratch);
+
+    std::vector<std::string> extraArgs;
+    if (recrawlSeconds > 0) {
+        extraArgs = {"--recrawl", "--duration", std::to_string(recrawlSeconds), "--budget", budget,
+                     "--min-revisit", "1"};
+    }
+    std::unique_ptr<StubDnsServer> dnsServer;
+    if (dns) {
+        dnsServer = std::make_unique<StubDnsServer>(dnsZone(site.hosts));
+        const auto args = dnsArgs(*dnsServer);
+        extraArgs.insert(extraArgs.end(), args.begin(), args.end());
+    }
+
+    std::cout << "threads,pages,errors,seconds,pages_per_sec,p50_ms,p99_ms,cpu_seconds,cpu_percent,max_rss_mb,"
+                 "revisits,changed_revisits,trap_dropped,redirects,redirect_dups,warc_pages_per_sec,store_pages_per_sec\n";
+    int exitCode = 0;
+    for (size_t threads : threadCounts) {
+        const auto run = runCrawler(crawler, server.hostUrl(0), threads, maxPages, extraArgs, scratch);
+        if (!run.ok) {
+            std::cerr << "Error: crawl with " << threads << " threads failed (crawler: " << crawler << ")\n";
+            exitCode = 1;
+            continue;
+        }
+        std::cout << threads << ',' << run.pages << ',' << run.errors << ',' << run.seconds << ','
+                  << run.pages / run.seconds << ',' << run.p50 * 1e3 << ',' << run.p99 * 1e3 << ','
+                  << run.cpuSeconds << ',' << 100.0 * run.cpuSeconds / run.wallSeconds << ','
+                  << run.maxRssMb << ',' << run.revisits << ','
+                  << run.revisits - run.unchangedRevisits << ',' << run.trapDropped << ','
+                  << run.redirects << ',' << run.redirectDuplicates << ',';
+        // The same crawl again with one output on, for what it costs the crawl
+        const auto printWithOutput = [&](bool enabled, const std::string& flag, const char* name) {
+            if (!enabled) return;
+            std::vector<std::string> outputArgs = extraArgs;
+            outputArgs.insert(outputArgs.end(), {flag, (scratch / name).string()});
+            const auto run = runCrawler(crawler, server.hostUrl(0), threads, maxPages, outputArgs, scratch);
+            if (run.ok) {
+                std::cout << run.pages / run.seconds;
+            } else {
+                std::cerr << "Error: crawl with " << flag << " and " << threads << " threads failed\n";
+                exitCode = 1;
+            }
+        };
+        printWithOutput(warc, "--warc", "archive");
+        std::cout << ',';
+        printWithOutput(store, "--store", "store");
+        std::cout << std::endl;
+    }
+
+    std::filesystem::remove_all(scratch);
+    std::cerr << "(server answered " << server.requestsServed() << " requests";
+    if (dnsServer) {
+        std::cerr << ", DNS stub " << dnsServer->totalQueries() << " queries";
+    }
+    std::cerr << ")\n";
+    return exitCode;
+}
@@ -0,0 +1,96 @@
+//
+// Created by docto on 10/19/2026.
+//
+// Export throughput against raw sequential write speed, one CSV row per writer:
+//   ExportBench [records] [output directory]
+
+#include "export/serializer.h"
+#include "export/streamexport.h"
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+    std::vector<WebCrawler::CrawlResult> makeSamples() {
+        std::vector<WebCrawler::CrawlResult> samples(1024);
+        for (size_t i = 0; i < samples.size(); ++i) {
+            auto& result = samples[i];
+            result.url = "https://www.example.com/articles/" + std::to_string(i * 7919) +
+                         "/some-longer-slug-for-the-page?ref=\"feed\"&page=" + std::to_string(i % 13);
+            result.statusCode = i % 17 == 0 ? 404 : 200;
+            result.success = true;
+            result.extractedLinks.resize(i % 50);
+            result.content.resize(1000 + i * 31 % 50000);
+            if (i % 29 == 0) result.errorMessage = "Timeout was reached";
+        }
+        return samples;
+    }
+
+    void report(const char* name, size_t records, size_t bytes, double seconds) {
+        std::cout << name << ',' << records << ',' << bytes << ',' << seconds << ','
+                  << static_cast<double>(records) / seconds << ','
+                  << static_cast<double>(bytes) / seconds / (1024.0 * 1024.0) << '\n';
+    }
+
+    size_t fileSize(const std::string& filename) {
+        std::FILE* file = std::fopen(filename.c_str(), "rb");
+        if (!file) return 0;
+        std::fseek(file, 0, SEEK_END);
+        const long size = std::ftell(file);
+        std::fclose(file);
+        return size > 0 ? static_cast<size_t>(size) : 0;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const size_t records = argc > 1 ? std::stoull(argv[1]) : 10'000'000;
+    const std::string directory = argc > 2 ? argv[2] : ".";
+    const auto samples = makeSamples();
+
+    std::cout << "writer,records,bytes,seconds,records_per_sec,mb_per_sec\n";
+
+    size_t jsonBytes = 0;
+    for (auto format : {StreamingExport::Format::JsonLines, StreamingExport::Format::Csv}) {
+        const bool json = format == StreamingExport::Format::JsonLines;
+        const std::string filename = directory + (json ? "/exportbench.jsonl" : "/exportbench.csv");
+
+        StreamingExport::Options options;
+        options.format = format;
+        const auto start = std::chrono::steady_clock::now();
+        {
+            StreamingExport exporter(filename, options);
+            for (size_t i = 0; i < records; ++i) {
+                exporter.write(samples[i % samples.size()]);
+            }
+            exporter.close();
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        const size_t bytes = fileSize(filename);
+        if (json) jsonBytes = bytes;
+        report(json ? "jsonl" : "csv", records, bytes, elapsed.count());
+        std::remove(filename.c_str());
+    }
+
+    // Baseline: the same number of bytes written straight from a 1 MB block
+    {
+        const std::string filename = directory + "/exportbench.raw";
+        const auto start = std::chrono::steady_clock::now();
+        BlockWriter writer(filename);
+        std::string& out = writer.buffer();
+        for (size_t written = 0; written < jsonBytes;) {
+            const size_t chunk = std::min<size_t>(1 << 20, jsonBytes - written);
+            out.append(chunk, 'x');
+            written += chunk;
+            writer.flush();
+        }
+        writer.close();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        report("raw_write", 0, jsonBytes, elapsed.count());
+        std::remove(filename.c_str());
+    }
+
+    return 0;
+}
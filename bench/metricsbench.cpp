@@ -0,0 +1,71 @@
+//
+// Created by docto on 10/19/2026.
+//
+// Cost of the per-page instrumentation against per-page parse work:
+//   MetricsBench [pages]
+
+#include "content/contentprocessor.h"
+#include "metrics/crawlmetrics.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+
+namespace {
+    std::string makePage() {
+        std::string html = "<html><head><title>Benchmark page</title>"
+                           "<meta name=\"description\" content=\"synthetic page\"></head><body>";
+        for (int i = 0; i < 300; ++i) {
+            html += "<p>Paragraph " + std::to_string(i) + " with some words <a href=\"/article/" +
+                    std::to_string(i) + "\">link text</a></p>\n";
+        }
+        return html + "</body></html>";
+    }
+
+    double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const size_t pages = argc > 1 ? std::stoull(argv[1]) : 1'000'000;
+
+    CrawlMetrics metrics;
+    metrics.setWorkerCount(1);
+    const std::string host = "www.example.com";
+
+    // Everything WebCrawler::processUrl records for one page
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < pages; ++i) {
+        using Stage = CrawlMetrics::Stage;
+        metrics.beginHostRequest(host);
+        metrics.endHostRequest(host);
+        metrics.record(0, Stage::Dns, 20 + i % 100);
+        metrics.record(0, Stage::Connect, 500 + i % 1000);
+        metrics.record(0, Stage::FirstByte, 5000 + i % 10000);
+        metrics.record(0, Stage::Total, 9000 + i % 20000);
+        metrics.record(0, Stage::Parse, 300 + i % 500);
+        metrics.add(0, CrawlMetrics::Counter::Pages);
+        metrics.add(0, CrawlMetrics::Counter::BytesDownloaded, 30000);
+        metrics.add(0, CrawlMetrics::Counter::LinksExtracted, 300);
+        metrics.setFrontierSize(i);
+        metrics.setVisitedCount(i);
+    }
+    const double metricsNanos = secondsSince(start) * 1e9 / static_cast<double>(pages);
+
+    // Reference per-page work: content extraction on a ~20 KB page
+    const std::string page = makePage();
+    const size_t parseRuns = 200;
+    size_t words = 0;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < parseRuns; ++i) {
+        words += ContentProcessor::extractPageData(page).wordcount;
+    }
+    const double parseNanos = secondsSince(start) * 1e9 / static_cast<double>(parseRuns);
+
+    std::cout << "metric,value\n"
+              << "metrics_ns_per_page," << metricsNanos << "\n"
+              << "parse_ns_per_page," << parseNanos << "\n"
+              << "overhead_percent," << 100.0 * metricsNanos / parseNanos << "\n";
+    std::cerr << "(checksum " << words << ", " << metrics.total(CrawlMetrics::Counter::Pages) << ")\n";
+    return 0;
+}
@@ -0,0 +1,70 @@
+//
+// Created by docto on 10/19/2026.
+//
+// PageRank throughput on a synthetic power-law graph, one CSV row per thread count:
+//   PageRankBench [nodes] [average out-degree] [iterations]
+
+#include "graph/pagerank.h"
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    // R-MAT style generator: skewed quadrant choice gives a heavy-tailed degree distribution
+    CsrGraph makeGraph(size_t nodes, size_t averageDegree) {
+        std::mt19937_64 rng(42);
+        std::uniform_real_distribution<double> coin(0.0, 1.0);
+
+        size_t scale = 0;
+        while ((size_t{1} << scale) < nodes) ++scale;
+
+        std::vector<std::pair<CsrGraph::NodeId, CsrGraph::NodeId>> edges;
+        edges.reserve(nodes * averageDegree);
+        while (edges.size() < nodes * averageDegree) {
+            uint64_t source = 0;
+            uint64_t target = 0;
+            for (size_t bit = 0; bit < scale; ++bit) {
+                const double r = coin(rng);
+                source = (source << 1) | (r >= 0.57 + 0.19 ? 1 : 0);
+                target = (target << 1) | ((r >= 0.57 && r < 0.76) || r >= 0.95 ? 1 : 0);
+            }
+            if (source < nodes && target < nodes) {
+                edges.emplace_back(static_cast<CsrGraph::NodeId>(source), static_cast<CsrGraph::NodeId>(target));
+            }
+        }
+        return CsrGraph::fromEdges(nodes, edges);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const size_t nodes = argc > 1 ? std::stoull(argv[1]) : 1'000'000;
+    const size_t degree = argc > 2 ? std::stoull(argv[2]) : 16;
+    const size_t iterations = argc > 3 ? std::stoull(argv[3]) : 20;
+
+    const CsrGraph graph = makeGraph(nodes, degree);
+    std::cerr << "Graph: " << graph.nodeCount() << " nodes, " << graph.edgeCount() << " edges\n";
+
+    std::cout << "threads,iterations,seconds,iterations_per_sec,edges_per_sec\n";
+
+    const size_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<size_t> threadCounts;
+    for (size_t threads = 1; threads < maxThreads; threads *= 2) threadCounts.push_back(threads);
+    threadCounts.push_back(maxThreads);
+
+    for (size_t threads : threadCounts) {
+        PageRank::Options options;
+        options.threads = threads;
+        options.tolerance = 0.0;  // Run a fixed number of iterations
+        options.maxIterations = iterations;
+
+        const auto result = PageRank::compute(graph, options);
+        const double seconds = result.elapsed.count();
+        std::cout << threads << ',' << result.iterations << ',' << seconds << ','
+                  << static_cast<double>(result.iterations) / seconds << ','
+                  << static_cast<double>(result.iterations * graph.edgeCount()) / seconds << '\n';
+    }
+
+    return 0;
+}
@@ -0,0 +1,178 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#include "stubdnsserver.h"
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+    constexpr int POLL_INTERVAL_MS = 100;
+
+    constexpr uint16_t TYPE_A = 1;
+    constexpr uint16_t TYPE_SOA = 6;
+    constexpr uint16_t CLASS_IN = 1;
+    constexpr uint8_t RCODE_FORMERR = 1;
+    constexpr uint8_t RCODE_NXDOMAIN = 3;
+
+    void put16(std::string& out, uint16_t value) {
+        out += static_cast<char>(value >> 8);
+        out += static_cast<char>(value & 0xFF);
+    }
+
+    void put32(std::string& out, uint32_t value) {
+        put16(out, static_cast<uint16_t>(value >> 16));
+        put16(out, static_cast<uint16_t>(value & 0xFFFF));
+    }
+
+    void putName(std::string& out, const std::string& name) {
+        size_t start = 0;
+        while (start < name.size()) {
+            const size_t end = std::min(name.find('.', start), name.size());
+            out += static_cast<char>(end - start);
+            out.append(name, start, end - start);
+            start = end + 1;
+        }
+        out += '\0';
+    }
+}
+
+StubDnsServer::StubDnsServer(const Options& options) : options_(options) {
+    socket_ = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (socket_ < 0) {
+        throw std::runtime_error("Cannot create DNS socket");
+    }
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;  // Any free port
+    socklen_t length = sizeof(address);
+    if (::bind(socket_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::getsockname(socket_, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        ::close(socket_);
+        throw std::runtime_error("Cannot bind a DNS socket on 127.0.0.1");
+    }
+    port_ = ntohs(address.sin_port);
+    thread_ = std::thread(&StubDnsServer::serveLoop, this);
+}
+
+StubDnsServer::~StubDnsServer() {
+    stop();
+}
+
+void StubDnsServer::stop() {
+    if (!running_.exchange(false)) return;
+    if (thread_.joinable()) thread_.join();
+    ::close(socket_);
+}
+
+std::string StubDnsServer::address() const {
+    return "127.0.0.1:" + std::to_string(port_);
+}
+
+size_t StubDnsServer::queries(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = queries_.find(name);
+    return it == queries_.end() ? 0 : it->second;
+}
+
+size_t StubDnsServer::totalQueries() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t total = 0;
+    for (const auto& [name, count] : queries_) total += count;
+    return total;
+}
+
+void StubDnsServer::serveLoop() {
+    unsigned char buffer[512];
+    while (running_.load(std::memory_order_relaxed)) {
+        pollfd pfd{socket_, POLLIN, 0};
+        if (::poll(&pfd, 1, POLL_INTERVAL_MS) <= 0) continue;
+
+        sockaddr_storage client{};
+        socklen_t clientLength = sizeof(client);
+        const ssize_t received = ::recvfrom(socket_, buffer, sizeof(buffer), 0,
+                                            reinterpret_cast<sockaddr*>(&client), &clientLength);
+        if (received < 12) continue;
+        const std::string response = respond(buffer, static_cast<size_t>(received));
+        if (response.empty()) continue;
+        ::sendto(socket_, response.data(), response.size(), 0, reinterpret_cast<const sockaddr*>(&client), clientLength);
+    }
+}
+
+std::string StubDnsServer::respond(const unsigned char* query, size_t length) {
+    // Header: the query's ID, response bit, authoritative, recursion desired copied and available
+    std::string out(query, query + 2);
+    out += static_cast<char>(0x84 | (query[2] & 0x01));
+    out += static_cast<char>(0x80);
+    out.append(8, '\0');
+
+    std::string name;
+    size_t pos = 12;
+    while (pos < length && query[pos] != 0) {
+        const size_t label = query[pos];
+        if (label > 63 || pos + 1 + label >= length) break;
+        if (!name.empty()) name += '.';
+        for (size_t i = 0; i < label; ++i) {
+            name += static_cast<char>(std::tolower(query[pos + 1 + i]));
+        }
+        pos += 1 + label;
+    }
+    if (pos + 5 > length || query[pos] != 0) {
+        out[3] = static_cast<char>(0x80 | RCODE_FORMERR);
+        return out;
+    }
+    const uint16_t type = static_cast<uint16_t>((query[pos + 1] << 8) | query[pos + 2]);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++queries_[name];
+    }
+
+    // The question, copied as asked
+    out[5] = 1;
+    out.append(reinterpret_cast<const char*>(query) + 12, pos + 5 - 12);
+
+    auto it = options_.records.find(name);
+    if (it != options_.records.end() && type == TYPE_A && !it->second.addresses.empty()) {
+        const Record& record = it->second;
+        out[7] = static_cast<char>(record.addresses.size());
+        const size_t sent = record.truncated ? 1 : record.addresses.size();
+        if (record.truncated) out[2] = static_cast<char>(out[2] | 0x02);
+        for (size_t i = 0; i < sent; ++i) {
+            in_addr address{};
+            inet_pton(AF_INET, record.addresses[i].c_str(), &address);
+            put16(out, 0xC00C);  // Pointer to the question's name
+            put16(out, TYPE_A);
+            put16(out, CLASS_IN);
+            put32(out, record.ttl);
+            put16(out, 4);
+            out.append(reinterpret_cast<const char*>(&address), 4);
+        }
+        return out;
+    }
+
+    // No such name, or no records of this type: the zone's SOA tells how long to remember it
+    if (it == options_.records.end()) {
+        out[3] = static_cast<char>(0x80 | RCODE_NXDOMAIN);
+    }
+    out[9] = 1;
+    putName(out, options_.zone);
+    put16(out, TYPE_SOA);
+    put16(out, CLASS_IN);
+    put32(out, options_.negativeTtl);
+    std::string soa;
+    putName(soa, "ns." + options_.zone);
+    putName(soa, "hostmaster." + options_.zone);
+    for (uint32_t value : {1u, 3600u, 600u, 86400u, options_.negativeTtl}) {
+        put32(soa, value);  // Serial, refresh, retry, expire, minimum
+    }
+    put16(out, static_cast<uint16_t>(soa.size()));
+    out += soa;
+    return out;
+}
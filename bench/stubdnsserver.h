@@ -0,0 +1,60 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Loopback DNS server for offline crawls, to point the crawler's --dns-server at. Answers
+// A queries over UDP on 127.0.0.1 from a fixed table of names. Any other name gets
+// NXDOMAIN with the zone's SOA, so the negative answer carries a TTL, and other query
+// types get an empty answer with the SOA. A name marked truncated
+// is answered with the TC bit set and only its first address, as a message cut short by
+// the UDP size limit would be. Counts the queries for every name. POSIX only.
+class StubDnsServer {
+public:
+    struct Record {
+        std::vector<std::string> addresses;  // IPv4
+        uint32_t ttl = 300;
+        bool truncated = false;
+    };
+
+    struct Options {
+        std::string zone = "crawl.test";
+        std::unordered_map<std::string, Record> records;  // Lower-case names without a trailing dot
+        uint32_t negativeTtl = 3600;                      // SOA MINIMUM, the NXDOMAIN lifetime
+    };
+
+    explicit StubDnsServer(const Options& options);
+    ~StubDnsServer();
+
+    StubDnsServer(const StubDnsServer&) = delete;
+    StubDnsServer& operator=(const StubDnsServer&) = delete;
+
+    void stop();
+
+    // "127.0.0.1:port", as --dns-server takes it
+    [[nodiscard]] std::string address() const;
+    // Queries received for name, of any type
+    [[nodiscard]] size_t queries(const std::string& name) const;
+    [[nodiscard]] size_t totalQueries() const;
+
+private:
+    Options options_;
+    int socket_ = -1;
+    uint16_t port_ = 0;
+    std::atomic<bool> running_{true};
+    std::thread thread_;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, size_t> queries_;  // Guarded by mutex_
+
+    void serveLoop();
+    [[nodiscard]] std::string respond(const unsigned char* query, size_t length);
+};
@@ -0,0 +1,475 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#include "syntheticserver.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string_view>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <zlib.h>
+
+namespace {
+    constexpr int POLL_INTERVAL_MS = 100;
+    constexpr size_t MAX_REQUEST_HEADER = 16 * 1024;
+
+    constexpr const char* WORDS[] = {
+        "crawler", "index", "archive", "section", "update", "release", "network", "server", "client",
+        "request", "response", "cache", "latency", "engine", "parser", "module", "storage", "query",
+        "history", "policy", "product", "review", "market", "travel", "science", "culture", "guide"
+    };
+    constexpr size_t WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+
+    // splitmix64 over the inputs, so every page decision is a pure function of its coordinates
+    uint64_t mix(uint64_t a, uint64_t b, uint64_t c = 0, uint64_t d = 0) {
+        uint64_t x = a;
+        for (uint64_t v : {b, c, d}) {
+            x += 0x9e3779b97f4a7c15ULL + v;
+            x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+            x ^= x >> 31;
+        }
+        return x;
+    }
+
+    double unit(uint64_t hash) {
+        return static_cast<double>(hash >> 11) * 0x1.0p-53;
+    }
+
+    bool sendAll(int socket, const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            const ssize_t n = ::send(socket, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) return false;
+            sent += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    std::string gzip(const std::string& data) {
+        z_stream stream{};
+        if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            throw std::runtime_error("Failed to initialize zlib");
+        }
+        std::string out(deflateBound(&stream, static_cast<uLong>(data.size())), '\0');
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+        stream.avail_in = static_cast<uInt>(data.size());
+        stream.next_out = reinterpret_cast<Bytef*>(out.data());
+        stream.avail_out = static_cast<uInt>(out.size());
+        deflate(&stream, Z_FINISH);
+        out.resize(stream.total_out);
+        deflateEnd(&stream);
+        return out;
+    }
+
+    std::string toLower(std::string s) {
+        std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::tolower(c); });
+        return s;
+    }
+}
+
+SyntheticServer::SyntheticServer(const Options& options) : options_(options) {
+    options_.hosts = std::max<size_t>(1, options_.hosts);
+    options_.pagesPerHost = std::max<size_t>(1, options_.pagesPerHost);
+
+    for (size_t host = 0; host < options_.hosts; ++host) {
+        auto listener = std::make_unique<Listener>();
+        listener->host = host;
+        listener->socket = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (listener->socket < 0) {
+            stop();
+            throw std::runtime_error("Cannot create server socket");
+        }
+        int reuse = 1;
+        ::setsockopt(listener->socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = 0;  // Any free port
+        socklen_t length = sizeof(address);
+        if (::bind(listener->socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(listener->socket, 128) != 0 ||
+            ::getsockname(listener->socket, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+            ::close(listener->socket);
+            stop();
+            throw std::runtime_error("Cannot listen on 127.0.0.1");
+        }
+        listener->port = ntohs(address.sin_port);
+        listeners_.push_back(std::move(listener));
+    }
+
+    for (auto& listener : listeners_) {
+        listener->acceptor = std::thread(&SyntheticServer::acceptLoop, this, std::ref(*listener));
+    }
+}
+
+SyntheticServer::~SyntheticServer() {
+    stop();
+}
+
+void SyntheticServer::stop() {
+    if (!running_.exchange(false)) return;
+
+    for (auto& listener : listeners_) {
+        if (listener->acceptor.joinable()) listener->acceptor.join();
+        ::close(listener->socket);
+    }
+
+    std::vector<std::thread> connections;
+    {
+        std::lock_guard<std::mutex> lock(connectionMutex_);
+        connections.swap(connections_);
+    }
+    for (auto& connection : connections) {
+        connection.join();
+    }
+}
+
+std::string SyntheticServer::hostUrl(size_t host) const {
+    return "http://" + hostName(host) + ":" + std::to_string(listeners_.at(host)->port) + "/";
+}
+
+std::string SyntheticServer::hostName(size_t host) const {
+    return options_.domain.empty() ? std::string("127.0.0.1") : "host" + std::to_string(host) + "." + options_.domain;
+}
+
+SyntheticServer::Shape SyntheticServer::parseShape(const std::string& name) {
+    if (name == "random") return Shape::Random;
+    if (name == "tree") return Shape::Tree;
+    if (name == "powerlaw") return Shape::PowerLaw;
+    throw std::invalid_argument("Unknown site shape: " + name + " (expected random, tree or powerlaw)");
+}
+
+void SyntheticServer::acceptLoop(Listener& listener) {
+    while (running_.load(std::memory_order_relaxed)) {
+        pollfd pfd{listener.socket, POLLIN, 0};
+        if (::poll(&pfd, 1, POLL_INTERVAL_MS) <= 0) continue;
+
+        const int client = ::accept(listener.socket, nullptr, nullptr);
+        if (client < 0) continue;
+
+        std::lock_guard<std::mutex> lock(connectionMutex_);
+        connections_.emplace_back(&SyntheticServer::serveConnection, this, client, listener.host);
+    }
+}
+
+void SyntheticServer::serveConnection(int socket, size_t host) {
+    std::string buffer;
+    char chunk[4096];
+    bool keepAlive = true;
+
+    while (keepAlive && running_.load(std::memory_order_relaxed)) {
+        const size_t headerEnd = buffer.find("\r\n\r\n");
+        if (headerEnd == std::string::npos) {
+            if (buffer.size() > MAX_REQUEST_HEADER) break;
+            pollfd pfd{socket, POLLIN, 0};
+            if (::poll(&pfd, 1, POLL_INTERVAL_MS) <= 0) continue;
+            const ssize_t n = ::recv(socket, chunk, sizeof(chunk), 0);
+            if (n <= 0) break;
+            buffer.append(chunk, static_cast<size_t>(n));
+            continue;
+        }
+
+        const std::string request = buffer.substr(0, headerEnd);
+        buffer.erase(0, headerEnd + 4);
+
+        const size_t methodEnd = request.find(' ');
+        const size_t pathEnd = request.find(' ', methodEnd + 1);
+        if (methodEnd == std::string::npos || pathEnd == std::string::npos) break;
+        const std::string method = request.substr(0, methodEnd);
+        const std::string path = request.substr(methodEnd + 1, pathEnd - methodEnd - 1);
+        keepAlive = toLower(request).find("connection: close") == std::string::npos;
+
+        std::this_thread::sleep_for(hostLatency(host));
+        requests_.fetch_add(1, std::memory_order_relaxed);
+        if (!sendAll(socket, respond(host, method, path))) break;
+    }
+
+    ::close(socket);
+}
+
+std::string SyntheticServer::body(const std::string& url) const {
+    for (size_t host = 0; host < listeners_.size(); ++host) {
+        const std::string prefix = hostUrl(host);
+        if (url.rfind(prefix, 0) != 0) continue;
+        const std::string response = respond(host, "GET", "/" + url.substr(prefix.size()));
+        const size_t headersEnd = response.find("\r\n\r\n");
+        // Locations are always absolute URLs of this server
+        const size_t location = response.find("\r\nLocation: ");
+        if (location < headersEnd) {
+            const size_t start = location + 12;
+            return body(response.substr(start, response.find("\r\n", start) - start));
+        }
+        return response.substr(headersEnd + 4);
+    }
+    return {};
+}
+
+std::string SyntheticServer::respond(size_t host, const std::string& method, const std::string& path) const {
+    int status = 200;
+    std::string contentType = "text/html; charset=utf-8";
+    std::string body;
+    std::string location;
+
+    constexpr std::string_view pagePrefix = "/page/";
+    constexpr std::string_view privatePrefix = "/private/";
+    constexpr std::string_view shardPrefix = "/sitemap-";
+    const size_t shards = (options_.pagesPerHost + options_.sitemapShardSize - 1) / std::max<size_t>(1, options_.sitemapShardSize);
+    if (path == "/robots.txt") {
+        contentType = "text/plain";
+        body = renderRobots(host);
+    } else if (options_.sitemaps && path == "/sitemap.xml") {
+        contentType = "application/xml";
+        body = renderSitemapIndex(host);
+    } else if (options_.sitemaps && path.rfind(shardPrefix, 0) == 0) {
+        const size_t shard = std::strtoull(path.c_str() + shardPrefix.size(), nullptr, 10);
+        if (shard < shards) {
+            contentType = "application/gzip";
+            body = gzip(renderSitemap(host, shard));
+        } else {
+            status = 404;
+        }
+    } else if (options_.traps && path.rfind("/calendar/", 0) == 0) {
+        body = renderCalendar(host, path);
+    } else if (options_.traps && path.rfind("/search?", 0) == 0) {
+        body = renderSearch(host, path);
+    } else if (options_.redirects && path.rfind("/go/", 0) == 0) {
+        status = 301;
+        const size_t page = std::strtoull(path.c_str() + 4, nullptr, 10);
+        location = hostUrl(host) + (page > 0 ? "page/" + std::to_string(page) : std::string());
+    } else if (options_.redirects && path.rfind("/old/", 0) == 0) {
+        status = 301;
+        location = hostUrl(host) + "go/" + path.substr(5);
+    } else if (options_.redirects && path.rfind("/account/", 0) == 0) {
+        status = 302;
+        location = hostUrl(host) + "login";
+    } else if (options_.redirects && path.rfind("/choices/", 0) == 0) {
+        status = 300;  // Multiple Choices with no preferred one: no Location
+    } else if (options_.redirects && path == "/login") {
+        body = "<html><body><h1>Sign in</h1><form method=\"post\"></form></body></html>";
+    } else if (path == "/" || path.rfind(pagePrefix, 0) == 0 || path.rfind(privatePrefix, 0) == 0) {
+        size_t page = 0;
+        if (path != "/") {
+            const size_t numberStart = path.find('/', 1) + 1;
+            page = std::strtoull(path.c_str() + numberStart, nullptr, 10);
+        }
+        // The root page never fails, so every crawl gets off the ground
+        if (page >= options_.pagesPerHost) {
+            status = 404;
+        } else if (page > 0 && unit(mix(options_.seed, host, page, ~0ULL)) < options_.errorRate) {
+            status = 500;
+        } else {
+            body = renderPage(host, page);
+        }
+    } else {
+        status = 404;
+    }
+
+    if (status != 200) {
+        body = "<html><body><h1>" + std::to_string(status) + "</h1></body></html>";
+    }
+
+    const char* reason = status == 200   ? "OK"
+                         : status == 301 ? "Moved Permanently"
+                         : status == 302 ? "Found"
+                         : status == 300 ? "Multiple Choices"
+                         : status == 404 ? "Not Found"
+                                         : "Internal Server Error";
+    std::string response = "HTTP/1.1 " + std::to_string(status) + " " + reason + "\r\n"
+                           "Server: SyntheticServer\r\n";
+    if (!location.empty()) {
+        response += "Location: " + location + "\r\n";
+    }
+    response += "Content-Type: " + contentType + "\r\n"
+                "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                "Connection: keep-alive\r\n\r\n";
+    if (method != "HEAD") {
+        response += body;
+    }
+    return response;
+}
+
+std::string SyntheticServer::renderPage(size_t host, size_t page) const {
+    const size_t pages = options_.pagesPerHost;
+    auto pageUrl = [this](size_t targetHost, size_t targetPage, bool isPrivate = false) {
+        std::string url = hostUrl(targetHost);
+        if (isPrivate) {
+            url += "private/" + std::to_string(targetPage);
+        } else if (targetPage > 0) {
+            url += "page/" + std::to_string(targetPage);
+        }
+        return url;
+    };
+
+    std::vector<std::string> links;
+    links.reserve(options_.fanout + 1);
+    if (options_.shape == Shape::Tree && page > 0) {
+        links.push_back(pageUrl(host, (page - 1) / std::max<size_t>(1, options_.fanout)));
+    }
+    for (size_t i = 0; i < options_.fanout; ++i) {
+        const uint64_t r = mix(options_.seed, host, page, i);
+        // Trees keep every child link so the whole site stays reachable; their cross-host link is extra
+        const bool crossHost = unit(r) < options_.crossHostLinks;
+        if (crossHost && options_.hosts > 1 && (options_.shape != Shape::Tree || i == 0)) {
+            const size_t other = (host + 1 + mix(r, 1) % (options_.hosts - 1)) % options_.hosts;
+            links.push_back(pageUrl(other, 0));
+            if (options_.shape != Shape::Tree) continue;
+        }
+        size_t target = 0;
+        switch (options_.shape) {
+            case Shape::Random:
+                target = mix(r, 2) % pages;
+                break;
+            case Shape::Tree:
+                target = page * options_.fanout + 1 + i;
+                if (target >= pages) continue;
+                break;
+            case Shape::PowerLaw:
+                target = std::min(pages - 1, static_cast<size_t>(static_cast<double>(pages) * std::pow(unit(mix(r, 2)), 3.0)));
+                break;
+        }
+        // A few links lead into the part of the site robots.txt disallows
+        links.push_back(pageUrl(host, target, mix(r, 3) % 50 == 0));
+    }
+    if (options_.traps) {
+        const uint64_t r = mix(options_.seed, host, page, 0x7a95);
+        char session[17];
+        std::snprintf(session, sizeof(session), "%016llx", static_cast<unsigned long long>(r));
+        links.push_back(hostUrl(host) + "calendar/2024/1");
+        links.push_back(hostUrl(host) + "search?color=" + std::to_string(r % 40) + "&size=" + std::to_string(mix(r, 1) % 12));
+        links.push_back(pageUrl(host, mix(r, 2) % pages) + ";jsessionid=" + session);
+    }
+    if (options_.redirects) {
+        const uint64_t r = mix(options_.seed, host, page, 0x3e01);
+        const size_t target = static_cast<size_t>(static_cast<double>(pages) * std::pow(unit(r), 3.0));
+        links.push_back(hostUrl(host) + "go/" + std::to_string(target) + "?from=" + std::to_string(page));
+        links.push_back(hostUrl(host) + "old/" + std::to_string(mix(r, 1) % pages));
+        links.push_back(hostUrl(host) + "account/" + std::to_string(page));
+        links.push_back(hostUrl(host) + "choices/" + std::to_string(page));
+    }
+    if (!options_.domain.empty()) {
+        links.push_back("http://missing." + options_.domain + ":" + std::to_string(listeners_.at(host)->port) +
+                        "/page/" + std::to_string(page));
+    }
+
+    std::string html;
+    html.reserve(options_.pageSize + links.size() * 64 + 512);
+    html += "<!DOCTYPE html>\n<html><head><meta charset=\"utf-8\">\n<title>Host ";
+    html += std::to_string(host) + " page " + std::to_string(page);
+    html += "</title>\n<meta name=\"description\" content=\"Synthetic benchmark page\">\n</head><body>\n<nav>\n";
+    for (const auto& link : links) {
+        html += "<a href=\"" + link + "\">" + WORDS[mix(options_.seed, link.size(), page) % WORD_COUNT] + "</a>\n";
+    }
+    html += "</nav>\n<main>\n";
+    if (unit(mix(options_.seed, host, page, 0xc4a9)) < options_.changingPages) {
+        const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch());
+        const int64_t period = options_.changeInterval.count() * static_cast<int64_t>(1 + mix(options_.seed, host, page, 0xc4aa) % 4);
+        html += "<p>Revision " + std::to_string(now.count() / std::max<int64_t>(1, period)) + "</p>\n";
+    }
+
+    // Filler text up to the requested size
+    uint64_t state = mix(options_.seed, host, page, 0xfeed);
+    while (html.size() < options_.pageSize) {
+        html += "<p>";
+        for (int w = 0; w < 40; ++w) {
+            state = mix(state, w);
+            html += WORDS[state % WORD_COUNT];
+            html += ' ';
+        }
+        html += "</p>\n";
+    }
+    html += "</main>\n</body></html>\n";
+    return html;
+}
+
+// Every month and day links to the next and previous months and to a few days, forever, and
+// all of them say the same
+std::string SyntheticServer::renderCalendar(size_t host, const std::string& path) const {
+    unsigned year = 2024, month = 1;
+    std::sscanf(path.c_str(), "/calendar/%u/%u", &year, &month);
+    month = std::clamp(month, 1u, 12u);
+    const std::string base = hostUrl(host) + "calendar/";
+    const std::string next = month == 12 ? std::to_string(year + 1) + "/1" : std::to_string(year) + "/" + std::to_string(month + 1);
+    const std::string previous = month == 1 ? std::to_string(year - 1) + "/12" : std::to_string(year) + "/" + std::to_string(month - 1);
+    std::string html = "<!DOCTYPE html>\n<html><head><title>Events</title></head><body>\n"
+                       "<a href=\"" + base + next + "\">Next</a>\n"
+                       "<a href=\"" + base + previous + "\">Previous</a>\n";
+    for (unsigned day = 1; day <= 28; day += 9) {
+        html += "<a href=\"" + base + std::to_string(year) + "/" + std::to_string(month) + "/" + std::to_string(day) + "\">" +
+                std::to_string(day) + "</a>\n";
+    }
+    return html + "<p>No events.</p>\n</body></html>\n";
+}
+
+// Each result page links to more facet combinations, drawn from an unbounded value space
+std::string SyntheticServer::renderSearch(size_t host, const std::string& path) const {
+    uint64_t state = mix(options_.seed, host, std::hash<std::string>{}(path));
+    std::string html = "<!DOCTYPE html>\n<html><head><title>Search</title></head><body>\n<p>Results for " + path + "</p>\n";
+    for (int i = 0; i < 4; ++i) {
+        state = mix(state, i);
+        html += "<a href=\"" + hostUrl(host) + "search?color=" + std::to_string(state % 1000) + "&size=" +
+                std::to_string(mix(state, 1) % 12) + "&page=" + std::to_string(mix(state, 2) % 100) + "\">More</a>\n";
+    }
+    return html + "</body></html>\n";
+}
+
+std::string SyntheticServer::renderRobots(size_t host) const {
+    std::string robots = "User-agent: *\n"
+                         "Disallow: /private/\n"
+                         "Crawl-delay: 1\n";
+    if (options_.sitemaps) {
+        robots += "\nSitemap: " + hostUrl(host) + "sitemap.xml\n";
+    }
+    return robots;
+}
+
+std::string SyntheticServer::renderSitemapIndex(size_t host) const {
+    const size_t shardSize = std::max<size_t>(1, options_.sitemapShardSize);
+    std::string xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                      "<sitemapindex xmlns=\"http://www.sitemaps.org/schemas/sitemap/0.9\">\n";
+    for (size_t shard = 0; shard * shardSize < options_.pagesPerHost; ++shard) {
+        xml += "<sitemap><loc>" + hostUrl(host) + "sitemap-" + std::to_string(shard) + ".xml.gz</loc></sitemap>\n";
+    }
+    xml += "</sitemapindex>\n";
+    return xml;
+}
+
+std::string SyntheticServer::renderSitemap(size_t host, size_t shard) const {
+    const size_t shardSize = std::max<size_t>(1, options_.sitemapShardSize);
+    const size_t first = shard * shardSize;
+    const size_t last = std::min(options_.pagesPerHost, first + shardSize);
+
+    std::string xml;
+    xml.reserve((last - first) * 112 + 128);
+    xml += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+           "<urlset xmlns=\"http://www.sitemaps.org/schemas/sitemap/0.9\">\n";
+    for (size_t page = first; page < last; ++page) {
+        // Modified some time in 2024, so lastmod ordering has something to sort
+        const uint64_t day = mix(options_.seed, host, page, 0x5173) % 366;
+        const uint64_t month = day / 31 + 1;
+        const uint64_t dayOfMonth = std::min<uint64_t>(day % 31 + 1, 28);
+        char lastmod[16];
+        std::snprintf(lastmod, sizeof(lastmod), "2024-%02u-%02u", static_cast<unsigned>(month),
+                      static_cast<unsigned>(dayOfMonth));
+        xml += "<url><loc>" + hostUrl(host) + (page > 0 ? "page/" + std::to_string(page) : "") +
+               "</loc><lastmod>" + lastmod + "</lastmod></url>\n";
+    }
+    xml += "</urlset>\n";
+    return xml;
+}
+
+std::chrono::microseconds SyntheticServer::hostLatency(size_t host) const {
+    if (options_.hosts <= 1) return options_.latency;
+    const double factor = 1.0 + options_.latencySpread * static_cast<double>(host) / static_cast<double>(options_.hosts - 1);
+    return std::chrono::microseconds(static_cast<int64_t>(static_cast<double>(options_.latency.count()) * factor));
+}
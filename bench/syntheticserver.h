@@ -0,0 +1,100 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Loopback HTTP/1.1 server for offline crawl benchmarks. Each synthetic host listens on its
+// own 127.0.0.1 port and serves /robots.txt plus pages "/" and /page/<n>, and optionally a
+// sitemap index at /sitemap.xml over gzipped /sitemap-<n>.xml.gz shards. Pages and their
+// links are generated on request from the page number, so the same options always produce
+// the same site. POSIX only.
+class SyntheticServer {
+public:
+    enum class Shape {
+        Random,    // Links spread uniformly over the host's pages
+        Tree,      // Page n links to its children n*fanout+1..n*fanout+fanout and its parent
+        PowerLaw   // Links concentrate on a few hub pages, like a real site's navigation
+    };
+
+    struct Options {
+        size_t hosts = 4;
+        size_t pagesPerHost = 500;
+        size_t pageSize = 16 * 1024;         // Approximate HTML bytes per page
+        size_t fanout = 20;                  // Links per page
+        Shape shape = Shape::PowerLaw;
+        double crossHostLinks = 0.1;         // Fraction of links that point at another host
+        std::chrono::microseconds latency{2000};
+        double latencySpread = 1.0;          // The last host is (1 + spread) times slower than the first
+        double errorRate = 0.01;             // Fraction of pages answered with 500
+        // Fraction of pages whose text changes over time, each every 1-4 changeIntervals
+        double changingPages = 0.0;
+        std::chrono::milliseconds changeInterval{10000};
+        bool sitemaps = false;               // List every page in sitemaps named by robots.txt
+        size_t sitemapShardSize = 50000;     // URLs per sitemap file, the protocol's maximum
+        // Crawler traps: an endless calendar of identical pages, faceted search with random
+        // parameter values, and page links carrying session IDs
+        bool traps = false;
+        // Links that redirect: /go/N?from=M (301 to page N, so many URLs share one target),
+        // /old/N (301 to /go/N, a two-hop chain) and /account/N (302 to a login wall), plus
+        // /choices/N, a 300 with no Location to follow
+        bool redirects = false;
+        // When set, URLs name host n as host<n>.<domain> instead of 127.0.0.1, for crawls that
+        // resolve them through StubDnsServer, and every page also links to missing.<domain>,
+        // a host that does not exist
+        std::string domain;
+        uint64_t seed = 1;
+    };
+
+    explicit SyntheticServer(const Options& options);
+    ~SyntheticServer();
+
+    SyntheticServer(const SyntheticServer&) = delete;
+    SyntheticServer& operator=(const SyntheticServer&) = delete;
+
+    void stop();
+
+    [[nodiscard]] std::string hostUrl(size_t host) const;
+    [[nodiscard]] std::string hostName(size_t host) const;
+    // The body a GET of url ends at, following redirects; empty for a URL of no host of
+    // this server
+    [[nodiscard]] std::string body(const std::string& url) const;
+    [[nodiscard]] size_t requestsServed() const { return requests_.load(std::memory_order_relaxed); }
+
+    static Shape parseShape(const std::string& name);
+
+private:
+    struct Listener {
+        int socket = -1;
+        uint16_t port = 0;
+        size_t host = 0;
+        std::thread acceptor;
+    };
+
+    Options options_;
+    std::vector<std::unique_ptr<Listener>> listeners_;
+    std::atomic<bool> running_{true};
+    std::atomic<size_t> requests_{0};
+
+    std::mutex connectionMutex_;
+    std::vector<std::thread> connections_;  // Guarded by connectionMutex_
+
+    void acceptLoop(Listener& listener);
+    void serveConnection(int socket, size_t host);
+    [[nodiscard]] std::string respond(size_t host, const std::string& method, const std::string& path) const;
+    [[nodiscard]] std::string renderPage(size_t host, size_t page) const;
+    [[nodiscard]] std::string renderCalendar(size_t host, const std::string& path) const;
+    [[nodiscard]] std::string renderSearch(size_t host, const std::string& path) const;
+    [[nodiscard]] std::string renderRobots(size_t host) const;
+    [[nodiscard]] std::string renderSitemapIndex(size_t host) const;
+    [[nodiscard]] std::string renderSitemap(size_t host, size_t shard) const;
+    [[nodiscard]] std::chrono::microseconds hostLatency(size_t host) const;
+};
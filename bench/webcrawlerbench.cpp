@@ -0,0 +1,353 @@
+//
+// Created by docto on 10/19/2026.
+//
+// Microbenchmarks for the crawler hot paths, run over the checked-in corpus in bench/corpus:
+//   WebCrawlerBench [--corpus dir] [--filter text] [--min-time seconds] [--repetitions n] [--json]
+// Prints one CSV row (or one JSON object per line with --json) per benchmark. Each repetition
+// runs the benchmark until --min-time has passed; the median repetition is reported.
+
+#include "content/contentprocessor.h"
+#include "crawler/httpclient.h"
+#include "crawler/robotparser.h"
+#include "crawler/urlfilter.h"
+#include "crawler/urlparser.h"
+#include "crawler/webcrawler.h"
+#include "export/crawlexport.h"
+#include "export/serializer.h"
+#include "export/streamexport.h"
+#include "export/warcwriter.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef WEBCRAWLER_BENCH_CORPUS
+#define WEBCRAWLER_BENCH_CORPUS "bench/corpus"
+#endif
+
+namespace {
+    struct Benchmark {
+        std::string name;
+        size_t itemsPerOp = 1;
+        size_t bytesPerOp = 0;
+        // Returns a checksum so the work cannot be optimised away
+        std::function<size_t()> run;
+    };
+
+    struct Measurement {
+        size_t iterations = 0;
+        double nanosPerOp = 0.0;
+    };
+
+    struct Corpus {
+        std::vector<std::pair<std::string, std::string>> pages;        // File name, HTML
+        std::vector<std::string> absoluteUrls;
+        std::vector<std::pair<std::string, std::string>> references;   // Base URL, reference as written
+        std::string robots;
+        std::vector<std::string> headerLines;
+    };
+
+    std::string readFile(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("Cannot read corpus file " + path.string());
+        }
+        std::ostringstream content;
+        content << file.rdbuf();
+        return content.str();
+    }
+
+    Corpus loadCorpus(const std::filesystem::path& dir) {
+        Corpus corpus;
+
+        std::vector<std::filesystem::path> htmlFiles;
+        for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+            if (entry.path().extension() == ".html") htmlFiles.push_back(entry.path());
+        }
+        std::sort(htmlFiles.begin(), htmlFiles.end());
+        for (const auto& path : htmlFiles) {
+            corpus.pages.emplace_back(path.stem().string(), readFile(path));
+        }
+
+        std::istringstream urls(readFile(dir / "urls.txt"));
+        std::string line;
+        std::string base;
+        while (std::getline(urls, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            if (line.find("://") != std::string::npos) {
+                corpus.absoluteUrls.push_back(line);
+                base = line;
+            } else if (!base.empty()) {
+                corpus.references.emplace_back(base, line);
+            }
+        }
+
+        corpus.robots = readFile(dir / "robots.txt");
+
+        // Curl hands the header callback one CRLF-terminated line at a time
+        std::istringstream headers(readFile(dir / "headers.txt"));
+        while (std::getline(headers, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            corpus.headerLines.push_back(line + "\r\n");
+        }
+        return corpus;
+    }
+
+    std::vector<WebCrawler::CrawlResult> makeResults(const Corpus& corpus) {
+        std::vector<WebCrawler::CrawlResult> results;
+        for (size_t i = 0; i < corpus.absoluteUrls.size(); ++i) {
+            WebCrawler::CrawlResult result;
+            result.url = corpus.absoluteUrls[i];
+            result.statusCode = i % 17 == 0 ? 404 : 200;
+            result.success = true;
+            result.content = corpus.pages[i % corpus.pages.size()].second;
+            result.responseHeaders = "HTTP/1.1 200 OK\r\nContent-Type: text/html; charset=utf-8\r\n\r\n";
+            result.extractedLinks.resize(i % 50);
+            result.fetchTime = std::chrono::system_clock::now();
+            result.pageRank = 1.0 / static_cast<double>(i + 1);
+            result.weakComponent = 0;
+            result.strongComponent = static_cast<int64_t>(i % 7);
+            result.clickDepth = static_cast<int32_t>(i % 5);
+            results.push_back(std::move(result));
+        }
+        return results;
+    }
+
+    size_t totalLength(const std::vector<std::string>& strings) {
+        size_t total = 0;
+        for (const auto& s : strings) total += s.size();
+        return total;
+    }
+
+    Measurement measure(const Benchmark& benchmark, double minSeconds, size_t& checksum) {
+        size_t iterations = 1;
+        while (true) {
+            const auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < iterations; ++i) {
+                checksum += benchmark.run();
+            }
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (seconds >= minSeconds || iterations >= (size_t{1} << 30)) {
+                return {iterations, seconds * 1e9 / static_cast<double>(iterations)};
+            }
+            // Aim a little past the target so the next round is usually the last
+            const double scale = seconds > 0.0 ? 1.4 * minSeconds / seconds : 10.0;
+            iterations = std::max(iterations + 1, static_cast<size_t>(static_cast<double>(iterations) * std::min(scale, 10.0)));
+        }
+    }
+
+    void report(const Benchmark& benchmark, const Measurement& median, double bestNanos, bool json) {
+        const double opsPerSec = 1e9 / median.nanosPerOp;
+        const double itemsPerSec = opsPerSec * static_cast<double>(benchmark.itemsPerOp);
+        const double mbPerSec = opsPerSec * static_cast<double>(benchmark.bytesPerOp) / (1024.0 * 1024.0);
+
+        std::string out;
+        if (json) {
+            out += "{\"name\":";
+            Serializer::appendJsonString(out, benchmark.name);
+            out += ",\"iterations\":";
+            Serializer::appendNumber(out, median.iterations);
+            out += ",\"ns_per_op\":";
+            Serializer::appendNumber(out, median.nanosPerOp);
+            out += ",\"best_ns_per_op\":";
+            Serializer::appendNumber(out, bestNanos);
+            out += ",\"items_per_sec\":";
+            Serializer::appendNumber(out, itemsPerSec);
+            out += ",\"mb_per_sec\":";
+            Serializer::appendNumber(out, mbPerSec);
+            out += "}\n";
+        } else {
+            Serializer::appendCsvField(out, benchmark.name);
+            out += ',';
+            Serializer::appendNumber(out, median.iterations);
+            out += ',';
+            Serializer::appendNumber(out, median.nanosPerOp);
+            out += ',';
+            Serializer::appendNumber(out, bestNanos);
+            out += ',';
+            Serializer::appendNumber(out, itemsPerSec);
+            out += ',';
+            Serializer::appendNumber(out, mbPerSec);
+            out += '\n';
+        }
+        std::cout << out << std::flush;
+    }
+
+    std::vector<Benchmark> makeBenchmarks(const Corpus& corpus, const std::vector<WebCrawler::CrawlResult>& results,
+                                          const std::filesystem::path& scratch) {
+        std::vector<Benchmark> benchmarks;
+        const size_t urlBytes = totalLength(corpus.absoluteUrls);
+
+        benchmarks.push_back({"url/parse", corpus.absoluteUrls.size(), urlBytes, [&corpus] {
+            size_t sum = 0;
+            for (const auto& url : corpus.absoluteUrls) sum += UrlParser::parse(url).path.size();
+            return sum;
+        }});
+        benchmarks.push_back({"url/normalize", corpus.absoluteUrls.size(), urlBytes, [&corpus] {
+            size_t sum = 0;
+            for (const auto& url : corpus.absoluteUrls) sum += UrlParser::normalize(url).size();
+            return sum;
+        }});
+        // Admission with the crawler's default extensions plus a few typical patterns
+        UrlFilter::Rules rules;
+        const CrawlerConfig defaults;
+        rules.skipExtensions = defaults.skipExtensions;
+        rules.restrictHosts = true;
+        rules.allowedHosts = {"www.example.com", "*.example.com", "docs.example.org"};
+        rules.excludePatterns = {"*/login*", "*?*sessionid=*", "*/print/*", "*/page/?/*"};
+        const UrlFilter filter(rules);
+        benchmarks.push_back({"url/admit", corpus.absoluteUrls.size(), urlBytes, [&corpus, filter] {
+            size_t admitted = 0;
+            for (const auto& url : corpus.absoluteUrls) admitted += filter.admits(url) ? 1 : 0;
+            return admitted;
+        }});
+        size_t referenceBytes = 0;
+        for (const auto& [base, reference] : corpus.references) referenceBytes += reference.size();
+        benchmarks.push_back({"url/make_absolute", corpus.references.size(), referenceBytes, [&corpus] {
+            size_t sum = 0;
+            for (const auto& [base, reference] : corpus.references) sum += UrlParser::makeAbsolute(base, reference).size();
+            return sum;
+        }});
+
+        for (const auto& [name, html] : corpus.pages) {
+            const std::string baseUrl = "https://" + name + ".example.com/index.html";
+            benchmarks.push_back({"extract_links/" + name, 1, html.size(), [&html, baseUrl] {
+                return WebCrawler::extractLinks(html, baseUrl).size();
+            }});
+        }
+        for (const auto& [name, html] : corpus.pages) {
+            benchmarks.push_back({"extract_page_data/" + name, 1, html.size(), [&html] {
+                return ContentProcessor::extractPageData(html).wordcount;
+            }});
+        }
+
+        benchmarks.push_back({"robots/parse", 1, corpus.robots.size(), [&corpus] {
+            return RobotParser::parseRobot(corpus.robots, "WebCrawler").disallowedPaths.size();
+        }});
+        const auto rule = RobotParser::parseRobot(corpus.robots, "WebCrawler");
+        benchmarks.push_back({"robots/is_allowed", corpus.absoluteUrls.size(), urlBytes, [&corpus, rule] {
+            size_t allowed = 0;
+            for (const auto& url : corpus.absoluteUrls) allowed += RobotParser::isAllowed(url, rule) ? 1 : 0;
+            return allowed;
+        }});
+
+        benchmarks.push_back({"headers/parse", corpus.headerLines.size(), totalLength(corpus.headerLines), [&corpus] {
+            HttpClient::HttpResponse response;
+            for (const auto& line : corpus.headerLines) HttpClient::parseHeaderLine(line, response);
+            return response.headers.size();
+        }});
+
+        // Writers are measured end to end, file creation and flush included
+        size_t contentBytes = 0;
+        for (const auto& result : results) contentBytes += result.content.size();
+        const std::string jsonFile = (scratch / "results.json").string();
+        const std::string csvFile = (scratch / "results.csv").string();
+        const std::string streamFile = (scratch / "results.jsonl").string();
+        const std::string warcPrefix = (scratch / "results").string();
+        benchmarks.push_back({"export/json", results.size(), 0, [&results, jsonFile] {
+            CrawlExport::exportToJSON(results, jsonFile);
+            return results.size();
+        }});
+        benchmarks.push_back({"export/csv", results.size(), 0, [&results, csvFile] {
+            CrawlExport::exportToCSV(results, csvFile);
+            return results.size();
+        }});
+        benchmarks.push_back({"export/stream_jsonl", results.size(), 0, [&results, streamFile] {
+            StreamingExport stream(streamFile);
+            for (const auto& result : results) stream.write(result);
+            stream.close();
+            return stream.recordsWritten();
+        }});
+        // One core's archiving rate at the default level and at zlib's own default, to set
+        // against the crawl's pages/sec from CrawlHarness
+        const auto addWarc = [&benchmarks, &results, contentBytes, warcPrefix](const std::string& name, int level) {
+            WarcWriter::Options warcOptions;
+            warcOptions.compressionLevel = level;
+            benchmarks.push_back({name, results.size(), contentBytes, [&results, warcPrefix, warcOptions] {
+                WarcWriter warc(warcPrefix, warcOptions);
+                for (const auto& result : results) warc.write(result);
+                warc.close();
+                return warc.recordsWritten();
+            }});
+        };
+        addWarc("export/warc", WarcWriter::Options{}.compressionLevel);
+        addWarc("export/warc_level6", 6);
+
+        return benchmarks;
+    }
+
+    void printUsage(const char* program) {
+        std::cout << "Usage: " << program << " [--corpus dir] [--filter text] [--min-time seconds]"
+                  << " [--repetitions n] [--json]\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::filesystem::path corpusDir = WEBCRAWLER_BENCH_CORPUS;
+    std::string filter;
+    double minSeconds = 0.2;
+    size_t repetitions = 3;
+    bool json = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--corpus" && i + 1 < argc) {
+            corpusDir = argv[++i];
+        } else if (arg == "--filter" && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            minSeconds = std::stod(argv[++i]);
+        } else if (arg == "--repetitions" && i + 1 < argc) {
+            repetitions = std::max<size_t>(1, std::stoull(argv[++i]));
+        } else if (arg == "--json") {
+            json = true;
+        } else {
+            printUsage(argv[0]);
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+
+    Corpus corpus;
+    try {
+        corpus = loadCorpus(corpusDir);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    if (corpus.pages.empty() || corpus.absoluteUrls.empty()) {
+        std::cerr << "Error: corpus in " << corpusDir.string() << " has no pages or URLs\n";
+        return 1;
+    }
+
+    const std::filesystem::path scratch = std::filesystem::temp_directory_path() / "webcrawlerbench";
+    std::filesystem::create_directories(scratch);
+    const auto results = makeResults(corpus);
+    const auto benchmarks = makeBenchmarks(corpus, results, scratch);
+
+    if (!json) {
+        std::cout << "name,iterations,ns_per_op,best_ns_per_op,items_per_sec,mb_per_sec\n";
+    }
+
+    size_t checksum = 0;
+    for (const auto& benchmark : benchmarks) {
+        if (!filter.empty() && benchmark.name.find(filter) == std::string::npos) continue;
+
+        std::vector<Measurement> runs;
+        for (size_t r = 0; r < repetitions; ++r) {
+            runs.push_back(measure(benchmark, minSeconds, checksum));
+        }
+        std::sort(runs.begin(), runs.end(), [](const Measurement& a, const Measurement& b) {
+            return a.nanosPerOp < b.nanosPerOp;
+        });
+        report(benchmark, runs[runs.size() / 2], runs.front().nanosPerOp, json);
+    }
+
+    std::filesystem::remove_all(scratch);
+    std::cerr << "(checksum " << checksum << ")\n";
+    return 0;
+}
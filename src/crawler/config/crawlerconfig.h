@@ -7,13 +7,14 @@
 #include <vector>
 #include <chrono>
 #include "../httpclient.h"
+#include "../urlcanonicalizer.h"
 
 struct CrawlerConfig
 {
     // URL's to start crawling from
     std::vector<std::string> seedUrls;
 
-    // Max pages to crawl
+    // Max pages to crawl. A page that redirects counts once, however many hops it takes
     size_t maxPages = 100;
 
     // Max depth to crawl
@@ -39,4 +40,81 @@ struct CrawlerConfig
     // Only do URL's from same domain
 
     bool sameDomainOnly = true;
+
+    // Hosts admitted besides the seeds' ("*.example.com" covers its subdomains); when
+    // non-empty the host restriction applies even without sameDomainOnly
+    std::vector<std::string> allowedHosts;
+
+    // Globs over the whole URL ('*' any run, '?' any character). A URL must match one
+    // include pattern, if any are given, and no exclude pattern
+    std::vector<std::string> includePatterns;
+    std::vector<std::string> excludePatterns;
+
+    // Every URL is canonicalized before dedup: resolved against its page, scheme and host
+    // lower-cased, default port, fragment and dot segments dropped, percent-encoding made
+    // canonical, query parameters named in stripQueryParams removed ('*' suffix matches any
+    // ending) and the rest sorted by name when sortQueryParams is set. stripTrailingSlash
+    // also folds "/a/" into "/a"
+    std::vector<std::string> stripQueryParams = UrlCanonicalizer::Options{}.stripParams;
+    bool sortQueryParams = true;
+    bool stripTrailingSlash = false;
+
+    // Crawler-trap detection over discovered links. URLs are grouped into per-host pattern
+    // templates (digit runs and random tokens in the path abstracted, query values dropped);
+    // each template admits at most trapMaxPerPattern URLs and trapMaxParamValues values per
+    // query parameter, and none once most of its pages turn out to be duplicates. Over-long,
+    // over-deep, self-repeating and session-ID URLs are dropped outright. Every dropped URL
+    // is written to trapLogFile with the reason (empty = off)
+    bool trapDetection = true;
+    size_t trapMaxPerPattern = 5000;
+    size_t trapMaxParamValues = 100;
+    std::string trapLogFile;
+
+    // Seed the frontier from sitemaps before crawling: those named by the seeds' robots.txt
+    // (or /sitemap.xml and /sitemap_index.xml when it names none) plus sitemapUrls. Their URLs
+    // are queued freshest lastmod first, at most min(sitemapMaxUrls, maxPages) of them, from
+    // at most sitemapMaxFiles files counting nested indexes
+    bool discoverSitemaps = true;
+    std::vector<std::string> sitemapUrls;
+    size_t sitemapMaxUrls = 1000000;
+    size_t sitemapMaxFiles = 1000;
+
+    // Per-URL fetch history (fetch times, content hashes, observed changes) loaded from and
+    // saved back to this file, so later runs know how often each page changes (empty = off)
+    std::string stateFile;
+
+    // Continuous mode: rather than one pass, keep revisiting the URLs in the state store as
+    // their estimated change rates make them due, at most recrawlPagesPerSecond overall, for
+    // recrawlDuration (zero = until stopped). maxPages caps the number of URLs tracked
+    bool continuous = false;
+    double recrawlPagesPerSecond = 1.0;
+    std::chrono::seconds recrawlDuration{0};
+    std::chrono::seconds recrawlMinInterval{300};
+    std::chrono::seconds recrawlMaxInterval{30 * 24 * 3600};
+    std::chrono::seconds stateSaveInterval{60};
+
+    // Bytes the frontier, visited set, downloaded bodies, queued results and URL state may
+    // hold together (0 = unlimited, usage is still reported). Past memoryHighWater of it new
+    // frontier URLs spill to a temporary file and half the workers pause; at the limit only
+    // one fetch runs at a time until usage falls again
+    size_t memoryBudget = 0;
+    double memoryHighWater = 0.8;
+
+    // Prometheus text metrics file, rewritten every metricsInterval (empty = off)
+    std::string metricsFile;
+    std::chrono::milliseconds metricsInterval{5000};
+
+    // Resolve hosts as they enter the frontier, on dnsConcurrency threads, and hand the
+    // addresses to curl. Missing hosts are cached for dnsNegativeTtl and their URLs dropped.
+    // With dnsServers ("ip" or "ip:port") lookups go straight to those servers over UDP and
+    // follow record TTLs; otherwise the system resolver is used.
+    bool dnsPrefetch = true;
+    size_t dnsConcurrency = 8;
+    std::vector<std::string> dnsServers;
+    std::chrono::seconds dnsNegativeTtl{300};
+
+    // Chrome trace-event JSON timeline written when the crawl ends (empty = off), and
+    // the fraction of URLs whose spans it records
+    std::string traceFile;
+    double traceSampleRate = 1.0;
 };
\ No newline at end of file
@@ -0,0 +1,79 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#pragma once
+#include "../util/memorybudget.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct CrawlResult {
+    // One hop of a redirect chain: from answered statusCode with a Location pointing at to
+    struct Redirect {
+        std::string from;
+        std::string to;
+        int statusCode = 0;
+        std::string responseHeaders;  // Raw status line and headers of the 3xx, kept for archiving
+        std::chrono::system_clock::time_point fetchTime;
+    };
+
+    std::string url;
+    // Hops followed from url, in order. The status, headers, body and links below belong to
+    // finalUrl, where the chain ended; when that URL was already crawled the chain stops
+    // there and the result holds the last 3xx without a body
+    std::vector<Redirect> redirects;
+    std::string finalUrl;
+    int statusCode = 0;
+    std::string content;
+    std::string responseHeaders;  // Raw status line and headers, kept for archiving
+    std::chrono::system_clock::time_point fetchTime;
+    std::vector<std::string> extractedLinks;
+    bool success = false;
+    std::string errorMessage;
+    // Filled in after the crawl from the link graph
+    double pageRank = 0.0;
+    int64_t weakComponent = -1;
+    int64_t strongComponent = -1;
+    int clickDepth = -1;  // Fewest clicks from a seed URL
+
+    // Sizes recorded by compact(), which frees the body, headers and link list of a result
+    // kept only for the final export. Exports read them through the accessors below.
+    size_t contentLength = 0;
+    size_t linkCount = 0;
+    bool compacted = false;
+
+    [[nodiscard]] const std::string& fetchedUrl() const { return finalUrl.empty() ? url : finalUrl; }
+    [[nodiscard]] size_t contentSize() const { return compacted ? contentLength : content.size(); }
+    [[nodiscard]] size_t linksFound() const { return compacted ? linkCount : extractedLinks.size(); }
+
+    // Estimated heap bytes held, for the crawler's memory budget
+    [[nodiscard]] size_t memoryUsage() const {
+        size_t bytes = sizeof(CrawlResult) + MemoryBudget::stringBytes(url.size()) +
+                       MemoryBudget::stringBytes(content.size()) + MemoryBudget::stringBytes(responseHeaders.size()) +
+                       MemoryBudget::stringBytes(errorMessage.size()) + MemoryBudget::stringBytes(finalUrl.size());
+        for (const auto& redirect : redirects) {
+            bytes += sizeof(Redirect) + MemoryBudget::stringBytes(redirect.from.size()) +
+                     MemoryBudget::stringBytes(redirect.to.size()) +
+                     MemoryBudget::stringBytes(redirect.responseHeaders.size());
+        }
+        for (const auto& link : extractedLinks) {
+            bytes += MemoryBudget::stringBytes(link.size());
+        }
+        return bytes;
+    }
+
+    void compact() {
+        if (compacted) return;
+        contentLength = content.size();
+        linkCount = extractedLinks.size();
+        compacted = true;
+        std::string().swap(content);
+        std::string().swap(responseHeaders);
+        for (auto& redirect : redirects) {
+            std::string().swap(redirect.responseHeaders);
+        }
+        std::vector<std::string>().swap(extractedLinks);
+    }
+};
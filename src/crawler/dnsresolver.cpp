@@ -0,0 +1,412 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#include "dnsresolver.h"
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+namespace {
+    using SocketHandle = SOCKET;
+    constexpr SocketHandle INVALID_SOCKET_HANDLE = INVALID_SOCKET;
+    void closeSocket(SocketHandle socket) { ::closesocket(socket); }
+    int pollSocket(pollfd* fds, unsigned long count, int timeout) { return ::WSAPoll(fds, count, timeout); }
+}
+#else
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+namespace {
+    using SocketHandle = int;
+    constexpr SocketHandle INVALID_SOCKET_HANDLE = -1;
+    void closeSocket(SocketHandle socket) { ::close(socket); }
+    int pollSocket(pollfd* fds, nfds_t count, int timeout) { return ::poll(fds, count, timeout); }
+}
+#endif
+
+namespace {
+    // Failed lookups are retried after this long; meanwhile curl resolves the host itself
+    constexpr std::chrono::seconds FAILURE_RETRY{30};
+
+    constexpr uint16_t TYPE_A = 1;
+    constexpr uint16_t TYPE_SOA = 6;
+    constexpr uint16_t TYPE_AAAA = 28;
+    constexpr uint16_t CLASS_IN = 1;
+    constexpr uint16_t RCODE_NXDOMAIN = 3;
+
+    uint16_t read16(const unsigned char* p) { return static_cast<uint16_t>((p[0] << 8) | p[1]); }
+    uint32_t read32(const unsigned char* p) {
+        return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+               (static_cast<uint32_t>(p[2]) << 8) | p[3];
+    }
+
+    // Advances past a possibly compressed name; false if it runs off the message
+    bool skipName(const std::vector<unsigned char>& message, size_t& pos) {
+        while (pos < message.size()) {
+            const unsigned char length = message[pos];
+            if (length == 0) {
+                ++pos;
+                return true;
+            }
+            if ((length & 0xC0) == 0xC0) {
+                pos += 2;
+                return pos <= message.size();
+            }
+            pos += 1 + length;
+        }
+        return false;
+    }
+
+    std::vector<unsigned char> buildQuery(uint16_t id, const std::string& host, uint16_t type) {
+        std::vector<unsigned char> query = {
+            static_cast<unsigned char>(id >> 8), static_cast<unsigned char>(id & 0xFF),
+            0x01, 0x00,  // Standard query, recursion desired
+            0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        };
+        size_t start = 0;
+        while (start <= host.size()) {
+            size_t end = host.find('.', start);
+            if (end == std::string::npos) end = host.size();
+            if (end > start) {
+                query.push_back(static_cast<unsigned char>(std::min<size_t>(end - start, 63)));
+                query.insert(query.end(), host.begin() + static_cast<std::ptrdiff_t>(start),
+                             host.begin() + static_cast<std::ptrdiff_t>(start + std::min<size_t>(end - start, 63)));
+            }
+            start = end + 1;
+        }
+        query.push_back(0);
+        query.push_back(static_cast<unsigned char>(type >> 8));
+        query.push_back(static_cast<unsigned char>(type & 0xFF));
+        query.push_back(0);
+        query.push_back(CLASS_IN);
+        return query;
+    }
+
+    bool parseServer(const std::string& server, sockaddr_storage& address, socklen_t& length) {
+        std::string host = server;
+        uint16_t port = 53;
+        // "[v6]:port", "v4:port" or a bare address
+        if (!host.empty() && host.front() == '[') {
+            const size_t close = host.find(']');
+            if (close == std::string::npos) return false;
+            if (close + 2 < host.size() && host[close + 1] == ':') {
+                port = static_cast<uint16_t>(std::stoi(host.substr(close + 2)));
+            }
+            host = host.substr(1, close - 1);
+        } else if (std::count(host.begin(), host.end(), ':') == 1) {
+            const size_t colon = host.find(':');
+            port = static_cast<uint16_t>(std::stoi(host.substr(colon + 1)));
+            host = host.substr(0, colon);
+        }
+
+        std::memset(&address, 0, sizeof(address));
+        auto* v4 = reinterpret_cast<sockaddr_in*>(&address);
+        auto* v6 = reinterpret_cast<sockaddr_in6*>(&address);
+        if (inet_pton(AF_INET, host.c_str(), &v4->sin_addr) == 1) {
+            v4->sin_family = AF_INET;
+            v4->sin_port = htons(port);
+            length = sizeof(sockaddr_in);
+            return true;
+        }
+        if (inet_pton(AF_INET6, host.c_str(), &v6->sin6_addr) == 1) {
+            v6->sin6_family = AF_INET6;
+            v6->sin6_port = htons(port);
+            length = sizeof(sockaddr_in6);
+            return true;
+        }
+        return false;
+    }
+
+    enum class QueryOutcome { Answered, NoSuchHost, NoData, Failed };
+
+    // One query to one server. Fills addresses and ttl (the smallest record TTL, or the
+    // SOA negative TTL for NoSuchHost/NoData).
+    QueryOutcome queryServer(const std::string& server, const std::string& host, uint16_t type,
+                             std::chrono::milliseconds timeout, std::vector<std::string>& addresses, uint32_t& ttl) {
+        sockaddr_storage address{};
+        socklen_t addressLength = 0;
+        if (!parseServer(server, address, addressLength)) return QueryOutcome::Failed;
+
+        thread_local std::mt19937 random(std::random_device{}());
+        const auto id = static_cast<uint16_t>(random());
+        const auto query = buildQuery(id, host, type);
+
+        const SocketHandle socket = ::socket(address.ss_family, SOCK_DGRAM, 0);
+        if (socket == INVALID_SOCKET_HANDLE) return QueryOutcome::Failed;
+        std::vector<unsigned char> message(4096);
+        int received = -1;
+        if (::sendto(socket, reinterpret_cast<const char*>(query.data()), static_cast<int>(query.size()), 0,
+                     reinterpret_cast<const sockaddr*>(&address), addressLength) == static_cast<int>(query.size())) {
+            const auto deadline = std::chrono::steady_clock::now() + timeout;
+            while (true) {
+                const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now()).count();
+                pollfd pfd{socket, POLLIN, 0};
+                if (remaining <= 0 || pollSocket(&pfd, 1, static_cast<int>(remaining)) <= 0) break;
+                received = static_cast<int>(::recv(socket, reinterpret_cast<char*>(message.data()),
+                                                   static_cast<int>(message.size()), 0));
+                // Ignore stray datagrams that are not the answer to this query
+                if (received >= 12 && read16(message.data()) == id && (message[2] & 0x80)) break;
+                received = -1;
+            }
+        }
+        closeSocket(socket);
+        if (received < 12) return QueryOutcome::Failed;
+        message.resize(static_cast<size_t>(received));
+
+        const uint16_t rcode = message[3] & 0x0F;
+        if (rcode != 0 && rcode != RCODE_NXDOMAIN) return QueryOutcome::Failed;
+        // TC: the answer did not fit in the datagram. There is no retry over TCP, so the
+        // records that arrived whole are used, and without any the lookup has failed
+        const bool truncated = (message[2] & 0x02) != 0;
+        const uint16_t questions = read16(&message[4]);
+        const uint16_t answers = read16(&message[6]);
+        const uint16_t authorities = read16(&message[8]);
+
+        size_t pos = 12;
+        for (uint16_t i = 0; i < questions; ++i) {
+            if (!skipName(message, pos)) return QueryOutcome::Failed;
+            pos += 4;
+        }
+
+        ttl = UINT32_MAX;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(answers) + authorities; ++i) {
+            if (!skipName(message, pos) || pos + 10 > message.size()) {
+                if (truncated) break;
+                return QueryOutcome::Failed;
+            }
+            const uint16_t recordType = read16(&message[pos]);
+            const uint32_t recordTtl = read32(&message[pos + 4]);
+            const uint16_t dataLength = read16(&message[pos + 8]);
+            pos += 10;
+            if (pos + dataLength > message.size()) {
+                if (truncated) break;
+                return QueryOutcome::Failed;
+            }
+
+            const bool isAnswer = i < answers;
+            if (isAnswer && recordType == type) {
+                char text[INET6_ADDRSTRLEN] = {};
+                if (type == TYPE_A && dataLength == 4) {
+                    inet_ntop(AF_INET, &message[pos], text, sizeof(text));
+                } else if (type == TYPE_AAAA && dataLength == 16) {
+                    inet_ntop(AF_INET6, &message[pos], text, sizeof(text));
+                }
+                if (text[0]) {
+                    addresses.emplace_back(text);
+                    ttl = std::min(ttl, recordTtl);
+                }
+            } else if (!isAnswer && recordType == TYPE_SOA && dataLength >= 4) {
+                // RFC 2308: negative answers live for min(SOA TTL, SOA MINIMUM)
+                ttl = std::min({ttl, recordTtl, read32(&message[pos + dataLength - 4])});
+            }
+            pos += dataLength;
+        }
+
+        if (rcode == RCODE_NXDOMAIN) return QueryOutcome::NoSuchHost;
+        if (truncated && addresses.empty()) return QueryOutcome::Failed;
+        return addresses.empty() ? QueryOutcome::NoData : QueryOutcome::Answered;
+    }
+}
+
+DnsResolver::DnsResolver(const Options& options, Lookup lookup)
+    : options_(options), lookup_(std::move(lookup)) {
+    const size_t threads = std::max<size_t>(1, options_.concurrency);
+    for (size_t i = 0; i < threads; ++i) {
+        threads_.emplace_back(&DnsResolver::lookupLoop, this);
+    }
+}
+
+DnsResolver::~DnsResolver() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    queueCv_.notify_all();
+    readyCv_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+bool DnsResolver::enqueueLocked(const std::string& host, std::chrono::steady_clock::time_point now) {
+    auto it = cache_.find(host);
+    if (it != cache_.end() && (!it->second.ready || it->second.expires > now)) {
+        return false;
+    }
+    Entry& entry = cache_[host];
+    entry.ready = false;
+    queue_.push_back(host);
+    return true;
+}
+
+void DnsResolver::prefetch(std::string_view host) {
+    if (host.empty() || isIpLiteral(host)) return;
+    bool queued;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queued = enqueueLocked(std::string(host), std::chrono::steady_clock::now());
+    }
+    if (queued) queueCv_.notify_one();
+}
+
+std::optional<DnsResolver::Answer> DnsResolver::resolve(std::string_view host) {
+    const std::string key(host);
+    std::unique_lock<std::mutex> lock(mutex_);
+    const auto now = std::chrono::steady_clock::now();
+
+    auto it = cache_.find(key);
+    if (it != cache_.end() && it->second.ready && it->second.expires > now) {
+        cacheHits_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        if (enqueueLocked(key, now)) queueCv_.notify_one();
+        const bool ready = readyCv_.wait_for(lock, options_.waitTimeout, [this, &key] {
+            auto found = cache_.find(key);
+            return stopping_ || (found != cache_.end() && found->second.ready);
+        });
+        if (!ready || stopping_) return std::nullopt;
+        it = cache_.find(key);
+    }
+
+    const Answer& answer = it->second.answer;
+    if (!answer.found && answer.ttl.count() == 0) return std::nullopt;  // Failed lookup
+    return answer;
+}
+
+bool DnsResolver::isDead(std::string_view host) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = cache_.find(std::string(host));
+    return it != cache_.end() && it->second.ready && !it->second.answer.found &&
+           it->second.answer.ttl.count() > 0 && it->second.expires > std::chrono::steady_clock::now();
+}
+
+DnsResolver::Stats DnsResolver::stats() const {
+    Stats stats;
+    stats.lookups = lookups_.load(std::memory_order_relaxed);
+    stats.cacheHits = cacheHits_.load(std::memory_order_relaxed);
+    stats.deadHosts = deadHosts_.load(std::memory_order_relaxed);
+    stats.failures = failures_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void DnsResolver::lookupLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        queueCv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (stopping_) return;
+
+        const std::string host = std::move(queue_.front());
+        queue_.pop_front();
+        lock.unlock();
+
+        Answer answer;
+        try {
+            answer = lookup_(host);
+        } catch (const std::exception&) {
+            answer = Answer{};
+        }
+        lookups_.fetch_add(1, std::memory_order_relaxed);
+
+        std::chrono::seconds lifetime;
+        if (answer.found) {
+            lifetime = std::min(answer.ttl, options_.maxTtl);
+        } else if (answer.ttl.count() > 0) {
+            lifetime = std::min(answer.ttl, options_.negativeTtl);
+            deadHosts_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            lifetime = FAILURE_RETRY;
+            failures_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        lock.lock();
+        Entry& entry = cache_[host];
+        entry.answer = std::move(answer);
+        entry.expires = std::chrono::steady_clock::now() + lifetime;
+        entry.ready = true;
+        readyCv_.notify_all();
+    }
+}
+
+DnsResolver::Lookup DnsResolver::systemLookup(std::chrono::seconds defaultTtl) {
+    return [defaultTtl](const std::string& host) {
+        Answer answer;
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* results = nullptr;
+        const int status = getaddrinfo(host.c_str(), nullptr, &hints, &results);
+        if (status != 0) {
+            // Only a definite "no such name" is cached as a dead host
+            if (status == EAI_NONAME) answer.ttl = defaultTtl;
+            return answer;
+        }
+
+        for (const addrinfo* info = results; info; info = info->ai_next) {
+            char text[INET6_ADDRSTRLEN] = {};
+            if (info->ai_family == AF_INET) {
+                inet_ntop(AF_INET, &reinterpret_cast<const sockaddr_in*>(info->ai_addr)->sin_addr, text, sizeof(text));
+            } else if (info->ai_family == AF_INET6) {
+                inet_ntop(AF_INET6, &reinterpret_cast<const sockaddr_in6*>(info->ai_addr)->sin6_addr, text, sizeof(text));
+            }
+            if (text[0] && std::find(answer.addresses.begin(), answer.addresses.end(), text) == answer.addresses.end()) {
+                answer.addresses.emplace_back(text);
+            }
+        }
+        freeaddrinfo(results);
+
+        answer.found = !answer.addresses.empty();
+        answer.ttl = defaultTtl;
+        return answer;
+    };
+}
+
+DnsResolver::Lookup DnsResolver::udpLookup(std::vector<std::string> servers, std::chrono::milliseconds timeout) {
+    return [servers = std::move(servers), timeout](const std::string& host) {
+        Answer answer;
+        // Each server in turn until one gives a definite answer
+        for (const auto& server : servers) {
+            uint32_t ttl = 0;
+            QueryOutcome outcome = queryServer(server, host, TYPE_A, timeout, answer.addresses, ttl);
+            if (outcome == QueryOutcome::NoData) {
+                outcome = queryServer(server, host, TYPE_AAAA, timeout, answer.addresses, ttl);
+            }
+            if (outcome == QueryOutcome::Failed) continue;
+
+            answer.found = outcome == QueryOutcome::Answered;
+            // No SOA in a negative answer: still cache it, for a minute
+            answer.ttl = std::chrono::seconds(ttl == UINT32_MAX ? 60 : std::max<uint32_t>(ttl, 1));
+            return answer;
+        }
+        return answer;
+    };
+}
+
+std::string DnsResolver::curlResolveEntry(std::string_view host, int port, const Answer& answer) {
+    std::string entry(host);
+    entry += ':';
+    entry += std::to_string(port);
+    entry += ':';
+    for (size_t i = 0; i < answer.addresses.size(); ++i) {
+        if (i > 0) entry += ',';
+        const bool v6 = answer.addresses[i].find(':') != std::string::npos;
+        if (v6) entry += '[';
+        entry += answer.addresses[i];
+        if (v6) entry += ']';
+    }
+    return entry;
+}
+
+bool DnsResolver::isIpLiteral(std::string_view host) {
+    if (!host.empty() && host.front() == '[') return true;
+    const std::string text(host);
+    unsigned char buffer[sizeof(in6_addr)];
+    return inet_pton(AF_INET, text.c_str(), buffer) == 1 || inet_pton(AF_INET6, text.c_str(), buffer) == 1;
+}
@@ -0,0 +1,106 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Resolves hosts ahead of their fetches. prefetch() queues a host for a bounded pool of
+// lookup threads as soon as it enters the frontier; by the time a worker calls resolve()
+// the answer is usually cached. Answers are kept for their TTL, and hosts that do not
+// exist are remembered for negativeTtl so their URLs can be dropped without a fetch.
+// Workers hand the addresses to curl through CURLOPT_RESOLVE (see curlResolveEntry).
+class DnsResolver
+{
+public:
+    struct Answer {
+        bool found = false;
+        std::vector<std::string> addresses;  // Textual IPv4/IPv6 addresses
+        // How long the answer may be cached. Zero on a failed lookup (timeout, server
+        // failure), which is not cached: curl then resolves the host itself.
+        std::chrono::seconds ttl{0};
+    };
+
+    // Blocking lookup run on the pool threads; injectable so a stub can stand in
+    using Lookup = std::function<Answer(const std::string& host)>;
+
+    struct Options {
+        size_t concurrency = 8;                  // Lookups in flight at once
+        std::chrono::seconds negativeTtl{300};   // For missing hosts without an SOA TTL
+        std::chrono::seconds maxTtl{3600};
+        std::chrono::milliseconds waitTimeout{10000};  // Longest resolve() waits for a lookup
+    };
+
+    struct Stats {
+        size_t lookups = 0;
+        size_t cacheHits = 0;
+        size_t deadHosts = 0;    // Negative answers received
+        size_t failures = 0;     // Lookups that could not get an answer either way
+    };
+
+    DnsResolver(const Options& options, Lookup lookup);
+    ~DnsResolver();
+
+    DnsResolver(const DnsResolver&) = delete;
+    DnsResolver& operator=(const DnsResolver&) = delete;
+
+    // Queues a lookup unless the host is cached or already queued; never blocks on DNS
+    void prefetch(std::string_view host);
+    // The cached answer, waiting for a queued or new lookup if needed. nullopt means no
+    // usable answer (failure or timeout); the caller should let curl resolve the host.
+    [[nodiscard]] std::optional<Answer> resolve(std::string_view host);
+    // True if the host is cached as nonexistent
+    [[nodiscard]] bool isDead(std::string_view host) const;
+
+    [[nodiscard]] Stats stats() const;
+
+    // getaddrinfo through the system resolver (honours /etc/hosts). It reports no TTLs,
+    // so answers are cached for defaultTtl.
+    static Lookup systemLookup(std::chrono::seconds defaultTtl = std::chrono::seconds(300));
+    // Plain DNS over UDP to the given servers ("ip" or "ip:port"), with record TTLs and
+    // negative TTLs from the SOA record. Suits local stub servers in tests.
+    static Lookup udpLookup(std::vector<std::string> servers,
+                            std::chrono::milliseconds timeout = std::chrono::milliseconds(2000));
+
+    // "host:port:addr1,addr2" for CURLOPT_RESOLVE
+    static std::string curlResolveEntry(std::string_view host, int port, const Answer& answer);
+    static bool isIpLiteral(std::string_view host);
+
+private:
+    struct Entry {
+        bool ready = false;
+        Answer answer;
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    Options options_;
+    Lookup lookup_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable queueCv_;
+    std::condition_variable readyCv_;
+    std::unordered_map<std::string, Entry> cache_;  // Guarded by mutex_
+    std::deque<std::string> queue_;
+    bool stopping_ = false;
+    std::vector<std::thread> threads_;
+
+    std::atomic<size_t> lookups_{0};
+    std::atomic<size_t> cacheHits_{0};
+    std::atomic<size_t> deadHosts_{0};
+    std::atomic<size_t> failures_{0};
+
+    // Returns true if a lookup was queued; requires mutex_
+    bool enqueueLocked(const std::string& host, std::chrono::steady_clock::time_point now);
+    void lookupLoop();
+};
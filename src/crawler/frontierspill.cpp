@@ -0,0 +1,98 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#include "frontierspill.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+    constexpr size_t READ_CHUNK = 64 * 1024;
+
+    bool seekTo(std::FILE* file, uint64_t offset) {
+#ifdef _WIN32
+        return _fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+        return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+    }
+}
+
+FrontierSpill::~FrontierSpill() {
+    if (file_) {
+        std::fclose(file_);
+    }
+}
+
+void FrontierSpill::push(const std::string& url) {
+    // A line break would split the record; no valid URL contains one
+    if (url.find_first_of("\r\n") != std::string::npos) return;
+
+    if (!file_) {
+        file_ = std::tmpfile();
+        if (!file_) {
+            throw std::runtime_error("Failed to create frontier spill file");
+        }
+    }
+    if (!writing_) {
+        // Switching from reading to writing needs a seek in between
+        if (!seekTo(file_, writeOffset_)) {
+            throw std::runtime_error("Failed to seek frontier spill file");
+        }
+        writing_ = true;
+    }
+    if (std::fwrite(url.data(), 1, url.size(), file_) != url.size() || std::fputc('\n', file_) == EOF) {
+        throw std::runtime_error("Failed to write frontier spill file");
+    }
+    writeOffset_ += url.size() + 1;
+    ++count_;
+    ++spilled_;
+}
+
+size_t FrontierSpill::pop(std::vector<std::string>& out, size_t max) {
+    if (count_ == 0 || max == 0) return 0;
+
+    if (std::fflush(file_) != 0 || !seekTo(file_, readOffset_)) {
+        throw std::runtime_error("Failed to seek frontier spill file");
+    }
+    writing_ = false;
+
+    size_t popped = 0;
+    std::string pending;  // Start of a line whose end is in the next chunk
+    char chunk[READ_CHUNK];
+    while (popped < max && count_ > 0) {
+        const uint64_t unread = writeOffset_ - readOffset_ - pending.size();
+        const size_t got = std::fread(chunk, 1, static_cast<size_t>(std::min<uint64_t>(sizeof(chunk), unread)), file_);
+        if (got == 0) {
+            throw std::runtime_error("Failed to read frontier spill file");
+        }
+        size_t start = 0;
+        for (size_t i = 0; i < got && popped < max; ++i) {
+            if (chunk[i] != '\n') continue;
+            pending.append(chunk + start, i - start);
+            readOffset_ += pending.size() + 1;
+            out.push_back(std::move(pending));
+            pending.clear();
+            start = i + 1;
+            ++popped;
+            --count_;
+        }
+        if (popped < max) {
+            pending.append(chunk + start, got - start);
+        }
+    }
+
+    if (count_ == 0) {
+        // Drained: later pushes overwrite the file from the start
+        readOffset_ = 0;
+        writeOffset_ = 0;
+    }
+    return popped;
+}
+
+void FrontierSpill::clear() {
+    readOffset_ = 0;
+    writeOffset_ = 0;
+    count_ = 0;
+    writing_ = false;
+}
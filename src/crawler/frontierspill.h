@@ -0,0 +1,45 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// First-in first-out overflow for the frontier, kept in an anonymous temporary file. URLs
+// are appended as lines and read back in the order they were written, so a crawl that
+// spills under memory pressure visits pages in the same order it would have otherwise.
+// The file is created on first use and its space reused whenever it drains. URLs
+// containing line breaks, which are never valid, are dropped. Not thread-safe; the
+// crawler guards it with its queue mutex.
+class FrontierSpill
+{
+public:
+    FrontierSpill() = default;
+    ~FrontierSpill();
+
+    FrontierSpill(const FrontierSpill&) = delete;
+    FrontierSpill& operator=(const FrontierSpill&) = delete;
+
+    // Throws if the temporary file cannot be created or written
+    void push(const std::string& url);
+    // Appends up to max URLs to out, oldest first; returns how many
+    size_t pop(std::vector<std::string>& out, size_t max);
+    // Forgets every URL, e.g. after a read error
+    void clear();
+
+    [[nodiscard]] bool empty() const { return count_ == 0; }
+    [[nodiscard]] size_t size() const { return count_; }
+    [[nodiscard]] uint64_t spilled() const { return spilled_; }       // URLs ever written
+    [[nodiscard]] uint64_t bytesOnDisk() const { return writeOffset_ - readOffset_; }
+
+private:
+    std::FILE* file_ = nullptr;
+    uint64_t readOffset_ = 0;
+    uint64_t writeOffset_ = 0;
+    size_t count_ = 0;
+    uint64_t spilled_ = 0;
+    bool writing_ = false;  // File position is at writeOffset_
+};
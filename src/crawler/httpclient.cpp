@@ -38,18 +38,34 @@ HttpClient::~HttpClient()
 }
 
 // The GET Request
-HttpClient::HttpResponse HttpClient::get(const std::string& url) const
+HttpClient::HttpResponse HttpClient::get(const std::string& url, const std::vector<std::string>& resolve) const
 {
-    return performRequest(url, "GET");
+    return performRequest(url, "GET", resolve);
+}
+// The GET Request without following redirects
+HttpClient::HttpResponse HttpClient::getOnce(const std::string& url, const std::vector<std::string>& resolve,
+                                             MemoryBudget* budget) const
+{
+    return performRequest(url, "GET", resolve, nullptr, false, budget);
 }
 // The HEAD Request
-HttpClient::HttpResponse HttpClient::head(const std::string& url) const
+HttpClient::HttpResponse HttpClient::head(const std::string& url, const std::vector<std::string>& resolve) const
+{
+    return performRequest(url, "HEAD", resolve);
+}
+
+// The streaming GET Request
+HttpClient::HttpResponse HttpClient::stream(const std::string& url, const BodySink& sink,
+                                            const std::vector<std::string>& resolve) const
 {
-    return performRequest(url, "HEAD");
+    return performRequest(url, "GET", resolve, &sink);
 }
 
 // The HTTP request
-HttpClient::HttpResponse HttpClient::performRequest(const std::string& url, const std::string& method) const
+HttpClient::HttpResponse HttpClient::performRequest(const std::string& url, const std::string& method,
+                                                    const std::vector<std::string>& resolve,
+                                                    const BodySink* sink, bool followRedirects,
+                                                    MemoryBudget* budget) const
 {
     HttpResponse response;
     response.timestamp = std::chrono::system_clock::now();
@@ -62,16 +78,20 @@ HttpClient::HttpResponse HttpClient::performRequest(const std::string& url, cons
     }
 
     std::string responseBody;
-    std::map<std::string, std::string> responseHeaders;
+    BodyTarget bodyTarget{&responseBody, sink, budget};
 
     curl_easy_reset(static_cast<CURL*>(curlHandle_));
 
     curl_easy_setopt(static_cast<CURL*>(curlHandle_), CURLOPT_URL, url.c_str());
     curl_easy_setopt(static_cast<CURL*>(curlHandle_), CURLOPT_USERAGENT, config_.userAgent.c_str());
     curl_easy_setopt(static_cast<CURL*>(curlHandle_), CURLOPT_TIMEOUT, static_cast<long>(config_.timeout.count()));
-    curl_easy_setopt(static_cast<CURL*>(curlHandle_), CURLOPT_FOLLOWLOCATION, config_.followRedirects ? 1L : 0L);
+    curl_easy_setopt(static_cast<CURL*>(curlHandle_), CURLOPT_FOLLOWLOCATION,
+                     config_.followRedirects && followRedirects ? 1L : 0L);
     curl_easy_setopt(static_cast<CURL*>(curlHandle_), CURLOPT_MAXREDIRS, static_cast<long>(config_.maxRedirects));
-    curl_easy_setopt(static_cast<CURL*>(curlHandle_), CURLOPT_MAXFILESIZE, static_cast<long>(config_.maxContentLength));
+    if (!sink)
+    {
+        curl_easy_setopt(static_cast<CURL*>(curlHandle_), CURLOPT_MAXFILESIZE, static_cast<long>(config_.maxContentLength));
+    }
 
     if (method == "HEAD")
     {
@@ -79,14 +99,43 @@ HttpClient::HttpResponse HttpClient::performRequest(const std::string& url, cons
     }
 
     curl_easy_setopt(static_cast<CURL*>(curlHandle_), CURLOPT_WRITEFUNCTION, writeCallback);
-    curl_easy_setopt(static_cast<CURL*>(curlHandle_), CURLOPT_WRITEDATA, &responseBody);
+    curl_easy_setopt(static_cast<CURL*>(curlHandle_), CURLOPT_WRITEDATA, &bodyTarget);
     curl_easy_setopt(static_cast<CURL*>(curlHandle_), CURLOPT_HEADERFUNCTION, headerCallback);
-    curl_easy_setopt(static_cast<CURL*>(curlHandle_), CURLOPT_HEADERDATA, &responseHeaders);
+    curl_easy_setopt(static_cast<CURL*>(curlHandle_), CURLOPT_HEADERDATA, &response);
+
+    // Entries land in the handle's DNS cache and replace earlier ones for the same host:port
+    curl_slist* resolveList = nullptr;
+    for (const auto& entry : resolve)
+    {
+        resolveList = curl_slist_append(resolveList, entry.c_str());
+    }
+    if (resolveList)
+    {
+        curl_easy_setopt(static_cast<CURL*>(curlHandle_), CURLOPT_RESOLVE, resolveList);
+    }
 
     CURLcode res = curl_easy_perform(static_cast<CURL*>(curlHandle_));
+    curl_slist_free_all(resolveList);
+
+    // Timers are filled in even for failed transfers, up to the point of failure
+    curl_off_t micros = 0;
+    curl_easy_getinfo(static_cast<CURL*>(curlHandle_), CURLINFO_NAMELOOKUP_TIME_T, &micros);
+    response.timing.nameLookup = std::chrono::microseconds(micros);
+    curl_easy_getinfo(static_cast<CURL*>(curlHandle_), CURLINFO_CONNECT_TIME_T, &micros);
+    response.timing.connect = std::chrono::microseconds(micros);
+    curl_easy_getinfo(static_cast<CURL*>(curlHandle_), CURLINFO_APPCONNECT_TIME_T, &micros);
+    response.timing.tlsHandshake = std::chrono::microseconds(micros);
+    curl_easy_getinfo(static_cast<CURL*>(curlHandle_), CURLINFO_STARTTRANSFER_TIME_T, &micros);
+    response.timing.firstByte = std::chrono::microseconds(micros);
+    curl_easy_getinfo(static_cast<CURL*>(curlHandle_), CURLINFO_TOTAL_TIME_T, &micros);
+    response.timing.total = std::chrono::microseconds(micros);
+    curl_off_t downloaded = 0;
+    curl_easy_getinfo(static_cast<CURL*>(curlHandle_), CURLINFO_SIZE_DOWNLOAD_T, &downloaded);
+    response.timing.bytesDownloaded = static_cast<size_t>(downloaded);
 
     if (res != CURLE_OK)
     {
+        settleCharge(bodyTarget, 0);  // The partial body is dropped
         response.success = false;
         response.errorMessage = curl_easy_strerror(res);
         return response;
@@ -95,32 +144,74 @@ HttpClient::HttpResponse HttpClient::performRequest(const std::string& url, cons
     long responseCode;
     curl_easy_getinfo(static_cast<CURL*>(curlHandle_), CURLINFO_RESPONSE_CODE, &responseCode);
 
+    char* effectiveUrl = nullptr;
+    curl_easy_getinfo(static_cast<CURL*>(curlHandle_), CURLINFO_EFFECTIVE_URL, &effectiveUrl);
+
     response.statusCode = static_cast<int>(responseCode);
+    settleCharge(bodyTarget, MemoryBudget::stringBytes(responseBody.size()));
     response.body = std::move(responseBody);
-    response.headers = std::move(responseHeaders);
+    response.effectiveUrl = effectiveUrl ? effectiveUrl : url;
+    char* location = nullptr;
+    curl_easy_getinfo(static_cast<CURL*>(curlHandle_), CURLINFO_REDIRECT_URL, &location);
+    if (location) response.location = location;
     response.success = true;
 
     return response;
 }
 
 // Callback Functions
-size_t HttpClient::writeCallback(void* contents, size_t size, size_t nmemb, std::string* response)
+size_t HttpClient::writeCallback(void* contents, size_t size, size_t nmemb, BodyTarget* target)
 {
     size_t totalSize = size * nmemb;
-    response->append(static_cast<char*>(contents), totalSize);
+    if (target->sink)
+    {
+        // A short count makes curl abort the transfer with CURLE_WRITE_ERROR
+        return (*target->sink)(std::string_view(static_cast<char*>(contents), totalSize)) ? totalSize : 0;
+    }
+    target->body->append(static_cast<char*>(contents), totalSize);
+    if (target->budget)
+    {
+        settleCharge(*target, MemoryBudget::stringBytes(target->body->size()));
+    }
     return totalSize;
 }
 
-size_t HttpClient::headerCallback(void* contents, size_t size, size_t nmemb, std::map<std::string, std::string>* headers)
+void HttpClient::settleCharge(BodyTarget& target, size_t bytes)
+{
+    if (!target.budget) return;
+    if (bytes > target.charged)
+    {
+        target.budget->charge(MemoryBudget::Account::Bodies, bytes - target.charged);
+    }
+    else
+    {
+        target.budget->release(MemoryBudget::Account::Bodies, target.charged - bytes);
+    }
+    target.charged = bytes;
+}
+
+size_t HttpClient::headerCallback(void* contents, size_t size, size_t nmemb, HttpResponse* response)
 {
     size_t totalSize = size * nmemb;
-    std::string header(static_cast<char*>(contents), totalSize);
+    parseHeaderLine(std::string_view(static_cast<char*>(contents), totalSize), *response);
+    return totalSize;
+}
+
+void HttpClient::parseHeaderLine(std::string_view header, HttpResponse& response)
+{
+    // A status line starts a new response; only the last hop of a redirect chain is kept
+    if (header.rfind("HTTP/", 0) == 0)
+    {
+        response.rawHeaders.clear();
+        response.headers.clear();
+    }
+    response.rawHeaders += header;
 
     size_t colonPos = header.find(':');
-    if (colonPos != std::string::npos && colonPos > 0)
+    if (colonPos != std::string_view::npos && colonPos > 0)
     {
-        std::string name = header.substr(0, colonPos);
-        std::string value = header.substr(colonPos + 1);
+        std::string name(header.substr(0, colonPos));
+        std::string value(header.substr(colonPos + 1));
 
         name.erase(0, name.find_first_not_of(" \t"));
         name.erase(name.find_last_not_of(" \t\r\n") + 1);  // Added \r\n
@@ -129,9 +220,7 @@ size_t HttpClient::headerCallback(void* contents, size_t size, size_t nmemb, std
 
         if (!name.empty() && !value.empty())
         {
-            (*headers)[name] = value;
+            response.headers[name] = value;
         }
     }
-
-    return totalSize;
-}
\ No newline at end of file
+}
@@ -6,15 +6,33 @@
 #include <string>
 #include <map>
 #include <chrono>
+#include <functional>
 #include <optional>
+#include <string_view>
+#include <vector>
+#include "../util/memorybudget.h"
 
 class HttpClient {
 public:
+    // Curl's timers, each measured from the start of the request
+    struct Timing {
+        std::chrono::microseconds nameLookup{0};
+        std::chrono::microseconds connect{0};
+        std::chrono::microseconds tlsHandshake{0};  // Zero for plain HTTP
+        std::chrono::microseconds firstByte{0};
+        std::chrono::microseconds total{0};
+        size_t bytesDownloaded = 0;
+    };
+
     struct HttpResponse {
         int statusCode = 0;
         std::string body;
         std::map<std::string, std::string> headers;
+        std::string rawHeaders;    // Status line and headers of the final response, as received
+        std::string effectiveUrl;  // URL of the final response after redirects
+        std::string location;      // Absolute redirect target of a 3xx response not followed
         std::chrono::system_clock::time_point timestamp;
+        Timing timing;
         bool success = false;
         std::optional<std::string> errorMessage;
 
@@ -34,14 +52,44 @@ public:
     explicit HttpClient(HttpConfig  config);  // Constructor with config
     ~HttpClient();
 
-    [[nodiscard]] HttpResponse get(const std::string& url) const;
-    [[nodiscard]] HttpResponse head(const std::string& url) const;
+    // resolve holds CURLOPT_RESOLVE entries ("host:port:addr[,addr]") that pin hosts to
+    // addresses resolved ahead of time, so curl skips its own lookup for them
+    [[nodiscard]] HttpResponse get(const std::string& url, const std::vector<std::string>& resolve = {}) const;
+    [[nodiscard]] HttpResponse head(const std::string& url, const std::vector<std::string>& resolve = {}) const;
+    // GET that never follows redirects: a 3xx comes back as is, its target in response.location,
+    // so the caller can decide on each hop. With a budget, the body is charged to its Bodies
+    // account as it arrives; once the transfer succeeds, the caller owns a charge of
+    // stringBytes(response.body.size()), and a failed one leaves nothing charged
+    [[nodiscard]] HttpResponse getOnce(const std::string& url, const std::vector<std::string>& resolve = {},
+                                       MemoryBudget* budget = nullptr) const;
+
+    // Receives the body in the chunks curl delivers; returning false aborts the transfer
+    using BodySink = std::function<bool(std::string_view chunk)>;
+    // GET that hands the body to sink as it arrives instead of buffering it. response.body
+    // stays empty and maxContentLength does not apply.
+    [[nodiscard]] HttpResponse stream(const std::string& url, const BodySink& sink,
+                                      const std::vector<std::string>& resolve = {}) const;
+
+    // Applies one header line, as curl delivers it, to the response being built
+    static void parseHeaderLine(std::string_view header, HttpResponse& response);
 
 private:
     HttpConfig config_;
     void* curlHandle_ = nullptr;
 
-    [[nodiscard]] HttpResponse performRequest(const std::string& url, const std::string& method) const;
-    static size_t writeCallback(void* contents, size_t size, size_t nmemb, std::string* response);
-    static size_t headerCallback(void* contents, size_t size, size_t nmemb, std::map<std::string, std::string>* headers);
+    struct BodyTarget {
+        std::string* body = nullptr;
+        const BodySink* sink = nullptr;
+        MemoryBudget* budget = nullptr;
+        size_t charged = 0;  // Bytes of body charged to budget so far
+    };
+
+    [[nodiscard]] HttpResponse performRequest(const std::string& url, const std::string& method,
+                                              const std::vector<std::string>& resolve,
+                                              const BodySink* sink = nullptr, bool followRedirects = true,
+                                              MemoryBudget* budget = nullptr) const;
+    // Moves target's charge to bytes, the size the finished transfer leaves behind
+    static void settleCharge(BodyTarget& target, size_t bytes);
+    static size_t writeCallback(void* contents, size_t size, size_t nmemb, BodyTarget* target);
+    static size_t headerCallback(void* contents, size_t size, size_t nmemb, HttpResponse* response);
 };
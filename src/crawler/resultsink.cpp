@@ -0,0 +1,107 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#include "resultsink.h"
+#include <stdexcept>
+
+ResultSink::ResultSink(size_t producers, BatchConsumer consumer, size_t ringCapacity, size_t maxBatch)
+    : maxBatch_(maxBatch > 0 ? maxBatch : 1), consumer_(std::move(consumer)) {
+    if (producers == 0) {
+        throw std::invalid_argument("ResultSink needs at least one producer");
+    }
+
+    // Round the capacity up to a power of two so positions wrap with a mask
+    size_t capacity = 1;
+    while (capacity < ringCapacity) capacity <<= 1;
+    mask_ = capacity - 1;
+
+    rings_.reserve(producers);
+    for (size_t i = 0; i < producers; ++i) {
+        auto ring = std::make_unique<Ring>();
+        ring->slots.resize(capacity);
+        rings_.push_back(std::move(ring));
+    }
+
+    thread_ = std::thread(&ResultSink::consumeLoop, this);
+}
+
+ResultSink::~ResultSink() {
+    close();
+}
+
+void ResultSink::push(size_t producer, CrawlResult&& result) {
+    Ring& ring = *rings_[producer];
+    const size_t tail = ring.tail.load(std::memory_order_relaxed);
+
+    // Backpressure: wait for the consumer to free a slot
+    size_t head = ring.head.load(std::memory_order_acquire);
+    if (tail - head > mask_) {
+        stalls_.fetch_add(1, std::memory_order_relaxed);
+        do {
+            ring.head.wait(head, std::memory_order_acquire);
+            head = ring.head.load(std::memory_order_acquire);
+        } while (tail - head > mask_);
+    }
+
+    ring.slots[tail & mask_] = std::move(result);
+    ring.tail.store(tail + 1, std::memory_order_release);
+
+    signal_.fetch_add(1, std::memory_order_release);
+    signal_.notify_one();
+}
+
+void ResultSink::close() {
+    if (closed_.exchange(true)) return;
+
+    signal_.fetch_add(1, std::memory_order_release);
+    signal_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+size_t ResultSink::drainInto(std::vector<CrawlResult>& batch) {
+    size_t taken = 0;
+    // Start one ring further each time so a busy producer cannot starve the others
+    const size_t first = nextRing_++ % rings_.size();
+    for (size_t i = 0; i < rings_.size(); ++i) {
+        auto& ring = rings_[(first + i) % rings_.size()];
+        size_t head = ring->head.load(std::memory_order_relaxed);
+        const size_t tail = ring->tail.load(std::memory_order_acquire);
+        if (head == tail) continue;
+
+        while (head != tail && batch.size() < maxBatch_) {
+            batch.push_back(std::move(ring->slots[head & mask_]));
+            ring->slots[head & mask_] = CrawlResult{};
+            ++head;
+            ++taken;
+        }
+        ring->head.store(head, std::memory_order_release);
+        ring->head.notify_one();
+
+        if (batch.size() >= maxBatch_) break;
+    }
+    return taken;
+}
+
+void ResultSink::consumeLoop() {
+    std::vector<CrawlResult> batch;
+    batch.reserve(maxBatch_);
+
+    while (true) {
+        // Read the signal before draining so a push that lands afterwards wakes us
+        const uint64_t seen = signal_.load(std::memory_order_acquire);
+        const bool closing = closed_.load(std::memory_order_acquire);
+
+        while (drainInto(batch) > 0) {
+            if (consumer_) consumer_(batch);
+            delivered_.fetch_add(batch.size(), std::memory_order_relaxed);
+            batches_.fetch_add(1, std::memory_order_relaxed);
+            batch.clear();
+        }
+
+        if (closing) break;
+        signal_.wait(seen, std::memory_order_acquire);
+    }
+}
@@ -0,0 +1,65 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#pragma once
+#include "crawlresult.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Hands crawl results from worker threads to a single consumer thread in batches.
+// Every producer owns a lock-free single-producer ring, so workers never contend with
+// each other; results are moved in and moved out, never copied. A full ring blocks
+// its producer until the consumer catches up.
+class ResultSink
+{
+public:
+    // The consumer may move results out of the batch; it is cleared afterwards
+    using BatchConsumer = std::function<void(std::vector<CrawlResult>& batch)>;
+
+    ResultSink(size_t producers, BatchConsumer consumer, size_t ringCapacity = 256, size_t maxBatch = 128);
+    ~ResultSink();
+
+    ResultSink(const ResultSink&) = delete;
+    ResultSink& operator=(const ResultSink&) = delete;
+
+    // Called only by the thread that owns `producer`
+    void push(size_t producer, CrawlResult&& result);
+
+    // Delivers everything still queued, then stops the consumer thread
+    void close();
+
+    [[nodiscard]] size_t delivered() const { return delivered_.load(std::memory_order_relaxed); }
+    [[nodiscard]] size_t batches() const { return batches_.load(std::memory_order_relaxed); }
+    // Number of times a producer found its ring full and had to wait
+    [[nodiscard]] size_t stalls() const { return stalls_.load(std::memory_order_relaxed); }
+
+private:
+    struct alignas(64) Ring {
+        std::vector<CrawlResult> slots;
+        alignas(64) std::atomic<size_t> head{0};  // Next slot to consume
+        alignas(64) std::atomic<size_t> tail{0};  // Next slot to fill
+    };
+
+    std::vector<std::unique_ptr<Ring>> rings_;
+    size_t mask_;
+    size_t maxBatch_;
+    BatchConsumer consumer_;
+
+    // Bumped on every push and on close; the consumer sleeps on it when all rings are empty
+    std::atomic<uint64_t> signal_{0};
+    std::atomic<bool> closed_{false};
+
+    std::atomic<size_t> delivered_{0};
+    std::atomic<size_t> batches_{0};
+    std::atomic<size_t> stalls_{0};
+
+    size_t nextRing_ = 0;  // Consumer thread only
+    std::thread thread_;
+
+    void consumeLoop();
+    size_t drainInto(std::vector<CrawlResult>& batch);
+};
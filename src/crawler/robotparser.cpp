@@ -7,6 +7,8 @@
 #include <algorithm>
 #include <vector>
 #include <chrono>
+#include <cctype>
+#include <string_view>
 
 RobotParser::RobotRule RobotParser::parseRobot(const std::string& robotsTxt, const std::string& userAgent) {
     RobotRule rule;
@@ -14,6 +16,13 @@ RobotParser::RobotRule RobotParser::parseRobot(const std::string& robotsTxt, con
     std::string line;
     bool userAgentSection = false;
 
+    // Directive values may be preceded by any amount of whitespace ("User-agent: *")
+    auto valueAfter = [&line](size_t prefixLength) {
+        std::string value = line.substr(prefixLength);
+        value.erase(0, value.find_first_not_of(" \t"));
+        return value;
+    };
+
     while (std::getline(stream, line)) {
         // Trim whitespace
         line.erase(0, line.find_first_not_of(" \t"));
@@ -24,7 +33,7 @@ RobotParser::RobotRule RobotParser::parseRobot(const std::string& robotsTxt, con
         }
 
         if (line.rfind("User-agent:", 0) == 0) {
-            std::string agent = line.substr(11);
+            std::string agent = valueAfter(11);
             if (agent == userAgent || agent == "*") {
                 userAgentSection = true;
             } else {
@@ -32,11 +41,11 @@ RobotParser::RobotRule RobotParser::parseRobot(const std::string& robotsTxt, con
             }
         } else if (userAgentSection) {
             if (line.rfind("Disallow:", 0) == 0) {
-                rule.disallowedPaths.push_back(line.substr(10));
+                rule.disallowedPaths.push_back(valueAfter(9));
             } else if (line.rfind("Allow:", 0) == 0) {
-                rule.allowedPaths.push_back(line.substr(7));
+                rule.allowedPaths.push_back(valueAfter(6));
             } else if (line.rfind("Crawl-delay:", 0) == 0) {
-                rule.crawlDelay = std::chrono::seconds(std::stoi(line.substr(12)));
+                rule.crawlDelay = std::chrono::seconds(std::stoi(valueAfter(12)));
             }
         }
     }
@@ -60,4 +69,31 @@ bool RobotParser::isAllowed(const std::string& url, const RobotRule& rule) {
     }
 
     return true; // Default to allowed if no rules match
-}
\ No newline at end of file
+}
+std::vector<std::string> RobotParser::parseSitemaps(const std::string& robotsTxt) {
+    std::vector<std::string> sitemaps;
+    std::istringstream stream(robotsTxt);
+    std::string line;
+    constexpr std::string_view directive = "sitemap:";
+
+    while (std::getline(stream, line)) {
+        line.erase(0, line.find_first_not_of(" \t"));
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (line.size() <= directive.size()) continue;
+
+        // The directive name is matched case-insensitively; "sitemap:" is common in the wild
+        bool matches = true;
+        for (size_t i = 0; i < directive.size() && matches; ++i) {
+            matches = std::tolower(static_cast<unsigned char>(line[i])) == directive[i];
+        }
+        if (!matches) continue;
+
+        std::string url = line.substr(directive.size());
+        url.erase(0, url.find_first_not_of(" \t"));
+        if (!url.empty()) {
+            sitemaps.push_back(std::move(url));
+        }
+    }
+
+    return sitemaps;
+}
@@ -18,4 +18,6 @@ public:
 
     static RobotRule parseRobot(const std::string& robotsTxt, const std::string& userAgent);
     static bool isAllowed(const std::string& url, const RobotRule& rule);
+    // URLs of "Sitemap:" lines, which apply to every user agent
+    static std::vector<std::string> parseSitemaps(const std::string& robotsTxt);
 };
@@ -0,0 +1,450 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#include "sitemapparser.h"
+#include <zlib.h>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    constexpr size_t INFLATE_CHUNK = 64 * 1024;
+    // Decompressed bytes accepted from one sitemap; the protocol caps files at 50 MB
+    constexpr size_t MAX_INFLATED = 256ULL * 1024 * 1024;
+
+    bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    std::string_view trim(std::string_view text) {
+        while (!text.empty() && isSpace(text.front())) text.remove_prefix(1);
+        while (!text.empty() && isSpace(text.back())) text.remove_suffix(1);
+        return text;
+    }
+
+    std::string_view localName(std::string_view name) {
+        const size_t colon = name.rfind(':');
+        return colon == std::string_view::npos ? name : name.substr(colon + 1);
+    }
+
+    void appendUtf8(std::string& out, uint32_t codePoint) {
+        if (codePoint < 0x80) {
+            out += static_cast<char>(codePoint);
+        } else if (codePoint < 0x800) {
+            out += static_cast<char>(0xC0 | (codePoint >> 6));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        } else if (codePoint < 0x10000) {
+            out += static_cast<char>(0xE0 | (codePoint >> 12));
+            out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        } else if (codePoint < 0x110000) {
+            out += static_cast<char>(0xF0 | (codePoint >> 18));
+            out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+    }
+
+    // Replaces the predefined XML entities and character references; unknown ones are kept
+    std::string decodeEntities(std::string_view text) {
+        std::string out;
+        out.reserve(text.size());
+        size_t i = 0;
+        while (i < text.size()) {
+            const size_t amp = text.find('&', i);
+            if (amp == std::string_view::npos) {
+                out.append(text.substr(i));
+                break;
+            }
+            out.append(text.substr(i, amp - i));
+            const size_t semi = text.find(';', amp + 1);
+            if (semi == std::string_view::npos || semi - amp > 10) {
+                out += '&';
+                i = amp + 1;
+                continue;
+            }
+            const std::string_view ref = text.substr(amp + 1, semi - amp - 1);
+            if (ref == "amp") out += '&';
+            else if (ref == "lt") out += '<';
+            else if (ref == "gt") out += '>';
+            else if (ref == "quot") out += '"';
+            else if (ref == "apos") out += '\'';
+            else if (ref.size() > 1 && ref[0] == '#') {
+                const bool hex = ref[1] == 'x' || ref[1] == 'X';
+                const std::string digits(ref.substr(hex ? 2 : 1));
+                char* end = nullptr;
+                const unsigned long codePoint = std::strtoul(digits.c_str(), &end, hex ? 16 : 10);
+                if (digits.empty() || *end != '\0') {
+                    out.append(text.substr(amp, semi - amp + 1));
+                } else {
+                    appendUtf8(out, static_cast<uint32_t>(codePoint));
+                }
+            } else {
+                out.append(text.substr(amp, semi - amp + 1));
+            }
+            i = semi + 1;
+        }
+        return out;
+    }
+
+    // Days from 1970-01-01 to the given civil date (proleptic Gregorian)
+    int64_t daysFromCivil(int64_t year, unsigned month, unsigned day) {
+        year -= month <= 2;
+        const int64_t era = (year >= 0 ? year : year - 399) / 400;
+        const auto yearOfEra = static_cast<unsigned>(year - era * 400);
+        const unsigned dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+        const unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return era * 146097 + static_cast<int64_t>(dayOfEra) - 719468;
+    }
+}
+
+struct SitemapParser::Inflater {
+    z_stream stream{};
+    bool ended = false;  // The last member's trailer has been read
+    size_t produced = 0;
+    char out[INFLATE_CHUNK];
+
+    Inflater() {
+        if (inflateInit2(&stream, 15 + 16) != Z_OK) {
+            throw std::runtime_error("Failed to initialize zlib");
+        }
+    }
+    ~Inflater() { inflateEnd(&stream); }
+};
+
+SitemapParser::SitemapParser(EntryHandler handler) : handler_(std::move(handler)) {
+    name_.reserve(MAX_NAME);
+    text_.reserve(256);
+}
+
+SitemapParser::~SitemapParser() = default;
+
+bool SitemapParser::feed(std::string_view data) {
+    if (error_) return false;
+    if (!sniffed_) {
+        // The gzip magic number decides how everything after it is read
+        sniffBuffer_.append(data);
+        if (sniffBuffer_.size() < 2) return true;
+        sniffed_ = true;
+        if (static_cast<unsigned char>(sniffBuffer_[0]) == 0x1f && static_cast<unsigned char>(sniffBuffer_[1]) == 0x8b) {
+            inflater_ = std::make_unique<Inflater>();
+        }
+        const std::string buffered = std::move(sniffBuffer_);
+        sniffBuffer_.clear();
+        return feed(buffered);
+    }
+    if (!inflater_) {
+        return parse(data);
+    }
+
+    z_stream& stream = inflater_->stream;
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    // A full output buffer may leave decompressed bytes inside zlib even with no input left
+    size_t produced = INFLATE_CHUNK;
+    while (stream.avail_in > 0 || produced == INFLATE_CHUNK) {
+        if (inflater_->ended) {
+            if (stream.avail_in == 0) break;
+            // Concatenated gzip members form one stream
+            inflateReset(&stream);
+            inflater_->ended = false;
+        }
+        stream.next_out = reinterpret_cast<Bytef*>(inflater_->out);
+        stream.avail_out = INFLATE_CHUNK;
+        const int status = inflate(&stream, Z_NO_FLUSH);
+        if (status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR) {
+            fail(stream.msg ? stream.msg : "corrupt gzip data");
+            return false;
+        }
+        produced = INFLATE_CHUNK - stream.avail_out;
+        inflater_->produced += produced;
+        if (inflater_->produced > MAX_INFLATED) {
+            fail("decompressed sitemap exceeds 256 MB");
+            return false;
+        }
+        if (!parse(std::string_view(inflater_->out, produced))) return false;
+        if (status == Z_STREAM_END) {
+            inflater_->ended = true;
+        } else if (produced == 0) {
+            break;  // Needs more input than this chunk holds
+        }
+    }
+    return !error_;
+}
+
+bool SitemapParser::finish() {
+    if (error_) return false;
+    if (!sniffed_ && !sniffBuffer_.empty()) {
+        sniffed_ = true;
+        const std::string buffered = std::move(sniffBuffer_);
+        parse(buffered);
+    }
+    if (inflater_ && !inflater_->ended) {
+        fail("truncated gzip stream");
+        return false;
+    }
+    if (state_ == State::Line) {
+        endLine();
+    }
+    return !error_;
+}
+
+bool SitemapParser::parse(std::string_view data) {
+    bytesParsed_ += data.size();
+    // The state machine works a byte at a time so tags, entities and terminators may be
+    // split across chunks
+    for (const char c : data) {
+        switch (state_) {
+            case State::Start:
+                if (c == '<') {
+                    state_ = State::TagOpen;
+                } else if (!isSpace(c) && c != '\xEF' && c != '\xBB' && c != '\xBF') {  // UTF-8 BOM
+                    kind_ = Kind::Text;
+                    state_ = State::Line;
+                    appendText(c);
+                    lineStarted_ = true;
+                }
+                break;
+
+            case State::Line:
+                if (c == '\n' || c == '\r') {
+                    if (lineStarted_) endLine();
+                } else if (lineStarted_ || !isSpace(c)) {
+                    appendText(c);
+                    lineStarted_ = true;
+                }
+                break;
+
+            case State::Text:
+                if (c == '<') {
+                    state_ = State::TagOpen;
+                } else if (field_ != Field::None) {
+                    appendText(c);
+                }
+                break;
+
+            case State::TagOpen:
+                if (c == '/') {
+                    closing_ = true;
+                    name_.clear();
+                    state_ = State::TagName;
+                } else if (c == '!') {
+                    markup_.clear();
+                    state_ = State::Markup;
+                } else if (c == '?') {
+                    tail_ = 0;
+                    state_ = State::Skip;  // Processing instruction, up to "?>"
+                } else {
+                    closing_ = false;
+                    name_.assign(1, c);
+                    state_ = State::TagName;
+                }
+                break;
+
+            case State::TagName:
+                if (!isSpace(c) && c != '/' && c != '>') {
+                    if (name_.size() < MAX_NAME) name_ += c;
+                    break;
+                }
+                selfClosing_ = false;
+                state_ = State::TagBody;
+                [[fallthrough]];
+
+            case State::TagBody:
+                if (c == '>') {
+                    if (closing_) {
+                        closeTag();
+                    } else {
+                        openTag();
+                        if (selfClosing_) closeTag();
+                    }
+                    state_ = State::Text;
+                } else if (c == '"' || c == '\'') {
+                    quote_ = c;
+                    selfClosing_ = false;
+                    state_ = State::TagQuote;
+                } else if (!isSpace(c)) {
+                    selfClosing_ = c == '/';
+                }
+                break;
+
+            case State::TagQuote:
+                if (c == quote_) state_ = State::TagBody;
+                break;
+
+            case State::Markup: {
+                markup_ += c;
+                constexpr std::string_view comment = "--";
+                constexpr std::string_view cdata = "[CDATA[";
+                tail_ = 0;
+                if (markup_ == comment) {
+                    state_ = State::Comment;
+                } else if (markup_ == cdata) {
+                    state_ = State::CData;
+                } else if (comment.substr(0, markup_.size()) != markup_ && cdata.substr(0, markup_.size()) != markup_) {
+                    state_ = c == '>' ? State::Text : State::Declaration;
+                }
+                break;
+            }
+
+            case State::Comment:
+                if (c == '-') {
+                    tail_ = tail_ < 2 ? tail_ + 1 : 2;
+                } else if (c == '>' && tail_ == 2) {
+                    state_ = State::Text;
+                } else {
+                    tail_ = 0;
+                }
+                break;
+
+            case State::CData:
+                if (field_ != Field::None) appendText(c);
+                if (c == ']') {
+                    tail_ = tail_ < 2 ? tail_ + 1 : 2;
+                } else if (c == '>' && tail_ == 2) {
+                    // The "]]" already appended belongs to the terminator
+                    if (field_ != Field::None && !overflow_) text_.resize(text_.size() - 3);
+                    state_ = State::Text;
+                } else {
+                    tail_ = 0;
+                }
+                break;
+
+            case State::Declaration:
+                if (c == '>') state_ = State::Text;  // DOCTYPE and the like; no internal subsets
+                break;
+
+            case State::Skip:
+                if (c == '?') {
+                    tail_ = 1;
+                } else if (c == '>' && tail_ == 1) {
+                    state_ = State::Text;
+                } else {
+                    tail_ = 0;
+                }
+                break;
+        }
+    }
+    return !error_;
+}
+
+void SitemapParser::openTag() {
+    ++depth_;
+    const std::string_view local = localName(name_);
+    if (depth_ == 1) {
+        if (local == "urlset") kind_ = Kind::UrlSet;
+        else if (local == "sitemapindex") kind_ = Kind::SitemapIndex;
+    } else if (entryDepth_ == 0 && depth_ == 2 && (local == "url" || local == "sitemap")) {
+        entryDepth_ = depth_;
+        entryIsSitemap_ = local == "sitemap";
+        entry_ = {};
+    } else if (entryDepth_ != 0 && depth_ == entryDepth_ + 1) {
+        // Extension elements such as <image:loc> sit deeper than this and are never read
+        field_ = local == "loc" ? Field::Loc : local == "lastmod" ? Field::LastMod : Field::None;
+        text_.clear();
+        overflow_ = false;
+    }
+}
+
+void SitemapParser::closeTag() {
+    if (depth_ == 0) return;
+    if (field_ != Field::None && depth_ == entryDepth_ + 1) {
+        endText();
+        field_ = Field::None;
+    } else if (entryDepth_ != 0 && depth_ == entryDepth_) {
+        if (!entry_.loc.empty()) {
+            ++entries_;
+            handler_(std::move(entry_), entryIsSitemap_);
+        }
+        entry_ = {};
+        entryDepth_ = 0;
+    }
+    --depth_;
+}
+
+void SitemapParser::appendText(char c) {
+    if (text_.size() < MAX_TEXT) {
+        text_ += c;
+    } else {
+        overflow_ = true;
+    }
+}
+
+void SitemapParser::endText() {
+    if (field_ == Field::Loc) {
+        entry_.loc = overflow_ ? std::string() : decodeEntities(trim(text_));
+    } else if (field_ == Field::LastMod) {
+        entry_.lastmod = parseW3cDate(trim(text_));
+    }
+    text_.clear();
+}
+
+void SitemapParser::endLine() {
+    const std::string_view line = trim(text_);
+    if (!overflow_ && (line.rfind("http://", 0) == 0 || line.rfind("https://", 0) == 0)) {
+        ++entries_;
+        handler_(Entry{std::string(line), 0}, false);
+    }
+    text_.clear();
+    overflow_ = false;
+    lineStarted_ = false;
+}
+
+void SitemapParser::fail(const char* message) {
+    if (!error_) error_ = message;
+}
+
+int64_t SitemapParser::parseW3cDate(std::string_view text) {
+    size_t pos = 0;
+    auto number = [&](size_t digits, int& value) {
+        if (pos + digits > text.size()) return false;
+        value = 0;
+        for (size_t i = 0; i < digits; ++i) {
+            const char c = text[pos + i];
+            if (c < '0' || c > '9') return false;
+            value = value * 10 + (c - '0');
+        }
+        pos += digits;
+        return true;
+    };
+    auto expect = [&](char c) {
+        if (pos < text.size() && text[pos] == c) {
+            ++pos;
+            return true;
+        }
+        return false;
+    };
+
+    int year = 0, month = 1, day = 1, hour = 0, minute = 0, second = 0;
+    if (!number(4, year)) return 0;
+    if (expect('-')) {
+        if (!number(2, month)) return 0;
+        if (expect('-') && !number(2, day)) return 0;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > 31) return 0;
+
+    int64_t offset = 0;
+    if (expect('T')) {
+        if (!number(2, hour) || !expect(':') || !number(2, minute)) return 0;
+        if (expect(':')) {
+            if (!number(2, second)) return 0;
+            if (expect('.')) {
+                while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') ++pos;
+            }
+        }
+        if (hour > 23 || minute > 59 || second > 60) return 0;
+        if (expect('Z')) {
+            // UTC
+        } else if (pos < text.size() && (text[pos] == '+' || text[pos] == '-')) {
+            const int sign = text[pos++] == '-' ? -1 : 1;
+            int offsetHours = 0, offsetMinutes = 0;
+            if (!number(2, offsetHours) || !expect(':') || !number(2, offsetMinutes)) return 0;
+            offset = sign * (offsetHours * 3600 + offsetMinutes * 60);
+        }
+    }
+    if (pos != text.size()) return 0;
+
+    const int64_t seconds = daysFromCivil(year, static_cast<unsigned>(month), static_cast<unsigned>(day)) * 86400
+                            + hour * 3600 + minute * 60 + second - offset;
+    return seconds > 0 ? seconds : 0;
+}
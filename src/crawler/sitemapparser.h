@@ -0,0 +1,99 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// Incremental sitemap reader. Bytes are fed as they arrive from the network and entries
+// are reported as soon as their closing tag is seen, so memory stays constant however
+// large the sitemap is. Handles <urlset> and <sitemapindex> documents, plain-text
+// sitemaps (one URL per line) and gzip-compressed input of either kind, which is
+// detected from the first bytes rather than the file name.
+class SitemapParser
+{
+public:
+    enum class Kind { Unknown, UrlSet, SitemapIndex, Text };
+
+    struct Entry {
+        std::string loc;
+        int64_t lastmod = 0;  // Seconds since the Unix epoch; zero when absent or unparsable
+    };
+
+    // Receives <url> entries (isSitemap false) and <sitemap> entries of an index (true)
+    using EntryHandler = std::function<void(Entry&& entry, bool isSitemap)>;
+
+    explicit SitemapParser(EntryHandler handler);
+    ~SitemapParser();
+
+    SitemapParser(const SitemapParser&) = delete;
+    SitemapParser& operator=(const SitemapParser&) = delete;
+
+    // Returns false once the input is found to be corrupt; later calls are ignored
+    bool feed(std::string_view data);
+    // Flushes a trailing text line; returns false if the input was corrupt or truncated
+    bool finish();
+
+    [[nodiscard]] Kind kind() const { return kind_; }
+    [[nodiscard]] size_t entryCount() const { return entries_; }
+    [[nodiscard]] size_t bytesParsed() const { return bytesParsed_; }  // After decompression
+    [[nodiscard]] const std::optional<std::string>& error() const { return error_; }
+
+    // W3C datetime (YYYY, YYYY-MM, YYYY-MM-DD or YYYY-MM-DDThh:mm[:ss[.s]]TZD) to Unix
+    // seconds; zero if the text is not one
+    static int64_t parseW3cDate(std::string_view text);
+
+private:
+    enum class State : uint8_t {
+        Start, Text, TagOpen, TagName, TagBody, TagQuote, Markup, Comment, CData, Declaration,
+        Skip, Line
+    };
+    enum class Field : uint8_t { None, Loc, LastMod };
+
+    static constexpr size_t MAX_TEXT = 4096;  // Longer locs are dropped; the protocol allows 2048
+    static constexpr size_t MAX_NAME = 64;
+
+    EntryHandler handler_;
+    Kind kind_ = Kind::Unknown;
+    State state_ = State::Start;
+    std::optional<std::string> error_;
+    size_t entries_ = 0;
+    size_t bytesParsed_ = 0;
+
+    // gzip input; null until the magic bytes are seen
+    struct Inflater;
+    std::unique_ptr<Inflater> inflater_;
+    bool sniffed_ = false;
+    std::string sniffBuffer_;
+
+    // Tokenizer state, all bounded in size
+    std::string name_;
+    std::string text_;
+    std::string markup_;        // Lookahead after "<!" to tell comments, CDATA and DOCTYPE apart
+    bool closing_ = false;      // Current tag is </...>
+    bool selfClosing_ = false;  // Last non-space character in the tag body was '/'
+    char quote_ = 0;
+    uint8_t tail_ = 0;          // Matched length of the terminator of a comment, CDATA or PI
+    bool overflow_ = false;
+    bool lineStarted_ = false;  // Text sitemap: a non-space byte has been seen on this line
+
+    size_t depth_ = 0;
+    size_t entryDepth_ = 0;     // Depth of the open <url> or <sitemap>; zero outside one
+    bool entryIsSitemap_ = false;
+    Field field_ = Field::None;
+    Entry entry_;
+
+    bool parse(std::string_view data);
+    void sniff(std::string_view data);
+    void openTag();
+    void closeTag();
+    void appendText(char c);
+    void endText();
+    void endLine();
+    void fail(const char* message);
+};
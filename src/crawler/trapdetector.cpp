@@ -0,0 +1,362 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#include "trapdetector.h"
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+namespace {
+    // Query parameters that carry a session rather than select content
+    constexpr std::string_view SESSION_PARAMS[] = {
+        "sid", "sessid", "sessionid", "session_id", "phpsessid", "jsessionid", "aspsessionid", "cfid", "cftoken"
+    };
+
+    // A segment counts as a random token (an ID, hash or UUID) rather than a word when it
+    // switches between letters and digits at least this often; slugs like "top-10-tips-2024"
+    // switch rarely, "550e8400-e29b-41d4" constantly
+    constexpr size_t TOKEN_MIN_LENGTH = 8;
+    constexpr size_t TOKEN_MIN_SWITCHES = 4;
+
+    struct UrlParts {
+        std::string_view host;   // With the port, if any
+        std::string_view path;
+        std::string_view query;
+        bool valid = false;
+    };
+
+    UrlParts splitUrl(std::string_view url) {
+        UrlParts parts;
+        size_t pos;
+        if (url.starts_with("http://")) {
+            pos = 7;
+        } else if (url.starts_with("https://")) {
+            pos = 8;
+        } else {
+            return parts;
+        }
+        const size_t hostEnd = std::min(url.find_first_of("/?#", pos), url.size());
+        parts.host = url.substr(pos, hostEnd - pos);
+        const size_t fragment = std::min(url.find('#', hostEnd), url.size());
+        const size_t query = std::min(url.find('?', hostEnd), fragment);
+        parts.path = url.substr(hostEnd, query - hostEnd);
+        if (query < fragment) {
+            parts.query = url.substr(query + 1, fragment - query - 1);
+        }
+        parts.valid = !parts.host.empty();
+        return parts;
+    }
+
+    // Calls fn for each non-empty piece of text between separators
+    template <typename Fn>
+    void forEachPiece(std::string_view text, char separator, Fn&& fn) {
+        size_t start = 0;
+        while (start <= text.size()) {
+            const size_t end = std::min(text.find(separator, start), text.size());
+            if (end > start) fn(text.substr(start, end - start));
+            start = end + 1;
+        }
+    }
+
+    unsigned char lower(unsigned char c) {
+        return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c + ('a' - 'A')) : c;
+    }
+
+    bool isDigit(unsigned char c) { return c >= '0' && c <= '9'; }
+    bool isLetter(unsigned char c) { return lower(c) >= 'a' && lower(c) <= 'z'; }
+
+    bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (lower(static_cast<unsigned char>(a[i])) != lower(static_cast<unsigned char>(b[i]))) return false;
+        }
+        return true;
+    }
+
+    bool containsIgnoreCase(std::string_view text, std::string_view needle) {
+        if (needle.size() > text.size()) return false;
+        for (size_t i = 0; i + needle.size() <= text.size(); ++i) {
+            if (equalsIgnoreCase(text.substr(i, needle.size()), needle)) return true;
+        }
+        return false;
+    }
+
+    bool isSessionParam(std::string_view name) {
+        return std::any_of(std::begin(SESSION_PARAMS), std::end(SESSION_PARAMS),
+                           [name](std::string_view session) { return equalsIgnoreCase(name, session); });
+    }
+
+    // ";jsessionid=..." matrix parameters and ASP.NET's cookieless "(S(...))" segments
+    bool isSessionSegment(std::string_view segment) {
+        if (segment.size() > 3 && segment[0] == '(' && lower(segment[1]) == 's' && segment[2] == '(') return true;
+        const size_t semicolon = segment.find(';');
+        if (semicolon == std::string_view::npos) return false;
+        const std::string_view matrix = segment.substr(semicolon + 1);
+        const std::string_view name = matrix.substr(0, matrix.find('='));
+        return isSessionParam(name) || containsIgnoreCase(name, "session");
+    }
+
+    bool isToken(std::string_view segment) {
+        if (segment.size() < TOKEN_MIN_LENGTH) return false;
+        size_t switches = 0;
+        for (size_t i = 0; i < segment.size(); ++i) {
+            const auto c = static_cast<unsigned char>(segment[i]);
+            if (!isDigit(c) && !isLetter(c) && c != '-' && c != '_') return false;
+            if (i > 0) {
+                const auto prev = static_cast<unsigned char>(segment[i - 1]);
+                if ((isDigit(c) && isLetter(prev)) || (isLetter(c) && isDigit(prev))) ++switches;
+            }
+        }
+        return switches >= TOKEN_MIN_SWITCHES;
+    }
+
+    // "page-12" -> "page-#", "2024-05-01" -> "#-#-#", tokens -> "{id}"
+    void appendShape(std::string& out, std::string_view segment) {
+        segment = segment.substr(0, segment.find(';'));
+        if (isToken(segment)) {
+            out += "{id}";
+            return;
+        }
+        bool inDigits = false;
+        for (char c : segment) {
+            if (isDigit(static_cast<unsigned char>(c))) {
+                if (!inDigits) out += '#';
+                inDigits = true;
+            } else {
+                out += c;
+                inDigits = false;
+            }
+        }
+    }
+
+    // FNV-1a. A collision only lets a URL or value pass as one already admitted
+    uint64_t hashBytes(std::string_view bytes) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (unsigned char c : bytes) {
+            hash = (hash ^ c) * 0x100000001b3ULL;
+        }
+        return hash;
+    }
+}
+
+TrapDetector::TrapDetector(const Options& options) : options_(options) {
+    if (!options_.logFile.empty()) {
+        log_ = std::fopen(options_.logFile.c_str(), "wb");
+        if (!log_) {
+            throw std::runtime_error("Failed to open trap log: " + options_.logFile);
+        }
+    }
+}
+
+TrapDetector::~TrapDetector() {
+    if (log_) {
+        std::fclose(log_);
+    }
+}
+
+const char* TrapDetector::verdictName(Verdict verdict) {
+    switch (verdict) {
+        case Verdict::Accept: return "accept";
+        case Verdict::TooLong: return "too_long";
+        case Verdict::TooDeep: return "too_deep";
+        case Verdict::RepeatedSegment: return "repeated_segment";
+        case Verdict::SessionId: return "session_id";
+        case Verdict::PatternCap: return "pattern_cap";
+        case Verdict::ParamCardinality: return "param_cardinality";
+        case Verdict::DuplicateContent: return "duplicate_content";
+        case Verdict::Count: break;
+    }
+    return "unknown";
+}
+
+std::string TrapDetector::patternOf(std::string_view url) {
+    const UrlParts parts = splitUrl(url);
+    if (!parts.valid) return {};
+
+    std::string pattern(parts.host);
+    pattern.reserve(url.size());
+    forEachPiece(parts.path, '/', [&pattern](std::string_view segment) {
+        pattern += '/';
+        appendShape(pattern, segment);
+    });
+    if (!parts.path.empty() && parts.path.back() == '/') {
+        pattern += '/';
+    }
+
+    if (!parts.query.empty()) {
+        std::vector<std::string_view> names;
+        forEachPiece(parts.query, '&', [&names](std::string_view param) {
+            names.push_back(param.substr(0, param.find('=')));
+        });
+        std::sort(names.begin(), names.end());
+        names.erase(std::unique(names.begin(), names.end()), names.end());
+        char separator = '?';
+        for (const auto name : names) {
+            pattern += separator;
+            pattern += name;
+            separator = '&';
+        }
+    }
+    return pattern;
+}
+
+TrapDetector::Verdict TrapDetector::admit(std::string_view url) {
+    Verdict verdict = checkShape(url);
+    if (verdict == Verdict::Accept) {
+        const std::string pattern = patternOf(url);
+        if (!pattern.empty()) {
+            verdict = checkPattern(url, pattern);
+        }
+    }
+    if (verdict != Verdict::Accept) {
+        return drop(url, verdict);
+    }
+    verdicts_[static_cast<size_t>(Verdict::Accept)].fetch_add(1, std::memory_order_relaxed);
+    return verdict;
+}
+
+// Rules that need no history: length, depth, self-repeating paths and session IDs
+TrapDetector::Verdict TrapDetector::checkShape(std::string_view url) const {
+    if (url.size() > options_.maxUrlLength) return Verdict::TooLong;
+    const UrlParts parts = splitUrl(url);
+    if (!parts.valid) return Verdict::Accept;
+
+    std::vector<std::string_view> segments;
+    bool session = false;
+    forEachPiece(parts.path, '/', [&](std::string_view segment) {
+        segments.push_back(segment);
+        session = session || isSessionSegment(segment);
+    });
+    if (segments.size() > options_.maxPathDepth) return Verdict::TooDeep;
+    for (size_t i = 0; i < segments.size(); ++i) {
+        size_t occurrences = 1;
+        for (size_t j = i + 1; j < segments.size(); ++j) {
+            if (segments[j] == segments[i]) ++occurrences;
+        }
+        if (occurrences > options_.maxSegmentRepeats) return Verdict::RepeatedSegment;
+    }
+
+    forEachPiece(parts.query, '&', [&session](std::string_view param) {
+        session = session || isSessionParam(param.substr(0, param.find('=')));
+    });
+    return session ? Verdict::SessionId : Verdict::Accept;
+}
+
+TrapDetector::Verdict TrapDetector::checkPattern(std::string_view url, const std::string& pattern) {
+    Shard& shard = shardFor(pattern);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.patterns.find(pattern);
+    if (it == shard.patterns.end()) {
+        if (patternCount_.load(std::memory_order_relaxed) >= options_.maxPatterns) {
+            return Verdict::Accept;  // Untracked rather than refused
+        }
+        it = shard.patterns.emplace(pattern, Pattern{}).first;
+        patternCount_.fetch_add(1, std::memory_order_relaxed);
+    }
+    Pattern& entry = it->second;
+
+    const uint64_t urlHash = hashBytes(url);
+    if (entry.trapped) {
+        ++entry.dropped;
+        return Verdict::DuplicateContent;
+    }
+    if (entry.urls.count(urlHash)) return Verdict::Accept;
+    if (entry.urls.size() >= options_.maxPerPattern) {
+        ++entry.dropped;
+        return Verdict::PatternCap;
+    }
+
+    // Check every parameter before recording any, so a refused URL leaves no trace
+    std::vector<std::pair<Param*, uint64_t>> newValues;
+    bool overflow = false;
+    forEachPiece(splitUrl(url).query, '&', [&](std::string_view param) {
+        const size_t equals = param.find('=');
+        const std::string_view name = param.substr(0, equals);
+        const uint64_t valueHash = equals == std::string_view::npos ? 0 : hashBytes(param.substr(equals + 1));
+        auto found = std::find_if(entry.params.begin(), entry.params.end(),
+                                  [name](const Param& p) { return p.name == name; });
+        if (found == entry.params.end()) {
+            entry.params.push_back({std::string(name), {}});
+            found = entry.params.end() - 1;
+        }
+        if (found->values.count(valueHash)) return;
+        if (found->values.size() >= options_.maxParamValues) {
+            overflow = true;
+        } else {
+            newValues.emplace_back(&*found, valueHash);
+        }
+    });
+    if (overflow) {
+        ++entry.dropped;
+        return Verdict::ParamCardinality;
+    }
+    for (const auto& [param, valueHash] : newValues) {
+        param->values.insert(valueHash);
+    }
+    entry.urls.insert(urlHash);
+    return Verdict::Accept;
+}
+
+void TrapDetector::recordContent(std::string_view url, uint64_t contentHash) {
+    const std::string pattern = patternOf(url);
+    if (pattern.empty()) return;
+    Shard& shard = shardFor(pattern);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    const auto it = shard.patterns.find(pattern);
+    if (it == shard.patterns.end()) return;
+    Pattern& entry = it->second;
+    ++entry.fetched;
+    if (entry.contents.count(contentHash)) {
+        ++entry.duplicates;
+    } else if (entry.contents.size() < options_.maxPerPattern) {
+        entry.contents.insert(contentHash);
+    }
+    if (entry.fetched >= options_.duplicateSamples &&
+        static_cast<double>(entry.duplicates) >= options_.duplicateRatio * static_cast<double>(entry.fetched)) {
+        entry.trapped = true;
+    }
+}
+
+TrapDetector::Verdict TrapDetector::drop(std::string_view url, Verdict verdict) {
+    verdicts_[static_cast<size_t>(verdict)].fetch_add(1, std::memory_order_relaxed);
+    if (log_) {
+        std::lock_guard<std::mutex> lock(logMutex_);
+        std::fprintf(log_, "%s\t%.*s\n", verdictName(verdict), static_cast<int>(url.size()), url.data());
+    }
+    return verdict;
+}
+
+TrapDetector::Shard& TrapDetector::shardFor(const std::string& pattern) {
+    return shards_[std::hash<std::string>{}(pattern) % SHARD_COUNT];
+}
+
+uint64_t TrapDetector::dropped() const {
+    uint64_t total = 0;
+    for (size_t v = 1; v < verdicts_.size(); ++v) {
+        total += verdicts_[v].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+TrapDetector::Stats TrapDetector::stats(size_t worst) const {
+    Stats stats;
+    for (size_t v = 0; v < verdicts_.size(); ++v) {
+        stats.verdicts[v] = verdicts_[v].load(std::memory_order_relaxed);
+    }
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        stats.patterns += shard.patterns.size();
+        for (const auto& [pattern, entry] : shard.patterns) {
+            if (entry.trapped) ++stats.trappedPatterns;
+            if (entry.dropped > 0) stats.worst.emplace_back(pattern, entry.dropped);
+        }
+    }
+    const size_t keep = std::min(worst, stats.worst.size());
+    std::partial_sort(stats.worst.begin(), stats.worst.begin() + static_cast<std::ptrdiff_t>(keep), stats.worst.end(),
+                      [](const auto& a, const auto& b) { return a.second > b.second; });
+    stats.worst.resize(keep);
+    return stats;
+}
@@ -0,0 +1,111 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Guards the crawl budget against infinite URL spaces: calendars, faceted search, session
+// IDs and relative links that grow a path without end. Discovered URLs are grouped into
+// per-host pattern templates, where digit runs and random-looking tokens in the path are
+// abstracted and query values dropped ("shop.example/item/#/{id}?color&size"). Each
+// template admits a bounded number of distinct URLs and distinct values per parameter, and
+// stops admitting once most of its fetched pages turn out to duplicate one another. URLs
+// that are absurdly long or deep, repeat a path segment or carry a session ID are dropped
+// outright. Thread-safe; templates are spread over independently locked shards.
+class TrapDetector
+{
+public:
+    enum class Verdict {
+        Accept, TooLong, TooDeep, RepeatedSegment, SessionId, PatternCap, ParamCardinality, DuplicateContent, Count
+    };
+
+    struct Options {
+        size_t maxUrlLength = 2048;
+        size_t maxPathDepth = 24;
+        size_t maxSegmentRepeats = 2;    // Times one path segment may occur in a path
+        size_t maxPerPattern = 5000;     // Distinct URLs admitted per template
+        size_t maxParamValues = 100;     // Distinct values per query parameter per template
+        // A template whose fetched pages are at least duplicateRatio duplicates of its own
+        // earlier pages, over at least duplicateSamples fetches, admits nothing new
+        size_t duplicateSamples = 32;
+        double duplicateRatio = 0.5;
+        size_t maxPatterns = 200000;     // Templates past this are admitted untracked
+        std::string logFile;             // "reason<TAB>url" per dropped URL (empty = off)
+    };
+
+    struct Stats {
+        std::array<uint64_t, static_cast<size_t>(Verdict::Count)> verdicts{};
+        size_t patterns = 0;
+        size_t trappedPatterns = 0;  // Closed because of duplicate content
+        // Templates with the most dropped URLs, most first
+        std::vector<std::pair<std::string, uint64_t>> worst;
+    };
+
+    // Throws std::runtime_error if the log file cannot be opened
+    explicit TrapDetector(const Options& options);
+    ~TrapDetector();
+
+    TrapDetector(const TrapDetector&) = delete;
+    TrapDetector& operator=(const TrapDetector&) = delete;
+
+    // Decides on a discovered URL and, if accepted, counts it against its template.
+    // Admitting the same URL again is free and always accepted while its template is open
+    Verdict admit(std::string_view url);
+    // Feeds back a fetched page's content hash, so templates full of duplicates close
+    void recordContent(std::string_view url, uint64_t contentHash);
+
+    [[nodiscard]] uint64_t dropped() const;
+    [[nodiscard]] Stats stats(size_t worst = 5) const;
+
+    static const char* verdictName(Verdict verdict);
+    // The template a URL falls under; empty for a URL that is not http(s)
+    static std::string patternOf(std::string_view url);
+
+private:
+    struct Param {
+        std::string name;
+        std::unordered_set<uint64_t> values;  // Hashes; stops growing at maxParamValues
+    };
+
+    struct Pattern {
+        std::unordered_set<uint64_t> urls;    // Hashes of admitted URLs
+        std::vector<Param> params;
+        std::unordered_set<uint64_t> contents;
+        uint64_t fetched = 0;
+        uint64_t duplicates = 0;
+        uint64_t dropped = 0;
+        bool trapped = false;
+    };
+
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, Pattern> patterns;
+    };
+
+    static constexpr size_t SHARD_COUNT = 16;
+
+    Options options_;
+    std::array<Shard, SHARD_COUNT> shards_;
+    std::atomic<size_t> patternCount_{0};
+    std::array<std::atomic<uint64_t>, static_cast<size_t>(Verdict::Count)> verdicts_{};
+
+    std::mutex logMutex_;
+    std::FILE* log_ = nullptr;
+
+    [[nodiscard]] Verdict checkShape(std::string_view url) const;
+    Verdict checkPattern(std::string_view url, const std::string& pattern);
+    Verdict drop(std::string_view url, Verdict verdict);
+    Shard& shardFor(const std::string& pattern);
+};
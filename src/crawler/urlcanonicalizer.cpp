@@ -0,0 +1,342 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#include "urlcanonicalizer.h"
+#include <algorithm>
+
+namespace {
+    constexpr char HEX_DIGITS[] = "0123456789ABCDEF";
+
+    // A URL split without copying: [scheme:][//authority]path[?query]
+    struct Parts {
+        std::string_view scheme;
+        std::string_view authority;
+        std::string_view path;
+        std::string_view query;
+        bool hasAuthority = false;
+        bool hasQuery = false;
+    };
+
+    bool isAlpha(unsigned char c) { return (c | 0x20) >= 'a' && (c | 0x20) <= 'z'; }
+    bool isDigit(unsigned char c) { return c >= '0' && c <= '9'; }
+    bool isHex(unsigned char c) { return isDigit(c) || ((c | 0x20) >= 'a' && (c | 0x20) <= 'f'); }
+    unsigned char hexValue(unsigned char c) { return isDigit(c) ? c - '0' : (c | 0x20) - 'a' + 10; }
+    char lower(char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c; }
+
+    bool isUnreserved(unsigned char c) {
+        return isAlpha(c) || isDigit(c) || c == '-' || c == '.' || c == '_' || c == '~';
+    }
+
+    // Bytes that may not appear unescaped in a path or query
+    bool mustEscape(unsigned char c) {
+        return c <= 0x20 || c >= 0x7f || c == '"' || c == '<' || c == '>' || c == '\\' || c == '^' || c == '`' ||
+               c == '{' || c == '|' || c == '}';
+    }
+
+    bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+        return a.size() == b.size() &&
+               std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) { return lower(x) == lower(y); });
+    }
+
+    void appendEscaped(std::string& out, unsigned char c) {
+        out += '%';
+        out += HEX_DIGITS[c >> 4];
+        out += HEX_DIGITS[c & 15];
+    }
+
+    // Unreserved characters decoded, every other escape upper-cased, stray '%' and bytes
+    // that must not appear raw escaped
+    void appendNormalized(std::string& out, std::string_view text) {
+        for (size_t i = 0; i < text.size(); ++i) {
+            const auto c = static_cast<unsigned char>(text[i]);
+            if (c == '%') {
+                if (i + 2 < text.size() && isHex(text[i + 1]) && isHex(text[i + 2])) {
+                    const auto value = static_cast<unsigned char>(hexValue(text[i + 1]) * 16 + hexValue(text[i + 2]));
+                    if (isUnreserved(value)) {
+                        out += static_cast<char>(value);
+                    } else {
+                        appendEscaped(out, value);
+                    }
+                    i += 2;
+                } else {
+                    appendEscaped(out, '%');
+                }
+            } else if (mustEscape(c)) {
+                appendEscaped(out, c);
+            } else {
+                out += static_cast<char>(c);
+            }
+        }
+    }
+
+    // Length of a leading "scheme:" without the colon; zero if there is none
+    size_t schemeLength(std::string_view text) {
+        if (text.empty() || !isAlpha(text[0])) return 0;
+        for (size_t i = 1; i < text.size(); ++i) {
+            const auto c = static_cast<unsigned char>(text[i]);
+            if (c == ':') return i;
+            if (!isAlpha(c) && !isDigit(c) && c != '+' && c != '-' && c != '.') return 0;
+        }
+        return 0;
+    }
+
+    Parts split(std::string_view text) {
+        Parts parts;
+        size_t pos = 0;
+        if (const size_t length = schemeLength(text)) {
+            parts.scheme = text.substr(0, length);
+            pos = length + 1;
+        }
+        if (text.substr(pos).starts_with("//")) {
+            const size_t end = std::min(text.find_first_of("/?", pos + 2), text.size());
+            parts.authority = text.substr(pos + 2, end - pos - 2);
+            parts.hasAuthority = true;
+            pos = end;
+        }
+        const size_t query = std::min(text.find('?', pos), text.size());
+        parts.path = text.substr(pos, query - pos);
+        if (query < text.size()) {
+            parts.query = text.substr(query + 1);
+            parts.hasQuery = true;
+        }
+        return parts;
+    }
+
+    bool isHttp(std::string_view scheme) {
+        return equalsIgnoreCase(scheme, "http") || equalsIgnoreCase(scheme, "https");
+    }
+
+    // userinfo@host:port with the host lower-cased, a trailing root dot and a default port
+    // dropped; false if the host is missing or the port is not a port
+    bool appendAuthority(std::string& out, std::string_view authority, bool https) {
+        const size_t at = authority.rfind('@');
+        if (at != std::string_view::npos) {
+            out.append(authority.data(), at + 1);
+            authority.remove_prefix(at + 1);
+        }
+        if (authority.empty()) return false;
+        size_t hostEnd = authority[0] == '[' ? authority.find(']') : authority.find(':');
+        if (authority[0] == '[') {
+            if (hostEnd == std::string_view::npos) return false;
+            ++hostEnd;
+        }
+        hostEnd = std::min(hostEnd, authority.size());
+        std::string_view host = authority.substr(0, hostEnd);
+        if (host.size() > 1 && host.back() == '.') host.remove_suffix(1);
+        if (host.empty()) return false;
+        for (char c : host) {
+            if (mustEscape(static_cast<unsigned char>(c)) || c == '/' || c == '?' || c == '#') return false;
+            out += lower(c);
+        }
+
+        std::string_view port = authority.substr(hostEnd);
+        if (port.empty()) return true;
+        if (port[0] != ':') return false;
+        port.remove_prefix(1);
+        unsigned value = 0;
+        for (char c : port) {
+            if (!isDigit(c)) return false;
+            value = value * 10 + static_cast<unsigned>(c - '0');
+            if (value > 65535) return false;
+        }
+        if (!port.empty() && value != (https ? 443u : 80u)) {
+            out += ':';
+            out += std::to_string(value);
+        }
+        return true;
+    }
+}
+
+UrlCanonicalizer::UrlCanonicalizer(const Options& options) : options_(options) {
+    for (const auto& param : options_.stripParams) {
+        StripRule rule;
+        rule.prefix = !param.empty() && param.back() == '*';
+        for (char c : std::string_view(param).substr(0, param.size() - (rule.prefix ? 1 : 0))) {
+            rule.name += lower(c);
+        }
+        stripRules_.push_back(std::move(rule));
+    }
+}
+
+const UrlCanonicalizer& UrlCanonicalizer::standard() {
+    static const UrlCanonicalizer instance;
+    return instance;
+}
+
+bool UrlCanonicalizer::stripped(std::string_view name) const {
+    return std::any_of(stripRules_.begin(), stripRules_.end(), [name](const StripRule& rule) {
+        return rule.prefix ? name.size() >= rule.name.size() && equalsIgnoreCase(name.substr(0, rule.name.size()), rule.name)
+                           : equalsIgnoreCase(name, rule.name);
+    });
+}
+
+std::optional<std::string> UrlCanonicalizer::canonicalize(std::string_view url) const {
+    std::string out;
+    if (!canonicalize(url, {}, out)) return std::nullopt;
+    return out;
+}
+
+bool UrlCanonicalizer::canonicalize(std::string_view reference, std::string_view base, std::string& out,
+                                    bool* rewritten) const {
+    // Surrounding spaces are dropped and tabs and newlines inside ignored, as browsers do
+    const size_t givenSize = reference.size();
+    while (!reference.empty() && static_cast<unsigned char>(reference.front()) <= 0x20) reference.remove_prefix(1);
+    while (!reference.empty() && static_cast<unsigned char>(reference.back()) <= 0x20) reference.remove_suffix(1);
+    thread_local std::string cleaned;
+    if (reference.find_first_of("\t\r\n") != std::string_view::npos) {
+        cleaned.clear();
+        for (char c : reference) {
+            if (c != '\t' && c != '\r' && c != '\n') cleaned += c;
+        }
+        reference = cleaned;
+    }
+    // Each part written is compared with the part it came from, to tell whether anything
+    // besides resolution changed
+    bool changed = reference.size() != givenSize;
+    reference = reference.substr(0, reference.find('#'));
+
+    // Reference resolution, RFC 3986 section 5.2.2
+    const Parts ref = split(reference);
+    Parts target;
+    thread_local std::string merged;
+    if (!ref.scheme.empty()) {
+        if (!isHttp(ref.scheme)) return false;
+        target = ref;
+    } else {
+        const Parts from = split(base.substr(0, base.find('#')));
+        if (!isHttp(from.scheme) || !from.hasAuthority) return false;
+        target.scheme = from.scheme;
+        if (ref.hasAuthority) {
+            target.authority = ref.authority;
+            target.hasAuthority = true;
+            target.path = ref.path;
+        } else {
+            target.authority = from.authority;
+            target.hasAuthority = true;
+            if (ref.path.empty()) {
+                target.path = from.path;
+            } else if (ref.path[0] == '/') {
+                target.path = ref.path;
+            } else {
+                // Merge with everything up to the last '/' of the base path
+                const size_t slash = from.path.rfind('/');
+                merged.assign(slash == std::string_view::npos ? std::string_view("/") : from.path.substr(0, slash + 1));
+                merged.append(ref.path);
+                target.path = merged;
+            }
+        }
+        const bool ownQuery = ref.hasQuery || !ref.path.empty() || ref.hasAuthority;
+        target.query = ownQuery ? ref.query : from.query;
+        target.hasQuery = ownQuery ? ref.hasQuery : from.hasQuery;
+    }
+    if (!target.hasAuthority || target.authority.empty()) return false;
+
+    const bool https = equalsIgnoreCase(target.scheme, "https");
+    out.clear();
+    out += https ? "https://" : "http://";
+    changed = changed || target.scheme != (https ? "https" : "http");
+    const size_t authorityStart = out.size();
+    if (!appendAuthority(out, target.authority, https)) return false;
+    changed = changed || std::string_view(out).substr(authorityStart) != target.authority;
+
+    // Dot segments are removed as the path is copied (RFC 3986 section 5.2.4), after
+    // normalizing each segment so "%2E%2E" counts as ".."
+    const size_t pathStart = out.size();
+    std::string_view path = target.path;
+    if (!path.empty() && path[0] == '/') path.remove_prefix(1);
+    size_t pos = 0;
+    while (!target.path.empty() && pos <= path.size()) {
+        const size_t end = std::min(path.find('/', pos), path.size());
+        const bool last = end == path.size();
+        std::string_view segment = path.substr(pos, end - pos);
+        pos = end + 1;
+
+        // Session IDs as path parameters ("/cart;jsessionid=...")
+        for (size_t semicolon = segment.find(';'); semicolon != std::string_view::npos;
+             semicolon = segment.find(';', semicolon + 1)) {
+            const std::string_view param = segment.substr(semicolon + 1);
+            if (stripped(param.substr(0, param.find_first_of("=;")))) {
+                segment = segment.substr(0, semicolon);
+                break;
+            }
+        }
+
+        const size_t segmentStart = out.size();
+        out += '/';
+        appendNormalized(out, segment);
+        const std::string_view written = std::string_view(out).substr(segmentStart + 1);
+        const bool parentDir = written == "..";
+        if (parentDir || written == ".") {
+            out.resize(segmentStart);
+            if (parentDir) {
+                const size_t parent = out.rfind('/');
+                if (parent != std::string::npos && parent >= pathStart) out.resize(parent);
+            }
+            if (last) out += '/';
+        }
+    }
+    if (out.size() == pathStart) {
+        out += '/';
+    } else if (options_.stripTrailingSlash && out.size() - pathStart > 1 && out.back() == '/') {
+        out.pop_back();
+    }
+
+    changed = changed || std::string_view(out).substr(pathStart) != target.path;
+
+    if (target.hasQuery) {
+        const size_t queryStart = out.size();
+        appendQuery(out, target.query);
+        changed = changed || out.size() == queryStart || std::string_view(out).substr(queryStart + 1) != target.query;
+    }
+    if (rewritten) *rewritten = changed;
+    return true;
+}
+
+// Drops stripped and empty parameters, normalizes the rest and sorts them by name
+void UrlCanonicalizer::appendQuery(std::string& out, std::string_view query) const {
+    struct Param {
+        size_t offset;
+        size_t length;
+        size_t nameLength;
+    };
+    thread_local std::string scratch;
+    thread_local std::vector<Param> params;
+    scratch.clear();
+    params.clear();
+
+    size_t pos = 0;
+    while (pos <= query.size()) {
+        const size_t end = std::min(query.find('&', pos), query.size());
+        const std::string_view piece = query.substr(pos, end - pos);
+        pos = end + 1;
+        if (piece.empty()) continue;
+        const size_t equals = piece.find('=');
+        const std::string_view name = piece.substr(0, equals);
+        if (stripped(name)) continue;
+
+        Param param{scratch.size(), 0, 0};
+        appendNormalized(scratch, name);
+        param.nameLength = scratch.size() - param.offset;
+        if (equals != std::string_view::npos) {
+            scratch += '=';
+            appendNormalized(scratch, piece.substr(equals + 1));
+        }
+        param.length = scratch.size() - param.offset;
+        params.push_back(param);
+    }
+    if (params.empty()) return;
+
+    if (options_.sortQuery) {
+        const std::string_view text = scratch;
+        std::stable_sort(params.begin(), params.end(), [text](const Param& a, const Param& b) {
+            return text.substr(a.offset, a.nameLength) < text.substr(b.offset, b.nameLength);
+        });
+    }
+    char separator = '?';
+    for (const auto& param : params) {
+        out += separator;
+        out.append(scratch, param.offset, param.length);
+        separator = '&';
+    }
+}
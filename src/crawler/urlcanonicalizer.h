@@ -0,0 +1,62 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#pragma once
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Turns a link into the one spelling of its URL the crawler dedups on. Relative references
+// are resolved against the page's URL per RFC 3986 section 5, then the result is normalized:
+// scheme and host lower-cased, default port and fragment dropped, dot segments removed,
+// percent-encoding made canonical (unreserved characters decoded, other escapes upper-cased,
+// characters that may not appear raw encoded), session path parameters and tracking query
+// parameters stripped, and the remaining query parameters sorted by name. One pass writes
+// straight into the caller's buffer; only the query sort needs scratch space, which is
+// reused per thread.
+class UrlCanonicalizer
+{
+public:
+    struct Options {
+        // Query parameters to drop, compared case-insensitively; a trailing '*' matches any
+        // suffix. The defaults are analytics tags, ad click IDs and session IDs
+        std::vector<std::string> stripParams = {
+            "utm_*", "gclid", "gclsrc", "dclid", "fbclid", "msclkid", "yclid", "mc_cid", "mc_eid", "_ga", "_gl",
+            "igshid", "jsessionid", "phpsessid", "sessionid", "session_id", "aspsessionid*"
+        };
+        // Order query parameters by name (stable, so repeated names keep their order)
+        bool sortQuery = true;
+        // "/a/" becomes "/a". Off by default: servers may answer the two differently, and
+        // relative links on the page resolve differently against each
+        bool stripTrailingSlash = false;
+    };
+
+    UrlCanonicalizer() : UrlCanonicalizer(Options{}) {}
+    explicit UrlCanonicalizer(const Options& options);
+
+    // Resolves reference against base (an absolute http(s) URL; may be empty when reference
+    // is absolute) and writes the canonical URL to out. Returns false, leaving out
+    // unspecified, for other schemes (mailto:, javascript:, ...) and malformed URLs. With
+    // rewritten set, also tells whether normalization changed the URL beyond resolving the
+    // reference and dropping its fragment
+    bool canonicalize(std::string_view reference, std::string_view base, std::string& out,
+                      bool* rewritten = nullptr) const;
+    [[nodiscard]] std::optional<std::string> canonicalize(std::string_view url) const;
+
+    // Shared instance with the default options
+    static const UrlCanonicalizer& standard();
+
+private:
+    struct StripRule {
+        std::string name;  // Lower-cased
+        bool prefix = false;
+    };
+
+    Options options_;
+    std::vector<StripRule> stripRules_;
+
+    [[nodiscard]] bool stripped(std::string_view name) const;
+    void appendQuery(std::string& out, std::string_view query) const;
+};
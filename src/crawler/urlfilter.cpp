@@ -0,0 +1,332 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#include "urlfilter.h"
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+
+namespace {
+    // Subset construction is exponential in the worst case; patterns that get near this
+    // are better written as several simpler ones
+    constexpr size_t MAX_DFA_STATES = 1 << 14;
+
+    unsigned char lower(unsigned char c) {
+        return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c + ('a' - 'A')) : c;
+    }
+
+    bool isHostEnd(unsigned char c) {
+        return c == ':' || c == '/' || c == '?' || c == '#';
+    }
+
+    bool isSpace(unsigned char c) {
+        return c == ' ' || (c >= '\t' && c <= '\r');
+    }
+
+    // FNV-1a over the lower-cased bytes, with the wildcard flag mixed in as a final byte
+    uint64_t hostHash(std::string_view host, bool wildcard) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (unsigned char c : host) {
+            hash = (hash ^ lower(c)) * 0x100000001b3ULL;
+        }
+        return (hash ^ (wildcard ? 1u : 0u)) * 0x100000001b3ULL;
+    }
+
+    bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (lower(static_cast<unsigned char>(a[i])) != lower(static_cast<unsigned char>(b[i]))) return false;
+        }
+        return true;
+    }
+}
+
+UrlFilter::UrlFilter(const Rules& rules) : restrictHosts_(rules.restrictHosts) {
+    for (const auto& host : rules.allowedHosts) {
+        allowHost(host);
+    }
+
+    extensionTrie_.emplace_back();
+    for (const auto& extension : rules.skipExtensions) {
+        addExtension(extension);
+    }
+
+    compilePatterns(rules.includePatterns, rules.excludePatterns);
+}
+
+const char* UrlFilter::verdictName(Verdict verdict) {
+    switch (verdict) {
+        case Verdict::Accept: return "accept";
+        case Verdict::Invalid: return "invalid";
+        case Verdict::OffSite: return "off_site";
+        case Verdict::SkippedExtension: return "skipped_extension";
+        case Verdict::Excluded: return "excluded";
+        case Verdict::NotIncluded: return "not_included";
+    }
+    return "unknown";
+}
+
+UrlFilter::Verdict UrlFilter::check(std::string_view url) const {
+    // Accepts what UrlParser's regex does: http(s)://host[:port][/path][?query][#fragment]
+    size_t pos;
+    if (url.starts_with("http://")) {
+        pos = 7;
+    } else if (url.starts_with("https://")) {
+        pos = 8;
+    } else {
+        return Verdict::Invalid;
+    }
+
+    // One hand-rolled pass that also rejects whitespace; find_first_of would make a
+    // memchr call per character here
+    const size_t hostStart = pos;
+    for (; pos < url.size() && !isHostEnd(static_cast<unsigned char>(url[pos])); ++pos) {
+        if (isSpace(static_cast<unsigned char>(url[pos]))) return Verdict::Invalid;
+    }
+    const std::string_view host = url.substr(hostStart, pos - hostStart);
+    if (host.empty()) return Verdict::Invalid;
+
+    if (pos < url.size() && url[pos] == ':') {
+        const size_t digitsStart = ++pos;
+        while (pos < url.size() && url[pos] >= '0' && url[pos] <= '9') ++pos;
+        if (pos == digitsStart) return Verdict::Invalid;
+    }
+
+    const size_t pathStart = pos;
+    for (; pos < url.size() && url[pos] != '?' && url[pos] != '#'; ++pos) {
+        if (isSpace(static_cast<unsigned char>(url[pos]))) return Verdict::Invalid;
+    }
+    const std::string_view path = url.substr(pathStart, pos - pathStart);
+    if (!path.empty() && path.front() != '/') return Verdict::Invalid;
+
+    for (; pos < url.size(); ++pos) {
+        if (isSpace(static_cast<unsigned char>(url[pos]))) return Verdict::Invalid;
+    }
+
+    if (restrictHosts_ && !hostAllowed(host)) return Verdict::OffSite;
+    if (hasSkippedExtension(path)) return Verdict::SkippedExtension;
+
+    if (hasPatterns_) {
+        // Locals, since byteClass_ is a char type the compiler must assume aliases the members
+        const uint32_t* transitions = transitions_.data();
+        const uint8_t* byteClass = byteClass_.data();
+        uint32_t row = START_STATE * classCount_;
+        for (unsigned char c : url) {
+            row = transitions[row + byteClass[c]];
+            if (row == DEAD_STATE) break;
+        }
+        const uint8_t flags = acceptFlags_[row / classCount_];
+        if (flags & ACCEPT_EXCLUDE) return Verdict::Excluded;
+        if (hasIncludes_ && !(flags & ACCEPT_INCLUDE)) return Verdict::NotIncluded;
+    }
+
+    return Verdict::Accept;
+}
+
+void UrlFilter::allowHost(std::string_view host) {
+    if (host.rfind("*.", 0) == 0) {
+        addHost(host.substr(2), true);
+    } else {
+        addHost(host, false);
+    }
+}
+
+void UrlFilter::addHost(std::string_view host, bool wildcard) {
+    if (host.empty() || findHost(host, wildcard)) return;
+    if ((hostCount_ + 1) * 2 > hostSlots_.size()) {
+        growHostTable();
+    }
+
+    HostSlot slot;
+    slot.hash = hostHash(host, wildcard);
+    slot.offset = static_cast<uint32_t>(hostBytes_.size());
+    slot.length = static_cast<uint32_t>(host.size());
+    slot.wildcard = wildcard;
+    for (unsigned char c : host) {
+        hostBytes_ += static_cast<char>(lower(c));
+    }
+
+    const size_t mask = hostSlots_.size() - 1;
+    size_t i = slot.hash & mask;
+    while (hostSlots_[i].length != 0) i = (i + 1) & mask;
+    hostSlots_[i] = slot;
+    ++hostCount_;
+}
+
+void UrlFilter::growHostTable() {
+    std::vector<HostSlot> old = std::move(hostSlots_);
+    hostSlots_.assign(std::max<size_t>(16, old.size() * 2), HostSlot{});
+    const size_t mask = hostSlots_.size() - 1;
+    for (const auto& slot : old) {
+        if (slot.length == 0) continue;
+        size_t i = slot.hash & mask;
+        while (hostSlots_[i].length != 0) i = (i + 1) & mask;
+        hostSlots_[i] = slot;
+    }
+}
+
+bool UrlFilter::findHost(std::string_view host, bool wildcard) const {
+    if (hostSlots_.empty()) return false;
+    const uint64_t hash = hostHash(host, wildcard);
+    const size_t mask = hostSlots_.size() - 1;
+    for (size_t i = hash & mask; hostSlots_[i].length != 0; i = (i + 1) & mask) {
+        const HostSlot& slot = hostSlots_[i];
+        if (slot.hash == hash && slot.wildcard == wildcard &&
+            equalsIgnoreCase(std::string_view(hostBytes_).substr(slot.offset, slot.length), host)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool UrlFilter::hostAllowed(std::string_view host) const {
+    if (findHost(host, false)) return true;
+    // "a.b.example.com" is covered by "*.b.example.com" and "*.example.com"
+    for (size_t dot = host.find('.'); dot != std::string_view::npos; dot = host.find('.', dot + 1)) {
+        if (findHost(host.substr(dot + 1), true)) return true;
+    }
+    return false;
+}
+
+void UrlFilter::addExtension(std::string_view extension) {
+    uint32_t node = 0;
+    for (auto it = extension.rbegin(); it != extension.rend(); ++it) {
+        const unsigned char c = lower(static_cast<unsigned char>(*it));
+        auto& children = extensionTrie_[node].children;
+        auto child = std::find_if(children.begin(), children.end(), [c](const auto& edge) { return edge.first == c; });
+        if (child != children.end()) {
+            node = child->second;
+        } else {
+            const auto next = static_cast<uint32_t>(extensionTrie_.size());
+            children.emplace_back(c, next);
+            extensionTrie_.emplace_back();  // May reallocate; children is not used after this
+            node = next;
+        }
+    }
+    if (!extension.empty()) {
+        extensionTrie_[node].terminal = true;
+    }
+}
+
+bool UrlFilter::hasSkippedExtension(std::string_view path) const {
+    if (extensionTrie_.empty()) return false;
+    uint32_t node = 0;
+    for (auto it = path.rbegin(); it != path.rend(); ++it) {
+        const unsigned char c = lower(static_cast<unsigned char>(*it));
+        const auto& children = extensionTrie_[node].children;
+        auto child = std::find_if(children.begin(), children.end(), [c](const auto& edge) { return edge.first == c; });
+        if (child == children.end()) return false;
+        node = child->second;
+        if (extensionTrie_[node].terminal) return true;
+    }
+    return false;
+}
+
+void UrlFilter::compilePatterns(const std::vector<std::string>& includes, const std::vector<std::string>& excludes) {
+    hasIncludes_ = !includes.empty();
+    hasPatterns_ = hasIncludes_ || !excludes.empty();
+    transitions_.clear();
+    acceptFlags_.clear();
+    if (!hasPatterns_) return;
+
+    // Glob NFA: position p of a pattern means its first p characters have been matched.
+    // Positions of all patterns share one numbering so a DFA state is a set of them.
+    struct Pattern {
+        std::string_view text;
+        uint32_t base;
+        uint8_t flag;
+    };
+    std::vector<Pattern> patterns;
+    uint32_t positions = 0;
+    for (const auto& text : includes) {
+        patterns.push_back({text, positions, ACCEPT_INCLUDE});
+        positions += static_cast<uint32_t>(text.size()) + 1;
+    }
+    for (const auto& text : excludes) {
+        patterns.push_back({text, positions, ACCEPT_EXCLUDE});
+        positions += static_cast<uint32_t>(text.size()) + 1;
+    }
+    std::vector<uint32_t> owner(positions);
+    for (uint32_t p = 0; p < patterns.size(); ++p) {
+        std::fill(owner.begin() + patterns[p].base, owner.begin() + patterns[p].base + patterns[p].text.size() + 1, p);
+    }
+
+    // A '*' may match nothing, so reaching it also reaches the position after it
+    auto addClosed = [&](std::vector<uint32_t>& set, uint32_t position) {
+        const Pattern& pattern = patterns[owner[position]];
+        while (true) {
+            set.push_back(position);
+            const size_t offset = position - pattern.base;
+            if (offset >= pattern.text.size() || pattern.text[offset] != '*') break;
+            ++position;
+        }
+    };
+    auto canonical = [](std::vector<uint32_t>& set) {
+        std::sort(set.begin(), set.end());
+        set.erase(std::unique(set.begin(), set.end()), set.end());
+    };
+
+    std::vector<std::vector<uint32_t>> states(2);  // Dead state, then the start state
+    for (const auto& pattern : patterns) {
+        addClosed(states[START_STATE], pattern.base);
+    }
+    canonical(states[START_STATE]);
+    std::map<std::vector<uint32_t>, uint32_t> index{{states[DEAD_STATE], DEAD_STATE}, {states[START_STATE], START_STATE}};
+
+    // Bytes no pattern names literally all behave alike, so they share one column; the
+    // table stays a few dozen entries wide and its rows stay in cache
+    // (a NUL in a pattern would be confused with them, which no URL pattern needs).
+    byteClass_.fill(0);
+    std::vector<unsigned char> representative = {0};
+    for (const auto& pattern : patterns) {
+        for (char symbol : pattern.text) {
+            const auto c = static_cast<unsigned char>(symbol);
+            if (symbol == '*' || symbol == '?' || c == 0 || byteClass_[c] != 0) continue;
+            byteClass_[c] = static_cast<uint8_t>(representative.size());
+            representative.push_back(c);
+        }
+    }
+    classCount_ = static_cast<uint32_t>(representative.size());
+
+    transitions_.assign(2 * classCount_, DEAD_STATE);
+    std::vector<uint32_t> next;
+    for (uint32_t state = START_STATE; state < states.size(); ++state) {
+        for (uint32_t byteClass = 0; byteClass < classCount_; ++byteClass) {
+            const unsigned char c = representative[byteClass];
+            next.clear();
+            for (uint32_t position : states[state]) {
+                const Pattern& pattern = patterns[owner[position]];
+                const size_t offset = position - pattern.base;
+                if (offset >= pattern.text.size()) continue;
+                const char symbol = pattern.text[offset];
+                if (symbol == '*') {
+                    addClosed(next, position);
+                } else if (symbol == '?' || static_cast<unsigned char>(symbol) == c) {
+                    addClosed(next, position + 1);
+                }
+            }
+            canonical(next);
+
+            auto [it, inserted] = index.emplace(next, static_cast<uint32_t>(states.size()));
+            if (inserted) {
+                if (states.size() >= MAX_DFA_STATES) {
+                    throw std::invalid_argument("URL include/exclude patterns are too complex to compile");
+                }
+                states.push_back(next);
+                transitions_.resize(states.size() * classCount_, DEAD_STATE);
+            }
+            transitions_[static_cast<size_t>(state) * classCount_ + byteClass] = it->second * classCount_;
+        }
+    }
+
+    acceptFlags_.assign(states.size(), 0);
+    for (uint32_t state = 0; state < states.size(); ++state) {
+        for (uint32_t position : states[state]) {
+            const Pattern& pattern = patterns[owner[position]];
+            if (position - pattern.base == pattern.text.size()) {
+                acceptFlags_[state] |= pattern.flag;
+            }
+        }
+    }
+}
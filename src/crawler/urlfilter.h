@@ -0,0 +1,89 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// URL admission rules compiled once into matchers that evaluate a URL in place, without
+// allocating: a hashed host table (with "*.example.com" wildcards), a trie of reversed
+// extensions matched backwards from the end of the path, and all include/exclude globs
+// merged into a single DFA that makes one pass over the URL.
+class UrlFilter
+{
+public:
+    enum class Verdict { Accept, Invalid, OffSite, SkippedExtension, Excluded, NotIncluded };
+
+    struct Rules {
+        // Path suffixes to skip, compared case-insensitively (".jpg" also skips ".JPG")
+        std::vector<std::string> skipExtensions;
+        // When set, only hosts in allowedHosts pass; "*.example.com" admits every subdomain
+        // of example.com (but not example.com itself)
+        bool restrictHosts = false;
+        std::vector<std::string> allowedHosts;
+        // Globs over the whole URL: '*' matches any run of characters, '?' any one character.
+        // A URL must match some include pattern (if there are any) and no exclude pattern.
+        std::vector<std::string> includePatterns;
+        std::vector<std::string> excludePatterns;
+    };
+
+    UrlFilter() = default;
+    // Throws std::invalid_argument if the patterns need an unreasonably large DFA
+    explicit UrlFilter(const Rules& rules);
+
+    void allowHost(std::string_view host);
+
+    [[nodiscard]] Verdict check(std::string_view url) const;
+    [[nodiscard]] bool admits(std::string_view url) const { return check(url) == Verdict::Accept; }
+
+    static const char* verdictName(Verdict verdict);
+
+private:
+    struct HostSlot {
+        uint64_t hash = 0;
+        uint32_t offset = 0;
+        uint32_t length = 0;  // Zero marks an empty slot
+        bool wildcard = false;
+    };
+
+    struct TrieNode {
+        std::vector<std::pair<unsigned char, uint32_t>> children;
+        bool terminal = false;
+    };
+
+    static constexpr uint8_t ACCEPT_INCLUDE = 1;
+    static constexpr uint8_t ACCEPT_EXCLUDE = 2;
+    static constexpr uint32_t DEAD_STATE = 0;
+    static constexpr uint32_t START_STATE = 1;
+
+    bool restrictHosts_ = false;
+    std::string hostBytes_;
+    std::vector<HostSlot> hostSlots_;  // Open addressing, power-of-two size
+    size_t hostCount_ = 0;
+
+    std::vector<TrieNode> extensionTrie_;  // Node 0 is the root
+
+    bool hasIncludes_ = false;
+    bool hasPatterns_ = false;
+    std::array<uint8_t, 256> byteClass_{};  // Byte -> DFA input column
+    uint32_t classCount_ = 1;
+    // Indexed by row + class, where a state's row is state * classCount_; entries hold the
+    // next state's row so the matching loop needs no multiply
+    std::vector<uint32_t> transitions_;
+    std::vector<uint8_t> acceptFlags_;      // Per state
+
+    void addHost(std::string_view host, bool wildcard);
+    void growHostTable();
+    [[nodiscard]] bool findHost(std::string_view host, bool wildcard) const;
+    [[nodiscard]] bool hostAllowed(std::string_view host) const;
+
+    void addExtension(std::string_view extension);
+    [[nodiscard]] bool hasSkippedExtension(std::string_view path) const;
+
+    void compilePatterns(const std::vector<std::string>& includes, const std::vector<std::string>& excludes);
+};
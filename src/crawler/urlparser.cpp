@@ -2,9 +2,9 @@
 // Created by docto on 8/11/2025.
 //
 #include "urlparser.h"
+#include "urlcanonicalizer.h"
 #include <iostream>
 #include <algorithm>
-#include <sstream>
 
 // Static regex definition
 const std::regex UrlParser::URL_REGEX{R"(^(https?):\/\/([^\/\s:]+)(?::(\d+))?(\/[^\s\?#]*)?(?:\?([^\s#]*))?(?:#([^\s]*))?$)"};
@@ -32,6 +32,9 @@ std::string UrlParser::ParsedUrl::toString() const {
         url += ":" + std::to_string(port);
     }
     url += path;
+    if (!query.empty()) {
+        url += "?" + query;
+    }
     return url;
 }
 
@@ -41,14 +44,8 @@ int UrlParser::getDefaultPort(const std::string& scheme) {
 
 std::string UrlParser::normalize(const std::string& url)
 {
-    auto parsed = parse(url);
-    if (!parsed.valid) return url;
-
-    parsed.scheme = toLowerCase(parsed.scheme);
-    parsed.host = toLowerCase(parsed.host);
-
-    parsed.path = normalizePath(parsed.path);
-    return parsed.toString();
+    auto canonical = UrlCanonicalizer::standard().canonicalize(url);
+    return canonical ? std::move(*canonical) : url;
 }
 
 
@@ -57,6 +54,20 @@ std::string UrlParser::extractDomain(const std::string& url) {
     return parsed.valid ? parsed.host : "";
 }
 
+std::string_view UrlParser::hostOf(std::string_view url) {
+    size_t start;
+    if (url.starts_with("http://")) {
+        start = 7;
+    } else if (url.starts_with("https://")) {
+        start = 8;
+    } else {
+        return {};
+    }
+    size_t end = start;
+    while (end < url.size() && url[end] != ':' && url[end] != '/' && url[end] != '?' && url[end] != '#') ++end;
+    return url.substr(start, end - start);
+}
+
 bool UrlParser::isSameDomain(const std::string& url1, const std::string& url2) {
     return extractDomain(url1) == extractDomain(url2);
 }
@@ -72,27 +83,9 @@ bool UrlParser::isValidUrl(const std::string& url) {
 }
 
 std::string UrlParser::makeAbsolute(const std::string& base, const std::string& relative) {
-    if (relative.rfind("http://", 0) == 0 || relative.rfind("https://", 0) == 0) {
-        return relative; // Already absolute
-    }
-
-    auto baseParsed = parse(base);
-    if (!baseParsed.valid) return relative;
-
-    if (!relative.empty() && relative[0] == '/') {
-        return baseParsed.scheme + "://" + baseParsed.host + relative;
-    }
-
-    // Handle relative paths (simple implementation)
-    std::string basePath = baseParsed.path;
-    if (basePath.back() != '/') {
-        size_t lastSlash = basePath.find_last_of('/');
-        if (lastSlash != std::string::npos) {
-            basePath = basePath.substr(0, lastSlash + 1);
-        }
-    }
-
-    return baseParsed.scheme + "://" + baseParsed.host + basePath + relative;
+    std::string absolute;
+    if (!UrlCanonicalizer::standard().canonicalize(relative, base, absolute)) return relative;
+    return absolute;
 }
 
 // Helper methods
@@ -102,53 +95,6 @@ std::string UrlParser::toLowerCase(const std::string& str) {
     return result;
 }
 
-std::string UrlParser::normalizePath(const std::string& path) {
-    if (path.empty()) return "/";
-
-    auto segments = splitPath(path);
-    std::vector<std::string> normalized;
-
-    for (const auto& segment : segments) {
-        if (segment == "." || segment.empty()) {
-            continue; // Skip current directory references
-        } else if (segment == "..") {
-            if (!normalized.empty()) {
-                normalized.pop_back(); // Go up one directory
-            }
-        } else {
-            normalized.push_back(segment);
-        }
-    }
-
-    return joinPath(normalized);
-}
-
-std::vector<std::string> UrlParser::splitPath(const std::string& path) {
-    std::vector<std::string> segments;
-    std::stringstream ss(path);
-    std::string segment;
-
-    while (std::getline(ss, segment, '/')) {
-        if (!segment.empty()) {
-            segments.push_back(segment);
-        }
-    }
-
-    return segments;
-}
-
-std::string UrlParser::joinPath(const std::vector<std::string>& segments) {
-    if (segments.empty()) return "/";
-
-    std::string result = "/";
-    for (size_t i = 0; i < segments.size(); ++i) {
-        if (i > 0) result += "/";
-        result += segments[i];
-    }
-
-    return result;
-}
-
 bool UrlParser::isValidScheme(const std::string& scheme) {
     return scheme == "http" || scheme == "https";
 }
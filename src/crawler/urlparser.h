@@ -4,6 +4,7 @@
 
 #pragma once
 #include <string>
+#include <string_view>
 #include <regex>
 #include <optional>
 #include <vector>
@@ -25,21 +26,22 @@ public:
         [[nodiscard]] std::string toString() const;
     };
     [[nodiscard]] static ParsedUrl parse(const std::string& url);
+    // Canonical form of an absolute http(s) URL (see UrlCanonicalizer); other input unchanged
     [[nodiscard]] static std::string normalize(const std::string& url);
     [[nodiscard]] static bool isValidUrl(const std::string& url);
+    // Resolves and canonicalizes relative against base; relative unchanged if that fails
     [[nodiscard]] static std::string makeAbsolute(const std::string& base, const std::string& relative);
     [[nodiscard]] static std::string extractDomain(const std::string& url);
+    // Host of an http(s) URL as a view into it, without validating the rest; empty if none
+    [[nodiscard]] static std::string_view hostOf(std::string_view url);
     [[nodiscard]] static bool isSameDomain(const std::string& url1, const std::string& url2);
     [[nodiscard]] static std::string removeFragment(const std::string& url);
 
 private:
-    static std::string normalizePath(const std::string& path);
     static int getDefaultPort(const std::string& scheme);
     static bool isValidScheme(const std::string& scheme);
     static bool isValidHost(const std::string& host);
     static std::string toLowerCase(const std::string& str);
-    static std::vector<std::string> splitPath(const std::string& path);
-    static std::string joinPath(const std::vector<std::string>& segments);
 
     static const std::regex URL_REGEX;
 };
@@ -0,0 +1,376 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#include "urlstatestore.h"
+#include "../util/mappedfile.h"
+#include "../util/memorybudget.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+
+namespace {
+    // On-disk layout: header, the fixed-size records, URL offsets (u64 x n+1) and the URL
+    // bytes, each 8-byte aligned, in host byte order like the link graph file
+    constexpr char STATE_MAGIC[8] = {'W', 'C', 'S', 'T', 'A', 'T', 'E', '1'};
+    constexpr uint32_t STATE_VERSION = 1;
+
+    struct StateFileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t recordSize;
+        uint64_t count;
+        uint64_t recordsPos;
+        uint64_t urlOffsetsPos;
+        uint64_t urlDataPos;
+        uint64_t urlDataSize;
+    };
+
+    uint64_t alignUp(uint64_t value) {
+        return (value + 7) & ~uint64_t{7};
+    }
+
+    void writePadding(std::ofstream& file, uint64_t from, uint64_t to) {
+        static constexpr char zeros[8] = {};
+        file.write(zeros, static_cast<std::streamsize>(to - from));
+    }
+
+    int64_t toMillis(UrlStateStore::Clock::time_point time) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+    }
+
+    uint64_t load64(const char* p) {
+        uint64_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+}
+
+UrlStateStore::UrlStateStore(const Options& options) : options_(options) {}
+
+bool UrlStateStore::load(const std::string& filename) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    schedule_.clear();
+    keyBytes_ = 0;
+    if (!std::filesystem::exists(filename)) {
+        return false;
+    }
+
+    const MappedFile mapped(filename);
+    const char* base = mapped.data();
+    const size_t size = mapped.size();
+
+    StateFileHeader header{};
+    if (size < sizeof(header)) {
+        throw std::runtime_error("URL state file is truncated: " + filename);
+    }
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, STATE_MAGIC, sizeof(STATE_MAGIC)) != 0 || header.version != STATE_VERSION ||
+        header.recordSize != sizeof(State)) {
+        throw std::runtime_error("Not a URL state file: " + filename);
+    }
+    const uint64_t offsetsBytes = (header.count + 1) * sizeof(uint64_t);
+    if (header.recordsPos + header.count * sizeof(State) > size || header.urlOffsetsPos + offsetsBytes > size ||
+        header.urlDataPos + header.urlDataSize > size) {
+        throw std::runtime_error("URL state file is truncated: " + filename);
+    }
+
+    const char* offsets = base + header.urlOffsetsPos;
+    const char* urlData = base + header.urlDataPos;
+    entries_.reserve(header.count);
+    schedule_.reserve(header.count);
+    for (uint64_t i = 0; i < header.count; ++i) {
+        const uint64_t begin = load64(offsets + i * sizeof(uint64_t));
+        const uint64_t end = load64(offsets + (i + 1) * sizeof(uint64_t));
+        if (begin > end || end > header.urlDataSize) {
+            throw std::runtime_error("URL state file is corrupt: " + filename);
+        }
+        Entry entry;
+        std::memcpy(&entry.state, base + header.recordsPos + i * sizeof(State), sizeof(State));
+        // Reschedule under the current options, which may differ from the saving run's
+        State& state = entry.state;
+        if (state.lastFetch != 0 && state.failures == 0) {
+            state.nextDue = state.lastmod > state.lastFetch ? state.lastFetch
+                                                            : state.lastFetch + revisitInterval(state).count();
+        }
+        auto [it, inserted] = entries_.emplace(std::string(urlData + begin, end - begin), entry);
+        if (inserted) {
+            keyBytes_ += MemoryBudget::stringBytes(it->first.size());
+            schedule_.push_back({it->second.state.nextDue, &it->first});
+        }
+    }
+    std::make_heap(schedule_.begin(), schedule_.end(), std::greater<>());
+    return true;
+}
+
+void UrlStateStore::save(const std::string& filename) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const std::string temporary = filename + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            throw std::runtime_error("Failed to open URL state file for writing: " + temporary);
+        }
+
+        std::vector<uint64_t> urlOffsets;
+        urlOffsets.reserve(entries_.size() + 1);
+        urlOffsets.push_back(0);
+        for (const auto& [url, entry] : entries_) {
+            urlOffsets.push_back(urlOffsets.back() + url.size());
+        }
+
+        StateFileHeader header{};
+        std::memcpy(header.magic, STATE_MAGIC, sizeof(STATE_MAGIC));
+        header.version = STATE_VERSION;
+        header.recordSize = sizeof(State);
+        header.count = entries_.size();
+        header.recordsPos = alignUp(sizeof(StateFileHeader));
+        header.urlOffsetsPos = alignUp(header.recordsPos + header.count * sizeof(State));
+        header.urlDataPos = alignUp(header.urlOffsetsPos + urlOffsets.size() * sizeof(uint64_t));
+        header.urlDataSize = urlOffsets.back();
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        writePadding(file, sizeof(header), header.recordsPos);
+        for (const auto& [url, entry] : entries_) {
+            file.write(reinterpret_cast<const char*>(&entry.state), sizeof(State));
+        }
+        writePadding(file, header.recordsPos + header.count * sizeof(State), header.urlOffsetsPos);
+        file.write(reinterpret_cast<const char*>(urlOffsets.data()),
+                   static_cast<std::streamsize>(urlOffsets.size() * sizeof(uint64_t)));
+        writePadding(file, header.urlOffsetsPos + urlOffsets.size() * sizeof(uint64_t), header.urlDataPos);
+        for (const auto& [url, entry] : entries_) {
+            file.write(url.data(), static_cast<std::streamsize>(url.size()));
+        }
+        if (!file) {
+            throw std::runtime_error("Failed to write URL state file: " + temporary);
+        }
+    }
+#ifdef _WIN32
+    std::remove(filename.c_str());  // rename() does not replace on Windows
+#endif
+    if (std::rename(temporary.c_str(), filename.c_str()) != 0) {
+        throw std::runtime_error("Failed to replace URL state file: " + filename);
+    }
+}
+
+bool UrlStateStore::discover(std::string_view url, Clock::time_point now, int64_t lastmodSeconds) {
+    const int64_t nowMs = toMillis(now);
+    const int64_t lastmodMs = lastmodSeconds * 1000;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(url);
+    if (it == entries_.end()) {
+        if (entries_.size() >= options_.maxUrls) return false;
+        it = entries_.emplace(std::string(url), Entry{}).first;
+        keyBytes_ += MemoryBudget::stringBytes(url.size());
+        it->second.state.firstSeen = nowMs;
+        it->second.state.lastmod = lastmodMs;
+        scheduleLocked(it->first, it->second, nowMs);
+        return true;
+    }
+
+    State& state = it->second.state;
+    if (lastmodMs > state.lastmod) {
+        state.lastmod = lastmodMs;
+        // The site says the page changed after we last saw it
+        if (lastmodMs > state.lastFetch && !it->second.inFlight && state.nextDue > nowMs) {
+            scheduleLocked(it->first, it->second, nowMs);
+        }
+    }
+    return false;
+}
+
+std::vector<std::string> UrlStateStore::takeDue(Clock::time_point now, size_t max) {
+    const int64_t nowMs = toMillis(now);
+    std::vector<std::string> due;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (!schedule_.empty() && due.size() < max && schedule_.front().due <= nowMs) {
+        std::pop_heap(schedule_.begin(), schedule_.end(), std::greater<>());
+        const Scheduled item = schedule_.back();
+        schedule_.pop_back();
+
+        Entry& entry = entries_.find(*item.url)->second;
+        if (entry.inFlight || entry.state.nextDue != item.due) continue;  // Superseded
+        entry.inFlight = true;
+        due.push_back(*item.url);
+    }
+    return due;
+}
+
+std::optional<UrlStateStore::Clock::time_point> UrlStateStore::nextDue() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (!schedule_.empty()) {
+        const Scheduled& top = schedule_.front();
+        const Entry& entry = entries_.find(*top.url)->second;
+        if (!entry.inFlight && entry.state.nextDue == top.due) {
+            return Clock::time_point(std::chrono::milliseconds(top.due));
+        }
+        std::pop_heap(schedule_.begin(), schedule_.end(), std::greater<>());
+        schedule_.pop_back();
+    }
+    return std::nullopt;
+}
+
+UrlStateStore::Outcome UrlStateStore::recordFetch(const std::string& url, Clock::time_point now, int statusCode,
+                                                  std::optional<uint64_t> contentHash) {
+    const int64_t nowMs = toMillis(now);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(url);
+    if (it == entries_.end()) {
+        if (entries_.size() >= options_.maxUrls) return contentHash ? Outcome::First : Outcome::Failed;
+        it = entries_.emplace(url, Entry{}).first;
+        keyBytes_ += MemoryBudget::stringBytes(url.size());
+        it->second.state.firstSeen = nowMs;
+    }
+    Entry& entry = it->second;
+    State& state = entry.state;
+    entry.inFlight = false;
+    state.lastStatus = statusCode;
+
+    if (!contentHash) {
+        // Back off exponentially from the minimum interval; the history is left alone
+        state.failures = std::min<uint32_t>(state.failures + 1, 20);
+        const auto backoff = std::min<int64_t>(
+            static_cast<int64_t>(options_.minInterval.count()) << std::min<uint32_t>(state.failures - 1, 16),
+            options_.maxInterval.count());
+        scheduleLocked(it->first, entry, nowMs + backoff * 1000);
+        failed_.fetch_add(1, std::memory_order_relaxed);
+        return Outcome::Failed;
+    }
+    state.failures = 0;
+
+    Outcome outcome = Outcome::First;
+    if (state.lastFetch == 0) {
+        state.lastChange = nowMs;
+        first_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        const bool changed = *contentHash != state.contentHash;
+        if (nowMs > state.lastFetch) {
+            state.observedSeconds += static_cast<double>(nowMs - state.lastFetch) / 1000.0;
+            ++state.intervals;
+            if (changed) ++state.changes;
+            if (state.intervals > options_.historyLimit) {
+                state.intervals = (state.intervals + 1) / 2;
+                state.changes /= 2;
+                state.observedSeconds /= 2;
+            }
+        }
+        if (changed) {
+            state.lastChange = nowMs;
+            outcome = Outcome::Changed;
+            changed_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            outcome = Outcome::Unchanged;
+            unchanged_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    state.contentHash = *contentHash;
+    state.lastFetch = nowMs;
+    scheduleLocked(it->first, entry, nowMs + revisitInterval(state).count());
+    return outcome;
+}
+
+std::optional<UrlStateStore::State> UrlStateStore::find(std::string_view url) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(url);
+    if (it == entries_.end()) return std::nullopt;
+    return it->second.state;
+}
+
+size_t UrlStateStore::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+size_t UrlStateStore::memoryUsage() const {
+    // Each map node holds the key, the entry, a next pointer and the cached hash
+    constexpr size_t NODE_BYTES = sizeof(Entry) + sizeof(void*) + sizeof(size_t);
+    std::lock_guard<std::mutex> lock(mutex_);
+    return keyBytes_ + entries_.size() * NODE_BYTES + entries_.bucket_count() * sizeof(void*) +
+           schedule_.capacity() * sizeof(Scheduled);
+}
+
+UrlStateStore::Stats UrlStateStore::stats(Clock::time_point now) const {
+    const int64_t nowMs = toMillis(now);
+    Stats stats;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats.urls = entries_.size();
+        for (const auto& [url, entry] : entries_) {
+            if (!entry.inFlight && entry.state.nextDue <= nowMs) ++stats.due;
+        }
+    }
+    stats.first = first_.load(std::memory_order_relaxed);
+    stats.changed = changed_.load(std::memory_order_relaxed);
+    stats.unchanged = unchanged_.load(std::memory_order_relaxed);
+    stats.failed = failed_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+// Cho and Garcia-Molina's bias-reduced estimator for a Poisson change process observed
+// only at fetch times: with X changes seen in n intervals averaging I seconds, the rate is
+// -ln((n - X + 0.5) / (n + 0.5)) / I. It is zero when nothing has changed yet, so then the
+// rate is taken as the one under which n intervals show no change half the time,
+// ln 2 / (n I): revisits of a static page back off in proportion to how long it has been
+// watched, within the minInterval/maxInterval clamp.
+double UrlStateStore::changeRate(const State& state) const {
+    if (state.intervals == 0 || state.observedSeconds <= 0) return 0.0;
+    const double n = state.intervals;
+    const double changes = std::min<double>(state.changes, n);
+    if (changes == 0) return std::log(2.0) / state.observedSeconds;
+    const double meanInterval = state.observedSeconds / n;
+    return -std::log((n - changes + 0.5) / (n + 0.5)) / meanInterval;
+}
+
+// The time until a change has happened with staleProbability, i.e. P = 1 - exp(-rate * t)
+std::chrono::milliseconds UrlStateStore::revisitInterval(const State& state) const {
+    const double minSeconds = static_cast<double>(options_.minInterval.count());
+    const double maxSeconds = static_cast<double>(options_.maxInterval.count());
+    const double rate = changeRate(state);
+    double seconds = minSeconds;  // Second fetch: nothing is known yet
+    if (rate > 0) {
+        seconds = std::clamp(-std::log(1.0 - options_.staleProbability) / rate, minSeconds, maxSeconds);
+    }
+    return std::chrono::milliseconds(static_cast<int64_t>(seconds * 1000.0));
+}
+
+void UrlStateStore::scheduleLocked(const std::string& url, Entry& entry, int64_t due) {
+    entry.state.nextDue = due;
+    schedule_.push_back({due, &url});
+    std::push_heap(schedule_.begin(), schedule_.end(), std::greater<>());
+
+    // Drop superseded elements once they outnumber the live ones
+    if (schedule_.size() > 2 * entries_.size() + 1024) {
+        schedule_.clear();
+        for (const auto& [key, other] : entries_) {
+            if (!other.inFlight) schedule_.push_back({other.state.nextDue, &key});
+        }
+        std::make_heap(schedule_.begin(), schedule_.end(), std::greater<>());
+    }
+}
+
+// 64-bit multiply-xorshift over 8-byte words; only has to tell versions of a page apart
+uint64_t UrlStateStore::hashContent(std::string_view content) {
+    constexpr uint64_t MULTIPLIER = 0x9e3779b97f4a7c15ULL;
+    uint64_t hash = 0xcbf29ce484222325ULL ^ (content.size() * MULTIPLIER);
+    size_t i = 0;
+    for (; i + 8 <= content.size(); i += 8) {
+        hash = (hash ^ load64(content.data() + i)) * MULTIPLIER;
+        hash ^= hash >> 29;
+    }
+    uint64_t tail = 0;
+    if (i < content.size()) {
+        std::memcpy(&tail, content.data() + i, content.size() - i);
+    }
+    hash = (hash ^ tail) * MULTIPLIER;
+    hash ^= hash >> 32;
+    return hash;
+}
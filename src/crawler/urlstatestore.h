@@ -0,0 +1,125 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Per-URL fetch history that outlives a crawl: when each URL was fetched, a hash of what
+// it returned, and how often that hash changed between fetches. From the history it
+// estimates each page's change rate and schedules the next visit for when the page has
+// probably changed, so volatile pages are revisited often and static ones rarely.
+// Thread-safe; all members lock internally.
+class UrlStateStore
+{
+public:
+    using Clock = std::chrono::system_clock;
+
+    struct Options {
+        std::chrono::seconds minInterval{300};                 // Revisit no page more often
+        std::chrono::seconds maxInterval{30 * 24 * 3600};      // Nor any less often
+        // Revisit once the estimated probability of a change since the last fetch reaches this
+        double staleProbability = 0.5;
+        // Older observations are halved away past this many fetches, so the estimate follows
+        // pages whose behaviour changes
+        uint32_t historyLimit = 64;
+        size_t maxUrls = SIZE_MAX;  // discover() ignores new URLs beyond this
+    };
+
+    struct State {
+        int64_t firstSeen = 0;   // All times in milliseconds since the Unix epoch; 0 = never
+        int64_t lastFetch = 0;
+        int64_t lastChange = 0;
+        int64_t nextDue = 0;
+        int64_t lastmod = 0;     // Latest sitemap lastmod seen for the URL
+        uint64_t contentHash = 0;
+        double observedSeconds = 0;  // Time spanned by the fetch intervals counted below
+        uint32_t intervals = 0;      // Fetch intervals observed (decayed past historyLimit)
+        uint32_t changes = 0;        // Intervals in which the content changed
+        int32_t lastStatus = 0;
+        uint32_t failures = 0;       // Consecutive failed fetches
+    };
+
+    enum class Outcome { First, Changed, Unchanged, Failed };
+
+    struct Stats {
+        size_t urls = 0;
+        size_t due = 0;
+        uint64_t first = 0;
+        uint64_t changed = 0;
+        uint64_t unchanged = 0;
+        uint64_t failed = 0;
+    };
+
+    explicit UrlStateStore(const Options& options);
+
+    // Replaces the contents with the file's; returns false, leaving the store empty, if
+    // the file does not exist. Throws on a corrupt file.
+    bool load(const std::string& filename);
+    // Writes through a temporary file and a rename, so a crash never leaves a torn store
+    void save(const std::string& filename) const;
+
+    // New URLs are due at once. A known URL becomes due at once when a sitemap reports a
+    // lastmod newer than its last fetch. Returns true if the URL was new.
+    bool discover(std::string_view url, Clock::time_point now, int64_t lastmodSeconds = 0);
+    // Up to max URLs whose visit is due, earliest first. They are handed out once, until
+    // recordFetch() reschedules them.
+    [[nodiscard]] std::vector<std::string> takeDue(Clock::time_point now, size_t max);
+    [[nodiscard]] std::optional<Clock::time_point> nextDue();
+
+    // Records a fetch of url; contentHash is empty for a failed fetch or a non-200 answer
+    Outcome recordFetch(const std::string& url, Clock::time_point now, int statusCode,
+                        std::optional<uint64_t> contentHash);
+
+    [[nodiscard]] std::optional<State> find(std::string_view url) const;
+    [[nodiscard]] size_t size() const;
+    // Estimated heap bytes held, for the crawler's memory budget
+    [[nodiscard]] size_t memoryUsage() const;
+    [[nodiscard]] Stats stats(Clock::time_point now) const;
+
+    // Estimated changes per second from the state's history; zero until a page has been
+    // fetched twice. Never zero after that, even if no change has been seen
+    [[nodiscard]] double changeRate(const State& state) const;
+    [[nodiscard]] std::chrono::milliseconds revisitInterval(const State& state) const;
+
+    static uint64_t hashContent(std::string_view content);
+
+private:
+    struct Entry {
+        State state;
+        bool inFlight = false;  // Handed out by takeDue() and not yet recorded
+    };
+
+    struct StringHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+    };
+
+    struct Scheduled {
+        int64_t due;
+        const std::string* url;  // Key in entries_; node-based map keys never move
+        bool operator>(const Scheduled& other) const { return due > other.due; }
+    };
+
+    Options options_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Entry, StringHash, std::equal_to<>> entries_;
+    // Min-heap on due time. Rescheduling pushes a new element; stale ones are skipped on pop
+    std::vector<Scheduled> schedule_;
+    size_t keyBytes_ = 0;  // Heap bytes of the URL keys
+
+    std::atomic<uint64_t> first_{0};
+    std::atomic<uint64_t> changed_{0};
+    std::atomic<uint64_t> unchanged_{0};
+    std::atomic<uint64_t> failed_{0};
+
+    void scheduleLocked(const std::string& url, Entry& entry, int64_t due);
+};
@@ -3,157 +3,933 @@
 //
 
 #include "webcrawler.h"
+#include "robotparser.h"
+#include "sitemapparser.h"
+#include <algorithm>
+#include <deque>
+#include <iomanip>
 #include <iostream>
 #include <thread>
 
+namespace {
+    // Longest a continuous-mode wait goes without checking for stop()
+    constexpr std::chrono::milliseconds RECRAWL_POLL_INTERVAL{200};
+    // Memory pressure changes without notifying anyone, so throttled workers re-check it
+    constexpr std::chrono::milliseconds MEMORY_POLL_INTERVAL{50};
+    // URLs read back from the spill file at a time, depending on memory pressure
+    constexpr size_t SPILL_REFILL = 4096;
+    constexpr size_t SPILL_REFILL_PRESSURED = 64;
+
+    // A queued URL, and a visited-set node with its bucket pointer and cached hash
+    size_t frontierBytes(const std::string& url) {
+        return MemoryBudget::stringBytes(url.size());
+    }
+    size_t visitedBytes(const std::string& url) {
+        return MemoryBudget::stringBytes(url.size()) + 2 * sizeof(void*) + sizeof(size_t);
+    }
+
+    UrlFilter::Rules filterRules(const CrawlerConfig& config) {
+        UrlFilter::Rules rules;
+        rules.skipExtensions = config.skipExtensions;
+        rules.restrictHosts = config.sameDomainOnly || !config.allowedHosts.empty();
+        rules.allowedHosts = config.allowedHosts;
+        rules.includePatterns = config.includePatterns;
+        rules.excludePatterns = config.excludePatterns;
+        return rules;
+    }
+
+    UrlCanonicalizer::Options canonicalizerOptions(const CrawlerConfig& config) {
+        UrlCanonicalizer::Options options;
+        options.stripParams = config.stripQueryParams;
+        options.sortQuery = config.sortQueryParams;
+        options.stripTrailingSlash = config.stripTrailingSlash;
+        return options;
+    }
+}
+
 WebCrawler::WebCrawler(const CrawlerConfig& config)
-    : config_(config), httpClient_(config.httpConfig) {
+    : config_(config), httpClient_(config.httpConfig), memory_(config.memoryBudget, config.memoryHighWater),
+      urlFilter_(filterRules(config)), canonicalizer_(canonicalizerOptions(config)) {
+
+    for (auto& seedUrl : config_.seedUrls) {
+        if (auto canonical = canonicalizer_.canonicalize(seedUrl)) seedUrl = std::move(*canonical);
+    }
+
+    if (config.dnsPrefetch) {
+        DnsResolver::Options dnsOptions;
+        dnsOptions.concurrency = config.dnsConcurrency;
+        dnsOptions.negativeTtl = config.dnsNegativeTtl;
+        resolver_ = std::make_unique<DnsResolver>(
+            dnsOptions, config.dnsServers.empty() ? DnsResolver::systemLookup()
+                                                  : DnsResolver::udpLookup(config.dnsServers));
+    }
+
+    if (config.trapDetection) {
+        TrapDetector::Options trapOptions;
+        trapOptions.maxPerPattern = config.trapMaxPerPattern;
+        trapOptions.maxParamValues = config.trapMaxParamValues;
+        trapOptions.logFile = config.trapLogFile;
+        traps_ = std::make_unique<TrapDetector>(trapOptions);
+    }
+
+    if (!config.stateFile.empty() || config.continuous) {
+        UrlStateStore::Options stateOptions;
+        stateOptions.minInterval = config.recrawlMinInterval;
+        stateOptions.maxInterval = config.recrawlMaxInterval;
+        stateOptions.maxUrls = config.maxPages;
+        urlState_ = std::make_unique<UrlStateStore>(stateOptions);
+        if (!config.stateFile.empty() && urlState_->load(config.stateFile)) {
+            std::cout << "Loaded state for " << urlState_->size() << " URLs from " << config.stateFile << "\n";
+        }
+    }
 
     // Extract allowed domains from seed URLs
-    for (const auto& seedUrl : config.seedUrls) {
+    for (const auto& seedUrl : config_.seedUrls) {
         auto parsed = UrlParser::parse(seedUrl);
         if (parsed.valid) {
-            allowedDomains_.insert(parsed.host);
+            urlFilter_.allowHost(parsed.host);
         }
     }
 }
 
 void WebCrawler::addSeedUrl(const std::string& url) {
-    auto parsed = UrlParser::parse(url);
-    if (parsed.valid) {
-        urlQueue_.push(url);
-        allowedDomains_.insert(parsed.host);
+    const auto canonical = canonicalizer_.canonicalize(url);
+    auto parsed = UrlParser::parse(canonical.value_or(url));
+    if (canonical && parsed.valid) {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        enqueueLocked(*canonical);
+        urlFilter_.allowHost(parsed.host);
+    }
+}
+
+// Appends to the frontier, or to the spill file while memory is short. Once anything is
+// spilled, later URLs follow it to disk so the frontier keeps its first-in first-out order
+void WebCrawler::enqueueLocked(std::string url) {
+    if (!spillFailed_ && (!spill_.empty() || memory_.pressure() != MemoryBudget::Pressure::Normal)) {
+        try {
+            spill_.push(url);
+            return;
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: " << e.what() << "; keeping the frontier in memory\n";
+            spillFailed_ = true;
+        }
+    }
+    memory_.charge(MemoryBudget::Account::Frontier, frontierBytes(url));
+    urlQueue_.push(std::move(url));
+}
+
+bool WebCrawler::dequeueLocked(std::string& url) {
+    if (urlQueue_.empty()) {
+        refillLocked();
+        if (urlQueue_.empty()) return false;
+    }
+    memory_.release(MemoryBudget::Account::Frontier, frontierBytes(urlQueue_.front()));
+    url = std::move(urlQueue_.front());
+    urlQueue_.pop();
+    updateFrontierMetricsLocked();
+    return true;
+}
+
+// Reads spilled URLs back once the in-memory frontier has run dry; a smaller batch while
+// memory is still short, just enough to keep the throttled workers busy
+void WebCrawler::refillLocked() {
+    if (spill_.empty()) return;
+    std::vector<std::string> batch;
+    try {
+        spill_.pop(batch, memory_.pressure() == MemoryBudget::Pressure::Normal ? SPILL_REFILL
+                                                                               : SPILL_REFILL_PRESSURED);
+    } catch (const std::exception& e) {
+        std::cerr << "Warning: " << e.what() << "; dropping " << spill_.size() << " spilled URLs\n";
+        spill_.clear();
+        spillFailed_ = true;
+    }
+    for (auto& url : batch) {
+        memory_.charge(MemoryBudget::Account::Frontier, frontierBytes(url));
+        urlQueue_.push(std::move(url));
+    }
+}
+
+void WebCrawler::updateFrontierMetricsLocked() {
+    metrics_.setFrontierSize(urlQueue_.size() + spill_.size());
+    metrics_.setSpilledCount(spill_.size());
+}
+
+size_t WebCrawler::fetchSlots() const {
+    switch (memory_.pressure()) {
+        case MemoryBudget::Pressure::Normal: return std::max<size_t>(1, numThreads_);
+        case MemoryBudget::Pressure::High: return std::max<size_t>(1, numThreads_ / 2);
+        case MemoryBudget::Pressure::Critical: break;
     }
+    return 1;
+}
+
+void WebCrawler::printMemorySummary() const {
+    std::cout << "Memory: peak " << MemoryBudget::formatBytes(memory_.peak()) << " of "
+              << (memory_.limit() > 0 ? MemoryBudget::formatBytes(memory_.limit()) + " budget" : std::string("no budget"))
+              << " (" << memory_.summary() << " held at end), " << spill_.spilled() << " URLs spilled to disk, "
+              << throttledFetches_.load(std::memory_order_relaxed) << " fetches throttled\n";
 }
 
 void WebCrawler::setCrawlCallback(CrawlCallback callback) {
     crawlCallback_ = std::move(callback);
 }
 
+void WebCrawler::setBatchCallback(BatchCallback callback) {
+    batchCallback_ = std::move(callback);
+}
+
+void WebCrawler::setWorkerCallback(CrawlCallback callback) {
+    workerCallback_ = std::move(callback);
+}
+
+void WebCrawler::openResultSink(size_t workers) {
+    sink_ = std::make_unique<ResultSink>(workers, [this](std::vector<CrawlResult>& batch) {
+        CrawlTrace::Span span(trace_, consumerTraceThread_, "callback",
+                              !batch.empty() && trace_.sampled(batch.front().url));
+        // Measured before the callbacks, which may move the results out
+        size_t queuedBytes = 0;
+        for (const auto& result : batch) {
+            queuedBytes += result.memoryUsage();
+        }
+        if (crawlCallback_) {
+            for (const auto& result : batch) {
+                crawlCallback_(result);
+            }
+        }
+        if (batchCallback_) {
+            batchCallback_(batch);
+        }
+        memory_.release(MemoryBudget::Account::Results, queuedBytes);
+    }, resultQueueCapacity_);
+}
+
+void WebCrawler::startMetrics(size_t workers) {
+    metrics_.setWorkerCount(workers);
+    metrics_.setMemoryBudget(&memory_);
+    if (!config_.metricsFile.empty()) {
+        metrics_.startReporting(config_.metricsFile, config_.metricsInterval);
+    }
+}
+
+void WebCrawler::startTrace(size_t workers) {
+    if (config_.traceFile.empty()) return;
+
+    CrawlTrace::Options options;
+    options.sampleRate = config_.traceSampleRate;
+    trace_.enable(options, workers + 1);
+    for (size_t i = 0; i < workers; ++i) {
+        trace_.nameThread(i, "worker " + std::to_string(i));
+    }
+    consumerTraceThread_ = workers;
+    trace_.nameThread(consumerTraceThread_, "result consumer");
+}
+
+void WebCrawler::finishTrace() {
+    if (!trace_.enabled()) return;
+    trace_.write(config_.traceFile);
+    std::cout << "Trace (" << trace_.eventCount() << " spans, " << trace_.droppedCount()
+              << " dropped) written to: " << config_.traceFile << "\n";
+}
+
+// Splits curl's cumulative timers into consecutive phases on the worker's timeline
+void WebCrawler::traceFetch(size_t worker, CrawlTrace::Clock::time_point start, const HttpClient::Timing& timing) {
+    auto at = [start](std::chrono::microseconds offset) { return start + offset; };
+    const auto connected = std::max(timing.connect, timing.nameLookup);
+    const auto secured = std::max(timing.tlsHandshake, connected);
+    const auto firstByte = std::max(timing.firstByte, secured);
+    const auto done = std::max(timing.total, firstByte);
+
+    trace_.record(worker, "dns", at(std::chrono::microseconds(0)), at(timing.nameLookup));
+    trace_.record(worker, "connect", at(timing.nameLookup), at(connected));
+    if (timing.tlsHandshake.count() > 0) {
+        trace_.record(worker, "tls", at(connected), at(secured));
+    }
+    trace_.record(worker, "wait", at(secured), at(firstByte));
+    trace_.record(worker, "transfer", at(firstByte), at(done));
+}
+
+void WebCrawler::closeResultSink() {
+    if (sink_) {
+        sink_->close();
+        sink_.reset();
+    }
+}
+
 void WebCrawler::start() {
     running_ = true;
+    startMetrics(1);
+    startTrace(1);
+    openResultSink(1);
 
     // Add seed URLs to queue
     for (const auto& seedUrl : config_.seedUrls) {
         if (visitedUrls_.find(seedUrl) == visitedUrls_.end()) {
-            urlQueue_.push(seedUrl);
+            enqueueLocked(seedUrl);
+            if (resolver_) resolver_->prefetch(UrlParser::hostOf(seedUrl));
         }
     }
 
-    std::cout << "Starting crawl with " << urlQueue_.size() << " seed URLs\n";
+    seedFromSitemaps({&httpClient_});
+
+    std::cout << "Starting crawl with " << getQueueSize() << " seed URLs\n";
 
-    while (running_ && !urlQueue_.empty() && visitedUrls_.size() < config_.maxPages) {
-        std::string currentUrl = urlQueue_.front();
-        urlQueue_.pop();
+    while (running_ && pagesClaimed_ < config_.maxPages) {
+        std::string currentUrl;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex_);
+            if (!dequeueLocked(currentUrl)) break;
+        }
 
         if (visitedUrls_.find(currentUrl) != visitedUrls_.end()) {
             continue;
         }
 
-        processUrl(currentUrl);
+        processUrl(currentUrl, 0);
 
         if (config_.delayBetweenRequests.count() > 0) {
+            CrawlTrace::Span span(trace_, 0, "delay", trace_.sampled(currentUrl));
             std::this_thread::sleep_for(config_.delayBetweenRequests);
         }
     }
 
-    std::cout << "Crawl completed. Visited " << visitedUrls_.size() << " pages\n";
+    closeResultSink();
+    metrics_.stopReporting();
+    finishTrace();
+    printDnsSummary();
+    printTrapSummary();
+    printDedupSummary();
+    printMemorySummary();
+    saveState();
+    std::cout << "Crawl completed. Visited " << pagesClaimed_ << " pages\n";
 }
 
 void WebCrawler::stop() {
     running_ = false;
+    cv_.notify_all();
 }
 
-void WebCrawler::processUrl(const std::string& url) {
+void WebCrawler::processUrl(const std::string& url, size_t worker) {
+    const bool traced = trace_.sampled(url);
+    const auto urlStart = CrawlTrace::Clock::now();
+
     if (!shouldCrawlUrl(url)) {
         return;
     }
 
-    visitedUrls_.insert(url);
+    {
+        // Claim the URL; another worker may have dequeued a duplicate of it
+        CrawlTrace::Span span(trace_, worker, "claim", traced);
+        std::lock_guard<std::mutex> visitedLock(visitedMutex_);
+        if (pagesClaimed_ >= config_.maxPages || !visitedUrls_.insert(url).second) {
+            return;
+        }
+        ++pagesClaimed_;
+        memory_.charge(MemoryBudget::Account::Visited, visitedBytes(url));
+        metrics_.setVisitedCount(visitedUrls_.size());
+    }
+    fetchUrl(url, worker, traced, urlStart);
+}
+
+// Takes over a redirect target for the chain being followed. False if the target is, or
+// will be, crawled on its own: already visited, or in continuous mode handed to the state
+// store to be scheduled like any discovered URL. The hop stays within the page the chain
+// started as, so it is not counted against maxPages
+bool WebCrawler::claimRedirectTarget(const std::string& target, size_t worker) {
+    if (continuous_) {
+        urlState_->discover(target, std::chrono::system_clock::now());
+        return false;
+    }
+    std::lock_guard<std::mutex> visitedLock(visitedMutex_);
+    if (!visitedUrls_.insert(target).second) {
+        metrics_.add(worker, CrawlMetrics::Counter::RedirectDuplicates);
+        return false;
+    }
+    memory_.charge(MemoryBudget::Account::Visited, visitedBytes(target));
+    metrics_.setVisitedCount(visitedUrls_.size());
+    return true;
+}
+
+void WebCrawler::fetchUrl(const std::string& url, size_t worker, bool traced, CrawlTrace::Clock::time_point urlStart) {
     std::cout << "Crawling: " << url << std::endl;
 
     CrawlResult result;
     result.url = url;
+    size_t bodyBytes = 0;  // Charged to Bodies as it downloads, released once the result is queued
+    bool stateRecorded = false;
 
     try {
-        auto response = httpClient_.get(url);
+        const HttpClient& client = workerClients_.empty() ? httpClient_ : *workerClients_[worker];
+        // Redirects are followed here rather than by curl, one hop at a time, so each hop is
+        // recorded and a target that is crawled anyway is never downloaded twice
+        std::string target = url;
+        HttpClient::HttpResponse response;
+        while (true) {
+            const auto parsed = UrlParser::parse(target);
+            std::vector<std::string> resolve;
+            {
+                CrawlTrace::Span span(trace_, worker, "resolve", traced);
+                resolve = resolveForFetch(parsed);
+            }
+            metrics_.beginHostRequest(parsed.host);
+            const auto fetchStart = CrawlTrace::Clock::now();
+            response = client.getOnce(target, resolve, &memory_);
+            bodyBytes = response.success ? MemoryBudget::stringBytes(response.body.size()) : 0;
+            metrics_.endHostRequest(parsed.host);
+            if (traced) {
+                trace_.record(worker, "fetch", fetchStart, CrawlTrace::Clock::now());
+                traceFetch(worker, fetchStart, response.timing);
+            }
+
+            using Stage = CrawlMetrics::Stage;
+            metrics_.record(worker, Stage::Dns, response.timing.nameLookup.count());
+            metrics_.record(worker, Stage::Connect, response.timing.connect.count());
+            if (response.timing.tlsHandshake.count() > 0) {
+                metrics_.record(worker, Stage::Tls, response.timing.tlsHandshake.count());
+            }
+            metrics_.record(worker, Stage::FirstByte, response.timing.firstByte.count());
+            metrics_.record(worker, Stage::Total, response.timing.total.count());
+            metrics_.add(worker, CrawlMetrics::Counter::BytesDownloaded, response.timing.bytesDownloaded);
+
+            std::string next;
+            // A 3xx without a Location (304, or a 300 naming no choice) ends the chain where it is
+            if (!config_.httpConfig.followRedirects || !response.success || !response.isRedirect() ||
+                response.location.empty() || !canonicalizer_.canonicalize(response.location, target, next)) {
+                break;
+            }
+            result.redirects.push_back({target, next, response.statusCode, response.rawHeaders, response.timestamp});
+            metrics_.add(worker, CrawlMetrics::Counter::Redirects);
+            if (result.redirects.size() > static_cast<size_t>(config_.httpConfig.maxRedirects)) {
+                response.success = false;
+                response.errorMessage = "Maximum (" + std::to_string(config_.httpConfig.maxRedirects) +
+                                        ") redirects followed";
+                break;
+            }
+            if (next == target || !shouldCrawlUrl(next) || !claimRedirectTarget(next, worker)) break;
+            memory_.release(MemoryBudget::Account::Bodies, bodyBytes);  // The 3xx body is replaced
+            bodyBytes = 0;
+            target = std::move(next);
+        }
+        result.finalUrl = target;
+
+        metrics_.add(worker, CrawlMetrics::Counter::Pages);
+        if (!response.isSuccess() && !(response.success && response.isRedirect())) {
+            metrics_.add(worker, CrawlMetrics::Counter::Errors);
+        }
+
+        const bool fetched = response.success && response.statusCode == 200;
+        const std::optional<uint64_t> contentHash =
+            fetched && (urlState_ || traps_) ? std::optional<uint64_t>(UrlStateStore::hashContent(response.body))
+                                             : std::nullopt;
+        // The body belongs to the URL that answered it, not to the one the chain started at
+        if (traps_ && contentHash) {
+            traps_->recordContent(target, *contentHash);
+        }
+        if (urlState_) {
+            const auto now = std::chrono::system_clock::now();
+            // Each hop is a fetch of its own URL whose content is where it points, so a
+            // redirect that moves counts as a change. A chain cut short ends on a hop, which
+            // then stands for the result
+            auto outcome = UrlStateStore::Outcome::Failed;
+            for (const auto& redirect : result.redirects) {
+                outcome = urlState_->recordFetch(redirect.from, now, redirect.statusCode,
+                                                 UrlStateStore::hashContent(redirect.to));
+            }
+            if (result.redirects.empty() || result.redirects.back().from != target) {
+                outcome = urlState_->recordFetch(target, now, response.statusCode, contentHash);
+            }
+            stateRecorded = true;
+            if (outcome == UrlStateStore::Outcome::Changed || outcome == UrlStateStore::Outcome::Unchanged) {
+                metrics_.add(worker, CrawlMetrics::Counter::Revisits);
+            }
+            if (outcome == UrlStateStore::Outcome::Unchanged) {
+                metrics_.add(worker, CrawlMetrics::Counter::Unchanged);
+            }
+        }
 
         result.statusCode = response.statusCode;
         result.success = response.success;
         result.errorMessage = response.errorMessage.value_or("");
+        result.responseHeaders = std::move(response.rawHeaders);
+        result.fetchTime = response.timestamp;
 
         if (response.success && response.statusCode == 200) {
-            result.content = response.body;
-            result.extractedLinks = extractLinks(response.body, url);
+            const auto parseStart = std::chrono::steady_clock::now();
+            std::vector<bool> canonicalized;
+            result.extractedLinks = extractLinks(response.body, target, canonicalizer_, &canonicalized);
+            result.content = std::move(response.body);
+            const auto parseEnd = std::chrono::steady_clock::now();
+            metrics_.record(worker, CrawlMetrics::Stage::Parse,
+                            std::chrono::duration_cast<std::chrono::microseconds>(parseEnd - parseStart).count());
+            metrics_.add(worker, CrawlMetrics::Counter::LinksExtracted, result.extractedLinks.size());
+            metrics_.add(worker, CrawlMetrics::Counter::LinksCanonicalized,
+                         std::count(canonicalized.begin(), canonicalized.end(), true));
+            if (traced) {
+                trace_.record(worker, "parse", parseStart, parseEnd);
+            }
 
             // Add new URLs to queue
-            for (const auto& link : result.extractedLinks) {
-                if (shouldCrawlUrl(link) && visitedUrls_.find(link) == visitedUrls_.end()) {
-                    urlQueue_.push(link);
+            CrawlTrace::Span span(trace_, worker, "enqueue", traced);
+            std::vector<std::string> newLinks;
+            const auto now = std::chrono::system_clock::now();
+            for (size_t l = 0; l < result.extractedLinks.size(); ++l) {
+                const auto& link = result.extractedLinks[l];
+                if (!shouldCrawlUrl(link)) continue;
+                if (resolver_ && resolver_->isDead(UrlParser::hostOf(link))) {
+                    dnsDropped_.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+                if (traps_ && traps_->admit(link) != TrapDetector::Verdict::Accept) {
+                    metrics_.add(worker, CrawlMetrics::Counter::TrapDropped);
+                    continue;
+                }
+                if (urlState_) {
+                    // In continuous mode the store is the frontier: new URLs come due at once
+                    const bool added = urlState_->discover(link, now);
+                    if (continuous_) {
+                        if (added && resolver_) resolver_->prefetch(UrlParser::hostOf(link));
+                        continue;
+                    }
+                }
+                std::lock_guard<std::mutex> visitedLock(visitedMutex_);
+                if (visitedUrls_.find(link) == visitedUrls_.end()) {
+                    newLinks.push_back(link);
+                } else if (canonicalized[l]) {
+                    metrics_.add(worker, CrawlMetrics::Counter::CanonicalDuplicates);
+                }
+            }
+            // Start the lookups now so the answers are cached by the time these are fetched
+            if (resolver_) {
+                for (const auto& link : newLinks) {
+                    resolver_->prefetch(UrlParser::hostOf(link));
+                }
+            }
+
+            if (!newLinks.empty()) {
+                {
+                    std::lock_guard<std::mutex> lock(queueMutex_);
+                    for (auto& link : newLinks) {
+                        enqueueLocked(std::move(link));
+                    }
+                    updateFrontierMetricsLocked();
                 }
+                cv_.notify_all();
             }
         }
+        if (urlState_) {
+            memory_.set(MemoryBudget::Account::UrlState, urlState_->memoryUsage());
+        }
 
     } catch (const std::exception& e) {
         result.success = false;
         result.errorMessage = e.what();
+        metrics_.add(worker, CrawlMetrics::Counter::Errors);
+        // takeDue() left the URL in flight; only a recorded fetch reschedules it
+        if (urlState_ && !stateRecorded) {
+            urlState_->recordFetch(url, std::chrono::system_clock::now(), 0, std::nullopt);
+        }
     }
 
-    if (crawlCallback_) {
-        crawlCallback_(result);
+    if (workerCallback_) {
+        CrawlTrace::Span span(trace_, worker, "write", traced);
+        try {
+            workerCallback_(result);
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: " << e.what() << "\n";
+        }
+    }
+
+    // From here the page is accounted as a queued result until the consumer is done with it
+    memory_.release(MemoryBudget::Account::Bodies, bodyBytes);
+    memory_.charge(MemoryBudget::Account::Results, result.memoryUsage());
+
+    // Blocks if the consumer has fallen behind, which throttles this worker
+    {
+        CrawlTrace::Span span(trace_, worker, "deliver", traced);
+        sink_->push(worker, std::move(result));
+    }
+    if (traced) {
+        trace_.record(worker, "url", urlStart, CrawlTrace::Clock::now(), url);
     }
 }
 
-std::vector<std::string> WebCrawler::extractLinks(const std::string& html, const std::string& baseUrl) {
-    std::vector<std::string> links;
+void WebCrawler::startContinuous() {
+    running_ = true;
+    continuous_ = true;
+    const size_t workers = std::max<size_t>(1, numThreads_);
 
-    std::regex linkRegex(R"(href\s*=\s*["']([^"']+)["'])", std::regex_constants::icase);
-    std::sregex_iterator iter(html.begin(), html.end(), linkRegex);
-    std::sregex_iterator end;
+    workerClients_.clear();
+    std::vector<const HttpClient*> clients;
+    for (size_t i = 0; i < workers; ++i) {
+        workerClients_.push_back(std::make_unique<HttpClient>(config_.httpConfig));
+        clients.push_back(workerClients_.back().get());
+    }
+    for (const auto& seedUrl : config_.seedUrls) {
+        enqueueLocked(seedUrl);
+    }
+    seedFromSitemaps(clients);
 
-    for (; iter != end; ++iter) {
-        std::string href = (*iter)[1].str();
+    // Seeds and sitemap URLs join the store; ones it already tracks keep their schedule
+    const auto seededAt = std::chrono::system_clock::now();
+    for (std::string url; dequeueLocked(url);) {
+        urlState_->discover(url, seededAt);
+    }
+    memory_.set(MemoryBudget::Account::UrlState, urlState_->memoryUsage());
+
+    startMetrics(workers);
+    startTrace(workers);
+    openResultSink(workers);
+
+    std::cout << "Starting continuous crawl of " << urlState_->size() << " URLs with " << workers
+              << " threads at up to " << config_.recrawlPagesPerSecond << " pages/s\n";
+
+    // Fetch slots are handed out at fixed spacing, shared by all workers
+    using SteadyClock = std::chrono::steady_clock;
+    const auto slotSpacing = std::chrono::duration_cast<SteadyClock::duration>(
+        std::chrono::duration<double>(1.0 / std::max(config_.recrawlPagesPerSecond, 1e-6)));
+    std::mutex slotMutex;
+    auto nextSlot = SteadyClock::now();
+
+    const auto began = SteadyClock::now();
+    const auto deadline = config_.recrawlDuration.count() > 0 ? began + config_.recrawlDuration
+                                                              : SteadyClock::time_point::max();
+    auto sleepUntil = [this](SteadyClock::time_point until) {
+        while (running_ && SteadyClock::now() < until) {
+            std::this_thread::sleep_for(std::min<SteadyClock::duration>(until - SteadyClock::now(), RECRAWL_POLL_INTERVAL));
+        }
+        return running_.load();
+    };
+
+    for (size_t i = 0; i < workers; ++i) {
+        workers_.emplace_back([&, i]() {
+            while (running_ && SteadyClock::now() < deadline) {
+                SteadyClock::time_point slot;
+                {
+                    std::lock_guard<std::mutex> lock(slotMutex);
+                    slot = std::max(nextSlot, SteadyClock::now());
+                    nextSlot = slot + slotSpacing;
+                }
+                if (!sleepUntil(std::min(slot, deadline)) || slot >= deadline) break;
+
+                // Taken after the slot opens, so the URL is the most overdue one at that time
+                auto due = urlState_->takeDue(std::chrono::system_clock::now(), 1);
+                if (due.empty()) {
+                    // Nothing due: the slot goes unused rather than spent on a fresh page
+                    const auto next = urlState_->nextDue();
+                    const auto wait = next ? std::chrono::duration_cast<SteadyClock::duration>(
+                                                 *next - std::chrono::system_clock::now())
+                                           : SteadyClock::duration(RECRAWL_POLL_INTERVAL);
+                    sleepUntil(SteadyClock::now() + std::clamp<SteadyClock::duration>(wait, {}, RECRAWL_POLL_INTERVAL));
+                    continue;
+                }
 
-        if (href.rfind("http://", 0) == 0 || href.rfind("https://", 0) == 0) {
-            links.push_back(href);
-        } else if (!href.empty() && href[0] == '/') {
-            auto baseParsed = UrlParser::parse(baseUrl);
-            if (baseParsed.valid) {
-                links.push_back(baseParsed.scheme + "://" + baseParsed.host + href);
+                const std::string& url = due.front();
+                if (!shouldCrawlUrl(url)) continue;  // Tracked by an earlier run with other filters
+                const bool traced = trace_.sampled(url);
+                fetchUrl(url, i, traced, CrawlTrace::Clock::now());
             }
+        });
+    }
+
+    // Checkpoint the store while the workers run, so a crash loses little history
+    auto lastSave = SteadyClock::now();
+    while (running_ && SteadyClock::now() < deadline) {
+        std::this_thread::sleep_for(RECRAWL_POLL_INTERVAL);
+        if (!config_.stateFile.empty() && SteadyClock::now() - lastSave >= config_.stateSaveInterval) {
+            saveState();
+            lastSave = SteadyClock::now();
+        }
+    }
+    running_ = false;
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
         }
     }
+    workers_.clear();
+    continuous_ = false;
 
-    return links;
+    closeResultSink();
+    metrics_.stopReporting();
+    finishTrace();
+    printDnsSummary();
+    printTrapSummary();
+    printDedupSummary();
+    printMemorySummary();
+    saveState();
 }
 
-bool WebCrawler::shouldCrawlUrl(const std::string& url) const {
-    auto parsed = UrlParser::parse(url);
+void WebCrawler::saveState() const {
+    if (!urlState_) return;
+    const auto stats = urlState_->stats(std::chrono::system_clock::now());
+    const uint64_t revisits = stats.changed + stats.unchanged;
+    std::cout << "URL state: " << stats.urls << " URLs (" << stats.due << " due), " << stats.first
+              << " first fetches, " << revisits << " revisits (" << stats.changed << " changed";
+    if (revisits > 0) {
+        std::cout << ", " << std::fixed << std::setprecision(1)
+                  << 100.0 * static_cast<double>(stats.changed) / static_cast<double>(revisits) << "%"
+                  << std::defaultfloat;
+    }
+    std::cout << "), " << stats.failed << " failed\n";
+    if (!config_.stateFile.empty()) {
+        urlState_->save(config_.stateFile);
+    }
+}
 
-    if (!parsed.valid) return false;
+// CURLOPT_RESOLVE entries for the URL's host. Throws for a host cached as nonexistent, so
+// the URL fails without a connection attempt.
+std::vector<std::string> WebCrawler::resolveForFetch(const UrlParser::ParsedUrl& parsed) {
+    if (!resolver_ || !parsed.valid || DnsResolver::isIpLiteral(parsed.host)) {
+        return {};
+    }
+    const auto answer = resolver_->resolve(parsed.host);
+    if (!answer) {
+        return {};  // No usable answer; curl resolves the host itself
+    }
+    if (!answer->found) {
+        throw std::runtime_error("Could not resolve host: " + parsed.host + " (cached)");
+    }
+    return {DnsResolver::curlResolveEntry(parsed.host, parsed.port, *answer)};
+}
 
-    // Check domain restrictions
-    if (config_.sameDomainOnly && allowedDomains_.find(parsed.host) == allowedDomains_.end()) {
-        return false;
+void WebCrawler::printDnsSummary() const {
+    if (!resolver_) return;
+    const auto stats = resolver_->stats();
+    std::cout << "DNS: " << stats.lookups << " lookups, " << stats.cacheHits << " cache hits, "
+              << stats.deadHosts << " missing hosts, " << stats.failures << " failures, "
+              << dnsDropped_.load(std::memory_order_relaxed) << " links to missing hosts dropped\n";
+}
+
+void WebCrawler::printTrapSummary() const {
+    if (!traps_) return;
+    const auto stats = traps_->stats();
+    std::cout << "Traps: " << traps_->dropped() << " links dropped";
+    const char* separator = " (";
+    for (size_t v = 1; v < stats.verdicts.size(); ++v) {
+        if (stats.verdicts[v] == 0) continue;
+        std::cout << separator << TrapDetector::verdictName(static_cast<TrapDetector::Verdict>(v)) << " "
+                  << stats.verdicts[v];
+        separator = ", ";
+    }
+    if (*separator == ',') std::cout << ")";
+    std::cout << " over " << stats.patterns << " URL patterns, " << stats.trappedPatterns
+              << " closed for duplicate content\n";
+    for (const auto& [pattern, dropped] : stats.worst) {
+        std::cout << "  " << dropped << " dropped: " << pattern << "\n";
+    }
+}
+
+void WebCrawler::printDedupSummary() const {
+    std::cout << "Canonicalization: " << metrics_.total(CrawlMetrics::Counter::LinksCanonicalized)
+              << " links rewritten, " << metrics_.total(CrawlMetrics::Counter::CanonicalDuplicates)
+              << " of them to already visited URLs\n";
+    std::cout << "Redirects: " << metrics_.total(CrawlMetrics::Counter::Redirects) << " hops followed, "
+              << metrics_.total(CrawlMetrics::Counter::RedirectDuplicates)
+              << " chains stopped at an already visited URL\n";
+}
+
+void WebCrawler::seedFromSitemaps(const std::vector<const HttpClient*>& clients) {
+    struct Job {
+        std::string url;
+        std::string origin;  // Set for robots.txt jobs
+    };
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<Job> jobs;                 // Guarded by mutex, as is everything down to `rejected`
+    std::unordered_set<std::string> seen; // Sitemap and robots.txt URLs already queued
+    size_t active = 0;
+    size_t files = 0;
+    size_t failedFiles = 0;
+    size_t found = 0;
+    size_t rejected = 0;
+    std::vector<SitemapParser::Entry> collected;
+
+    const size_t cap = std::min(config_.sitemapMaxUrls, config_.maxPages);
+    auto addJob = [&](std::string url, std::string origin = {}) {
+        if (jobs.size() + files >= config_.sitemapMaxFiles || !seen.insert(url).second) return;
+        jobs.push_back({std::move(url), std::move(origin)});
+    };
+    // Keeps the freshest `cap` entries so memory stays bounded however many the sitemaps list
+    auto keepFreshest = [&] {
+        if (collected.size() <= cap) return;
+        std::nth_element(collected.begin(), collected.begin() + static_cast<std::ptrdiff_t>(cap), collected.end(),
+                         [](const auto& a, const auto& b) { return a.lastmod > b.lastmod; });
+        collected.resize(cap);
+    };
+
+    if (config_.discoverSitemaps) {
+        for (const auto& seedUrl : config_.seedUrls) {
+            const auto parsed = UrlParser::parse(seedUrl);
+            if (!parsed.valid) continue;
+            std::string origin = parsed.scheme + "://" + parsed.host;
+            if (parsed.port != -1 && parsed.port != (parsed.scheme == "https" ? 443 : 80)) {
+                origin += ":" + std::to_string(parsed.port);
+            }
+            addJob(origin + "/robots.txt", origin);
+        }
     }
+    for (const auto& sitemapUrl : config_.sitemapUrls) {
+        addJob(sitemapUrl);
+    }
+    if (jobs.empty() || cap == 0) return;
+
+    const auto begin = std::chrono::steady_clock::now();
+    auto work = [&](const HttpClient& client) {
+        constexpr size_t FLUSH_EVERY = 8192;
+        std::vector<SitemapParser::Entry> batch;
+        std::vector<std::string> children;
+        std::string canonical;
+        size_t batchRejected = 0;
+        auto flush = [&] {
+            std::lock_guard<std::mutex> lock(mutex);
+            found += batch.size() + batchRejected;
+            rejected += batchRejected;
+            std::move(batch.begin(), batch.end(), std::back_inserter(collected));
+            if (collected.size() >= 2 * cap) keepFreshest();
+            batch.clear();
+            batchRejected = 0;
+        };
+
+        while (running_) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&] { return !jobs.empty() || active == 0; });
+                if (jobs.empty()) break;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+                ++active;
+                if (job.origin.empty()) ++files;
+            }
 
-    // Check file extensions
-    for (const auto& ext : config_.skipExtensions) {
-        const std::string& path = parsed.path;
-        if (path.size() >= ext.size() &&
-            path.compare(path.size() - ext.size(), ext.size(), ext) == 0) {
-            return false;
+            bool failed = false;
+            try {
+                const auto resolve = resolveForFetch(UrlParser::parse(job.url));
+                if (!job.origin.empty()) {
+                    // robots.txt; without Sitemap lines fall back to the conventional locations
+                    const auto response = client.get(job.url, resolve);
+                    children = response.isSuccess() ? RobotParser::parseSitemaps(response.body)
+                                                    : std::vector<std::string>{};
+                    if (children.empty()) {
+                        children = {job.origin + "/sitemap.xml", job.origin + "/sitemap_index.xml"};
+                    }
+                } else {
+                    SitemapParser parser([&](SitemapParser::Entry&& entry, bool isSitemap) {
+                        if (isSitemap) {
+                            children.push_back(std::move(entry.loc));
+                        } else if (!canonicalizer_.canonicalize(entry.loc, {}, canonical) ||
+                                   !shouldCrawlUrl(canonical)) {
+                            ++batchRejected;
+                        } else {
+                            entry.loc.swap(canonical);
+                            batch.push_back(std::move(entry));
+                            if (batch.size() >= FLUSH_EVERY) flush();
+                        }
+                    });
+                    const auto response = client.stream(job.url, [&](std::string_view chunk) {
+                        return parser.feed(chunk) && running_;
+                    }, resolve);
+                    // A missing well-known sitemap is expected and not worth reporting
+                    failed = (!response.isSuccess() && response.statusCode != 404 && response.statusCode != 410)
+                             || (response.isSuccess() && !parser.finish());
+                }
+            } catch (const std::exception&) {
+                failed = true;
+            }
+            flush();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (failed) ++failedFiles;
+                for (auto& child : children) {
+                    addJob(std::move(child));
+                }
+                --active;
+            }
+            children.clear();
+            cv.notify_all();
         }
+        cv.notify_all();
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < clients.size(); ++i) {
+        threads.emplace_back(work, std::cref(*clients[i]));
+    }
+    work(*clients[0]);
+    for (auto& thread : threads) {
+        thread.join();
     }
 
-    return true;
+    // One entry per URL, keeping the latest lastmod, then freshest first so recently changed
+    // pages are fetched before the crawl budget runs out
+    keepFreshest();
+    std::sort(collected.begin(), collected.end(), [](const auto& a, const auto& b) {
+        return a.loc != b.loc ? a.loc < b.loc : a.lastmod > b.lastmod;
+    });
+    collected.erase(std::unique(collected.begin(), collected.end(),
+                                [](const auto& a, const auto& b) { return a.loc == b.loc; }),
+                    collected.end());
+    std::stable_sort(collected.begin(), collected.end(),
+                     [](const auto& a, const auto& b) { return a.lastmod > b.lastmod; });
+
+    {
+        const auto now = std::chrono::system_clock::now();
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        for (auto& entry : collected) {
+            if (resolver_) resolver_->prefetch(UrlParser::hostOf(entry.loc));
+            // A lastmod newer than the last fetch makes a known URL due for a revisit
+            if (urlState_) urlState_->discover(entry.loc, now, entry.lastmod);
+            enqueueLocked(std::move(entry.loc));
+        }
+        updateFrontierMetricsLocked();
+    }
+    if (urlState_) {
+        memory_.set(MemoryBudget::Account::UrlState, urlState_->memoryUsage());
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "Sitemaps: " << files << " files (" << failedFiles << " failed), " << found << " URLs, "
+              << collected.size() << " queued, " << rejected << " filtered out in " << std::fixed
+              << std::setprecision(2) << seconds << "s" << std::defaultfloat << "\n";
+}
+
+std::vector<std::string> WebCrawler::extractLinks(const std::string& html, const std::string& baseUrl) {
+    return extractLinks(html, baseUrl, UrlCanonicalizer::standard());
+}
+
+std::vector<std::string> WebCrawler::extractLinks(const std::string& html, const std::string& baseUrl,
+                                                  const UrlCanonicalizer& canonicalizer,
+                                                  std::vector<bool>* canonicalized) {
+    std::vector<std::string> links;
+    std::string link;
+
+    std::regex linkRegex(R"(href\s*=\s*["']([^"']+)["'])", std::regex_constants::icase);
+    std::sregex_iterator iter(html.begin(), html.end(), linkRegex);
+    std::sregex_iterator end;
+
+    for (; iter != end; ++iter) {
+        std::string href = (*iter)[1].str();
+        // Attribute values are HTML-escaped, and "&amp;" is the escape URLs carry
+        for (size_t amp = href.find("&amp;"); amp != std::string::npos; amp = href.find("&amp;", amp + 1)) {
+            href.erase(amp + 1, 4);
+        }
+        bool rewritten = false;
+        if (!canonicalizer.canonicalize(href, baseUrl, link, &rewritten)) continue;
+        if (canonicalized) canonicalized->push_back(rewritten);
+        links.push_back(link);
+    }
+
+    return links;
 }
 
 size_t WebCrawler::getQueueSize() const {
-    return urlQueue_.size();
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    return urlQueue_.size() + spill_.size();
 }
 
 size_t WebCrawler::getVisitedCount() const {
+    std::lock_guard<std::mutex> lock(visitedMutex_);
     return visitedUrls_.size();
 }
 
@@ -162,38 +938,82 @@ void WebCrawler::startMultiThreaded() {
 
     // Add seed URLs to queue
     for (const auto& seedUrl : config_.seedUrls) {
-        urlQueue_.push(seedUrl);
+        enqueueLocked(seedUrl);
+        if (resolver_) resolver_->prefetch(UrlParser::hostOf(seedUrl));
+    }
+
+    workerClients_.clear();
+    std::vector<const HttpClient*> clients;
+    for (size_t i = 0; i < numThreads_; ++i) {
+        workerClients_.push_back(std::make_unique<HttpClient>(config_.httpConfig));
+        clients.push_back(workerClients_.back().get());
     }
+    seedFromSitemaps(clients);
+    startMetrics(numThreads_);
+    startTrace(numThreads_);
+    openResultSink(numThreads_);
 
     std::cout << "Starting multi-threaded crawl with " << numThreads_ << " threads\n";
 
     // Create worker threads
     for (size_t i = 0; i < numThreads_; ++i) {
-        workers_.emplace_back([this]() {
+        workers_.emplace_back([this, i]() {
             while (running_) {
                 std::string currentUrl;
+                const auto dequeueStart = CrawlTrace::Clock::now();
 
                 {
+                    // An empty queue only means the crawl is over once no worker is
+                    // still fetching a page that could add more links. Under memory
+                    // pressure fewer workers may fetch at once
                     std::unique_lock<std::mutex> lock(queueMutex_);
-                    cv_.wait(lock, [this] { return !urlQueue_.empty() || !running_; });
+                    bool throttled = false;
+                    auto ready = [this, &throttled] {
+                        if (!running_ || activeWorkers_ == 0) return true;
+                        if (frontierEmptyLocked()) return false;
+                        if (activeWorkers_ < fetchSlots()) return true;
+                        throttled = true;
+                        return false;
+                    };
+                    while (!cv_.wait_for(lock, MEMORY_POLL_INTERVAL, ready)) {
+                    }
+                    if (throttled) {
+                        throttledFetches_.fetch_add(1, std::memory_order_relaxed);
+                    }
 
-                    if (!running_ || urlQueue_.empty()) break;
+                    if (!running_) break;
 
                     {
                         std::lock_guard<std::mutex> visitedLock(visitedMutex_);
-                        if (visitedUrls_.size() >= config_.maxPages) break;
+                        if (pagesClaimed_ >= config_.maxPages) break;
                     }
 
-                    currentUrl = urlQueue_.front();
-                    urlQueue_.pop();
+                    if (!dequeueLocked(currentUrl)) break;
+                    ++activeWorkers_;
                 }
 
-                processUrl(currentUrl);
+                // Time spent waiting for queueMutex_ and for work to appear
+                const bool traced = trace_.sampled(currentUrl);
+                if (traced) {
+                    trace_.record(i, "dequeue", dequeueStart, CrawlTrace::Clock::now());
+                }
+
+                processUrl(currentUrl, i);
+
+                {
+                    std::lock_guard<std::mutex> lock(queueMutex_);
+                    --activeWorkers_;
+                }
+                cv_.notify_all();
 
                 if (config_.delayBetweenRequests.count() > 0) {
+                    CrawlTrace::Span span(trace_, i, "delay", traced);
                     std::this_thread::sleep_for(config_.delayBetweenRequests);
                 }
             }
+
+            // Let waiting workers re-check the exit conditions
+            cv_.notify_all();
         });
     }
 
@@ -203,6 +1023,15 @@ void WebCrawler::startMultiThreaded() {
             worker.join();
         }
     }
+    workers_.clear();
 
-    std::cout << "Multi-threaded crawl completed. Visited " << visitedUrls_.size() << " pages\n";
-}
\ No newline at end of file
+    closeResultSink();
+    metrics_.stopReporting();
+    finishTrace();
+    printDnsSummary();
+    printTrapSummary();
+    printDedupSummary();
+    printMemorySummary();
+    saveState();
+    std::cout << "Multi-threaded crawl completed. Visited " << pagesClaimed_ << " pages\n";
+}
@@ -6,7 +6,20 @@
 
 #include "httpclient.h"
 #include "urlparser.h"
+#include "urlfilter.h"
+#include "urlcanonicalizer.h"
+#include "dnsresolver.h"
+#include "urlstatestore.h"
+#include "crawlresult.h"
+#include "resultsink.h"
+#include "frontierspill.h"
+#include "trapdetector.h"
 #include "config/crawlerconfig.h"
+#include "../metrics/crawlmetrics.h"
+#include "../metrics/crawltrace.h"
+#include "../util/memorybudget.h"
+#include <atomic>
+#include <memory>
 #include <queue>
 #include <unordered_set>
 #include <vector>
@@ -14,24 +27,29 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <cstdint>
 
 class WebCrawler {
 public:
-    struct CrawlResult {
-        std::string url;
-        int statusCode = 0;
-        std::string content;
-        std::vector<std::string> extractedLinks;
-        bool success = false;
-        std::string errorMessage;
-    };
+    using CrawlResult = ::CrawlResult;
 
     using CrawlCallback = std::function<void(const CrawlResult&)>;
+    using BatchCallback = ResultSink::BatchConsumer;
 
     explicit WebCrawler(const CrawlerConfig& config);
 
     void addSeedUrl(const std::string& url);
+    // Both callbacks run on a dedicated consumer thread, never concurrently with
+    // themselves. The batch callback receives results by value and may move them out;
+    // the per-result callback is invoked first for each result in the batch.
     void setCrawlCallback(CrawlCallback callback);
+    void setBatchCallback(BatchCallback callback);
+    // Runs on the worker that fetched each result, just before it is queued, so it runs
+    // concurrently with itself. For thread-safe writers whose per-result work, such as
+    // compression, should scale with the workers instead of holding up the consumer
+    void setWorkerCallback(CrawlCallback callback);
+    // Results each worker may have queued before it blocks waiting for the consumer
+    void setResultQueueCapacity(size_t capacity) { resultQueueCapacity_ = capacity; }
     void start();
     void stop();
 
@@ -39,26 +57,104 @@ public:
     size_t getVisitedCount() const;
 
     void setThreadCount(size_t threads) { numThreads_ = threads; }
+    [[nodiscard]] const CrawlMetrics& metrics() const { return metrics_; }
     void startMultiThreaded();
+    // Revisits URLs as the state store schedules them, within the configured pages/sec
+    // budget, until recrawlDuration passes or stop() is called
+    void startContinuous();
+    // Async-signal-safe stop: only clears the running flag, which the continuous mode's
+    // timed waits notice within a fraction of a second
+    void requestStop() noexcept { running_.store(false); }
+
+    // The configured seeds in canonical form, the names their pages are crawled under
+    [[nodiscard]] const std::vector<std::string>& seedUrls() const { return config_.seedUrls; }
+    // Rewrites URLs to the form the crawler records them in
+    [[nodiscard]] const UrlCanonicalizer& canonicalizer() const { return canonicalizer_; }
+
+    // Null unless a state file or continuous mode is configured
+    [[nodiscard]] const UrlStateStore* urlState() const { return urlState_.get(); }
+
+    // Usage against config.memoryBudget. Callers that keep results past the callbacks may
+    // charge them to the Results account, so the crawl slows down as they pile up
+    [[nodiscard]] MemoryBudget& memory() { return memory_; }
+
+    // Links of a page in canonical form (UrlCanonicalizer::standard() for the two-argument
+    // version). With canonicalized set, it gets one flag per link telling whether its
+    // canonical form differs from the href resolved as written
+    static std::vector<std::string> extractLinks(const std::string& html, const std::string& baseUrl);
+    static std::vector<std::string> extractLinks(const std::string& html, const std::string& baseUrl,
+                                                 const UrlCanonicalizer& canonicalizer,
+                                                 std::vector<bool>* canonicalized = nullptr);
 
 private:
     CrawlerConfig config_;
     HttpClient httpClient_;
+    MemoryBudget memory_;  // Before metrics_, whose reporter thread reads it
 
     std::queue<std::string> urlQueue_;
+    FrontierSpill spill_;      // Frontier overflow while memory is short; guarded by queueMutex_
+    bool spillFailed_ = false; // The spill file could not be written; URLs stay in memory
+    std::atomic<uint64_t> throttledFetches_{0};  // Worker waits caused by memory pressure
     std::unordered_set<std::string> visitedUrls_;
-    std::unordered_set<std::string> allowedDomains_;
+    // Pages claimed for fetching, one per result, which maxPages caps. Redirect targets join
+    // visitedUrls_ without counting: they finish the page whose chain reached them
+    size_t pagesClaimed_ = 0;  // Guarded by visitedMutex_
+    UrlFilter urlFilter_;  // Compiled from config_ once; seeds add their hosts
+    UrlCanonicalizer canonicalizer_;
+    std::unique_ptr<DnsResolver> resolver_;  // Null when dnsPrefetch is off
+    std::atomic<size_t> dnsDropped_{0};      // Links to hosts known not to exist
+    std::unique_ptr<UrlStateStore> urlState_;
+    std::unique_ptr<TrapDetector> traps_;    // Null when trapDetection is off
+    bool continuous_ = false;  // Discovered links go to urlState_ instead of urlQueue_
 
     CrawlCallback crawlCallback_;
-    bool running_ = false;
+    BatchCallback batchCallback_;
+    CrawlCallback workerCallback_;
+    std::atomic<bool> running_{false};
 
-    static std::vector<std::string> extractLinks(const std::string& html, const std::string& baseUrl);
-    bool shouldCrawlUrl(const std::string& url) const;
-    void processUrl(const std::string& url);
+    bool shouldCrawlUrl(std::string_view url) const { return urlFilter_.admits(url); }
+    // Frontier access, with queueMutex_ held (or before the workers start)
+    void enqueueLocked(std::string url);
+    bool dequeueLocked(std::string& url);
+    void refillLocked();
+    bool frontierEmptyLocked() const { return urlQueue_.empty() && spill_.empty(); }
+    void updateFrontierMetricsLocked();
+    // Workers allowed to fetch at once under the current memory pressure
+    size_t fetchSlots() const;
+    void printMemorySummary() const;
+    void processUrl(const std::string& url, size_t worker);
+    bool claimRedirectTarget(const std::string& target, size_t worker);
+    void fetchUrl(const std::string& url, size_t worker, bool traced, CrawlTrace::Clock::time_point urlStart);
+    void saveState() const;
+    std::vector<std::string> resolveForFetch(const UrlParser::ParsedUrl& parsed);
+    // Streams the seeds' sitemaps into the frontier, reading one file per client at a time
+    void seedFromSitemaps(const std::vector<const HttpClient*>& clients);
+    void printDnsSummary() const;
+    void printTrapSummary() const;
+    void printDedupSummary() const;
 
     size_t numThreads_ = 4;
     std::vector<std::thread> workers_;
-    std::mutex queueMutex_;
-    std::mutex visitedMutex_;
+    mutable std::mutex queueMutex_;
+    mutable std::mutex visitedMutex_;
     std::condition_variable cv_;
+    size_t activeWorkers_ = 0;  // Guarded by queueMutex_
+
+    // One client per worker: a curl easy handle must not be shared between threads
+    std::vector<std::unique_ptr<HttpClient>> workerClients_;
+    size_t resultQueueCapacity_ = 256;
+    std::unique_ptr<ResultSink> sink_;
+
+    CrawlMetrics metrics_;
+    void startMetrics(size_t workers);
+
+    // Buffers 0..workers-1 belong to the workers, buffer `workers` to the result consumer
+    CrawlTrace trace_;
+    size_t consumerTraceThread_ = 0;
+    void startTrace(size_t workers);
+    void finishTrace();
+    void traceFetch(size_t worker, CrawlTrace::Clock::time_point start, const HttpClient::Timing& timing);
+
+    void openResultSink(size_t workers);
+    void closeResultSink();
 };
\ No newline at end of file
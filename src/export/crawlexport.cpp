@@ -3,38 +3,131 @@
 //
 
 #include "crawlexport.h"
+#include "serializer.h"
 #include <fstream>
 #include <iostream>
 
 void CrawlExport::exportToJSON(const std::vector<WebCrawler::CrawlResult>& results,
                                 const std::string& filename) {
 
-    std::ofstream file(filename); file << "{\n  \"crawl_results\": [\n";
+    BlockWriter writer(filename);
+    std::string& out = writer.buffer();
+    out += "{\n  \"crawl_results\": [\n";
 
     for (size_t i = 0; i < results.size(); ++i) {
         const auto& result = results[i];
-        file << "    {\n";
-        file << "      \"url\": \"" << result.url << "\",\n";
-        file << "      \"status_code\": " << result.statusCode << ",\n";
-        file << "      \"success\": " << (result.success ? "true" : "false") << ",\n";
-        file << "      \"links_found\": " << result.extractedLinks.size() << "\n";
-        file << "    }" << (i < results.size() - 1 ? "," : "") << "\n";
+        out += "    {\n      \"url\": ";
+        Serializer::appendJsonString(out, result.url);
+        out += ",\n      \"status_code\": ";
+        Serializer::appendNumber(out, result.statusCode);
+        out += ",\n      \"success\": ";
+        Serializer::appendBool(out, result.success);
+        out += ",\n      \"links_found\": ";
+        Serializer::appendNumber(out, result.linksFound());
+        out += ",\n      \"page_rank\": ";
+        Serializer::appendNumber(out, result.pageRank);
+        out += ",\n      \"weak_component\": ";
+        Serializer::appendNumber(out, result.weakComponent);
+        out += ",\n      \"strong_component\": ";
+        Serializer::appendNumber(out, result.strongComponent);
+        out += ",\n      \"click_depth\": ";
+        Serializer::appendNumber(out, result.clickDepth);
+        if (!result.redirects.empty()) {
+            out += ",\n      \"redirects\": [";
+            for (size_t r = 0; r < result.redirects.size(); ++r) {
+                const auto& redirect = result.redirects[r];
+                out += r == 0 ? "{\"from\": " : ", {\"from\": ";
+                Serializer::appendJsonString(out, redirect.from);
+                out += ", \"to\": ";
+                Serializer::appendJsonString(out, redirect.to);
+                out += ", \"status_code\": ";
+                Serializer::appendNumber(out, redirect.statusCode);
+                out += '}';
+            }
+            out += ']';
+        }
+        out += (i < results.size() - 1) ? "\n    },\n" : "\n    }\n";
+        writer.commit();
     }
-    file << "  ]\n}\n";
-    file.close();
+    out += "  ]\n}\n";
+    writer.close();
 }
 void CrawlExport::exportToCSV(const std::vector<WebCrawler::CrawlResult>& results,
                                const std::string& filename) {
-    std::ofstream file(filename);
-    file << "URL,Status Code,Success,Links Found,Content Length\n";
+    BlockWriter writer(filename);
+    std::string& out = writer.buffer();
+    out += "URL,Status Code,Success,Links Found,Content Length,PageRank,Weak Component,Strong Component,Click Depth\n";
 
     for (const auto& result : results) {
-        file << "\"" << result.url << "\","
-             << result.statusCode << ","
-             << (result.success ? "true" : "false") << ","
-             << result.extractedLinks.size() << ","
-             << result.content.length() << "\n";
+        Serializer::appendCsvField(out, result.url);
+        out += ',';
+        Serializer::appendNumber(out, result.statusCode);
+        out += ',';
+        Serializer::appendBool(out, result.success);
+        out += ',';
+        Serializer::appendNumber(out, result.linksFound());
+        out += ',';
+        Serializer::appendNumber(out, result.contentSize());
+        out += ',';
+        Serializer::appendNumber(out, result.pageRank);
+        out += ',';
+        Serializer::appendNumber(out, result.weakComponent);
+        out += ',';
+        Serializer::appendNumber(out, result.strongComponent);
+        out += ',';
+        Serializer::appendNumber(out, result.clickDepth);
+        out += '\n';
+        writer.commit();
     }
 
+    writer.close();
+}
+
+void CrawlExport::exportComponentSummary(const GraphComponents::Result& weak, const GraphComponents::Result& strong,
+                                         const std::string& filename) {
+    constexpr size_t LARGEST_LISTED = 10;
+    auto writeSummary = [](std::ofstream& file, const GraphComponents::Result& components) {
+        file << "{\n";
+        file << "    \"count\": " << components.count() << ",\n";
+        file << "    \"singletons\": " << components.singletonCount() << ",\n";
+        file << "    \"largest_sizes\": [";
+        for (size_t i = 0; i < components.sizes.size() && i < LARGEST_LISTED; ++i) {
+            file << (i > 0 ? ", " : "") << components.sizes[i];
+        }
+        file << "]\n  }";
+    };
+
+    std::ofstream file(filename);
+    file << "{\n  \"weak_components\": ";
+    writeSummary(file, weak);
+    file << ",\n  \"strong_components\": ";
+    writeSummary(file, strong);
+    file << "\n}\n";
     file.close();
 }
+
+void CrawlExport::exportGraphAnalysis(const CsrGraph& graph, const std::vector<double>& pageRanks,
+                                      const GraphComponents::Result& weak, const GraphComponents::Result& strong,
+                                      const std::vector<int32_t>& clickDepths, const std::string& filename) {
+    BlockWriter writer(filename);
+    std::string& out = writer.buffer();
+    out += "URL,Out Links,PageRank,Weak Component,Strong Component,Click Depth\n";
+
+    for (CsrGraph::NodeId node = 0; node < graph.nodeCount(); ++node) {
+        Serializer::appendCsvField(out, graph.url(node));
+        out += ',';
+        Serializer::appendNumber(out, graph.degree(node));
+        out += ',';
+        Serializer::appendNumber(out, pageRanks[node]);
+        out += ',';
+        Serializer::appendNumber(out, weak.labels[node]);
+        out += ',';
+        Serializer::appendNumber(out, strong.labels[node]);
+        out += ',';
+        Serializer::appendNumber(out, clickDepths[node]);
+        out += '\n';
+        writer.commit();
+    }
+
+    writer.close();
+}
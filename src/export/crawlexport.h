@@ -5,11 +5,18 @@
 #pragma once
 #include <vector>
 #include "../crawler/webcrawler.h"
+#include "../graph/components.h"
 
 class CrawlExport
 {
 public:
     static void exportToJSON(const std::vector<WebCrawler::CrawlResult>& results, const std::string& filename);
     static void exportToCSV(const std::vector<WebCrawler::CrawlResult>& results, const std::string& filename);
+    static void exportComponentSummary(const GraphComponents::Result& weak, const GraphComponents::Result& strong,
+                                       const std::string& filename);
+    // One CSV row per graph node (crawled or only linked to) with its analysis scores
+    static void exportGraphAnalysis(const CsrGraph& graph, const std::vector<double>& pageRanks,
+                                    const GraphComponents::Result& weak, const GraphComponents::Result& strong,
+                                    const std::vector<int32_t>& clickDepths, const std::string& filename);
     static void generateResults(const std::vector<WebCrawler::CrawlResult>& results, const std::string& filename);
 };
\ No newline at end of file
@@ -0,0 +1,557 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#include "pagestore.h"
+#include "../crawler/urlstatestore.h"
+#include "../util/mappedfile.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <zlib.h>
+
+namespace {
+    // Index layout: header, then the records (PageRecord x r), the URL hash table (Slot x s,
+    // s a power of two at most half full), the URL bytes and the dictionary. Every array
+    // starts 8-byte aligned so the mapped file can be viewed directly. Integers are stored
+    // in host byte order. Segments are a plain sequence of SegmentRecordHeader + deflate data.
+    constexpr char INDEX_MAGIC[8] = {'W', 'C', 'P', 'A', 'G', 'E', 'S', '1'};
+    constexpr uint32_t INDEX_VERSION = 1;
+    constexpr char RECORD_MAGIC[4] = {'W', 'C', 'P', 'G'};
+
+    struct IndexFileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t segmentCount;
+        uint64_t recordCount;
+        uint64_t slotCount;
+        uint64_t urlCount;
+        uint64_t recordsPos;
+        uint64_t slotsPos;
+        uint64_t urlDataPos;
+        uint64_t urlDataSize;
+        uint64_t dictionaryPos;
+        uint64_t dictionarySize;
+    };
+
+    struct SegmentRecordHeader {
+        char magic[4];
+        uint32_t flags;
+        uint64_t contentHash;
+        uint64_t rawSize;
+        uint64_t storedSize;
+    };
+
+    uint64_t alignUp(uint64_t value) {
+        return (value + 7) & ~uint64_t{7};
+    }
+
+    // Whether count elements of elementSize bytes at pos lie inside a file of fileSize
+    // bytes, without overflowing on hostile header values
+    bool fitsIn(uint64_t pos, uint64_t count, uint64_t elementSize, uint64_t fileSize) {
+        return pos <= fileSize && count <= (fileSize - pos) / elementSize;
+    }
+
+    void writePadding(std::ofstream& file, uint64_t from, uint64_t to) {
+        static constexpr char zeros[8] = {};
+        file.write(zeros, static_cast<std::streamsize>(to - from));
+    }
+
+    std::string indexName(const std::string& directory) {
+        return directory + "/index";
+    }
+
+    std::string segmentName(const std::string& directory, uint32_t number) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "/segment-%05u.pages", number);
+        return directory + name;
+    }
+
+    // Pieces of a page cut after every '>' and newline, so the same markup lines up across
+    // pages whether or not they are minified
+    template <typename Visitor>
+    void forEachPiece(std::string_view text, Visitor&& visit) {
+        size_t start = 0;
+        for (size_t i = 0; i < text.size(); ++i) {
+            if (text[i] == '>' || text[i] == '\n') {
+                visit(text.substr(start, i + 1 - start));
+                start = i + 1;
+            }
+        }
+        if (start < text.size()) visit(text.substr(start));
+    }
+
+    // The markup shared by the samples (head, navigation, footer), each piece scored by the
+    // bytes it would save over the samples. Deflate encodes nearer matches in fewer bits,
+    // so the most valuable pieces go last, next to the data
+    std::string trainDictionary(const std::vector<std::string>& samples, size_t maxSize) {
+        constexpr size_t MIN_PIECE = 8;
+        struct Piece {
+            size_t documents = 0;
+            size_t lastSample = SIZE_MAX;
+        };
+        std::unordered_map<std::string_view, Piece> pieces;
+        for (size_t s = 0; s < samples.size(); ++s) {
+            forEachPiece(samples[s], [&pieces, s](std::string_view piece) {
+                if (piece.size() < MIN_PIECE) return;
+                auto& entry = pieces[piece];
+                if (entry.lastSample != s) {
+                    entry.lastSample = s;
+                    ++entry.documents;
+                }
+            });
+        }
+
+        std::vector<std::pair<std::string_view, size_t>> scored;
+        for (const auto& [piece, entry] : pieces) {
+            if (entry.documents >= 2) scored.emplace_back(piece, (entry.documents - 1) * piece.size());
+        }
+        std::sort(scored.begin(), scored.end(), [](const auto& a, const auto& b) {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        });
+
+        size_t size = 0;
+        size_t chosen = 0;
+        while (chosen < scored.size() && size + scored[chosen].first.size() <= maxSize) {
+            size += scored[chosen++].first.size();
+        }
+        std::string dictionary;
+        dictionary.reserve(size);
+        for (size_t i = chosen; i-- > 0;) {
+            dictionary.append(scored[i].first);
+        }
+        return dictionary;
+    }
+
+    // Raw deflate streams, one per thread and reset per body
+    class Deflater
+    {
+    public:
+        explicit Deflater(int level) : level_(level) {
+            if (deflateInit2(&stream_, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+                throw std::runtime_error("Failed to initialize zlib");
+            }
+        }
+        ~Deflater() { deflateEnd(&stream_); }
+
+        Deflater(const Deflater&) = delete;
+        Deflater& operator=(const Deflater&) = delete;
+
+        [[nodiscard]] int level() const { return level_; }
+
+        void compress(std::string_view data, const std::string* dictionary, std::string& out) {
+            deflateReset(&stream_);
+            if (dictionary && !dictionary->empty()) {
+                deflateSetDictionary(&stream_, reinterpret_cast<const Bytef*>(dictionary->data()),
+                                     static_cast<uInt>(dictionary->size()));
+            }
+            out.resize(deflateBound(&stream_, static_cast<uLong>(data.size())));
+            stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+            stream_.avail_in = static_cast<uInt>(data.size());
+            stream_.next_out = reinterpret_cast<Bytef*>(out.data());
+            stream_.avail_out = static_cast<uInt>(out.size());
+            if (deflate(&stream_, Z_FINISH) != Z_STREAM_END) {
+                throw std::runtime_error("Failed to compress page body");
+            }
+            out.resize(out.size() - stream_.avail_out);
+        }
+
+    private:
+        z_stream stream_{};
+        int level_;
+    };
+
+    class Inflater
+    {
+    public:
+        Inflater() {
+            if (inflateInit2(&stream_, -15) != Z_OK) {
+                throw std::runtime_error("Failed to initialize zlib");
+            }
+        }
+        ~Inflater() { inflateEnd(&stream_); }
+
+        Inflater(const Inflater&) = delete;
+        Inflater& operator=(const Inflater&) = delete;
+
+        // False if data does not inflate to exactly out.size() bytes
+        bool decompress(std::string_view data, std::string_view dictionary, std::string& out) {
+            inflateReset(&stream_);
+            if (!dictionary.empty()) {
+                inflateSetDictionary(&stream_, reinterpret_cast<const Bytef*>(dictionary.data()),
+                                     static_cast<uInt>(dictionary.size()));
+            }
+            stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+            stream_.avail_in = static_cast<uInt>(data.size());
+            stream_.next_out = reinterpret_cast<Bytef*>(out.data());
+            stream_.avail_out = static_cast<uInt>(out.size());
+            return inflate(&stream_, Z_FINISH) == Z_STREAM_END && stream_.avail_out == 0;
+        }
+
+    private:
+        z_stream stream_{};
+    };
+}
+
+PageStoreWriter::PageStoreWriter(std::string directory, const Options& options)
+    : directory_(std::move(directory)), options_(options) {
+    std::error_code error;
+    std::filesystem::create_directories(directory_, error);
+    if (error) {
+        throw std::runtime_error("Failed to create page store directory: " + directory_);
+    }
+    // Without its old index a replaced store's leftover segments are never read
+    std::filesystem::remove(indexName(directory_), error);
+    std::lock_guard<std::mutex> lock(mutex_);
+    openNextSegmentLocked();
+}
+
+PageStoreWriter::~PageStoreWriter() {
+    try {
+        close();
+    } catch (const std::exception&) {
+        // Nothing to report to from a destructor; call close() to see the error
+    }
+}
+
+void PageStoreWriter::put(std::string_view url, std::string_view body) {
+    const uint64_t hash = UrlStateStore::hashContent(body);
+    std::vector<Candidate> candidates;
+    std::shared_ptr<const std::string> dictionary;
+    size_t recordsSeen;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_) {
+            throw std::runtime_error("Page store is closed: " + directory_);
+        }
+        rawBytes_ += body.size();
+        candidates = candidatesLocked(hash, body.size(), 0);
+        recordsSeen = records_.size();
+        dictionary = dictionary_;
+    }
+    // Stored records never change, so they are read back outside the lock
+    if (auto match = findMatch(candidates, body, dictionary.get())) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        urls_[std::string(url)] = *match;
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sampleLocked(body);
+        dictionary = dictionary_;
+    }
+
+    thread_local std::unique_ptr<Deflater> deflater;
+    thread_local std::string compressed;
+    if (!deflater || deflater->level() != options_.compressionLevel) {
+        deflater = std::make_unique<Deflater>(options_.compressionLevel);
+    }
+    deflater->compress(body, dictionary.get(), compressed);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) {
+        throw std::runtime_error("Page store is closed: " + directory_);
+    }
+    // Another thread may have stored the same body meanwhile. That is rare enough to check
+    // under the lock
+    std::optional<uint32_t> record = findMatch(candidatesLocked(hash, body.size(), recordsSeen), body,
+                                               dictionary_.get());
+    if (!record) {
+        record = appendLocked(hash, body.size(), dictionary && !dictionary->empty(), compressed);
+    }
+    urls_[std::string(url)] = *record;
+}
+
+bool PageStoreWriter::alias(std::string_view url, std::string_view storedUrl) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) {
+        throw std::runtime_error("Page store is closed: " + directory_);
+    }
+    auto it = urls_.find(std::string(storedUrl));
+    if (it == urls_.end()) return false;
+    const uint32_t record = it->second;
+    urls_[std::string(url)] = record;
+    return true;
+}
+
+// Records from fromRecord on with this hash and length. The open segment is flushed when
+// one of them is in it, so findMatch can read it back
+std::vector<PageStoreWriter::Candidate> PageStoreWriter::candidatesLocked(uint64_t hash, size_t size,
+                                                                          size_t fromRecord) {
+    std::vector<Candidate> candidates;
+    const auto [first, last] = recordsByHash_.equal_range(hash);
+    for (auto it = first; it != last; ++it) {
+        const PageRecord& record = records_[it->second];
+        if (it->second < fromRecord || record.rawSize != size) continue;
+        candidates.push_back({it->second, record});
+        if (record.segment == segmentNumber_ && std::fflush(segment_) != 0) {
+            throw std::runtime_error("Failed to write page store segment: " + segmentName(directory_, segmentNumber_));
+        }
+    }
+    return candidates;
+}
+
+// The candidate whose stored bytes inflate to exactly body
+std::optional<uint32_t> PageStoreWriter::findMatch(const std::vector<Candidate>& candidates, std::string_view body,
+                                                   const std::string* dictionary) const {
+    thread_local Inflater inflater;
+    thread_local std::string stored;
+    thread_local std::string inflated;
+    for (const auto& [index, record] : candidates) {
+        if (body.empty()) return index;
+        const std::string name = segmentName(directory_, record.segment);
+        std::ifstream file(name, std::ios::binary);
+        stored.resize(record.storedSize);
+        file.seekg(static_cast<std::streamoff>(record.offset + sizeof(SegmentRecordHeader)));
+        if (!file.read(stored.data(), static_cast<std::streamsize>(stored.size()))) {
+            throw std::runtime_error("Failed to read page store segment: " + name);
+        }
+        inflated.resize(record.rawSize);
+        const std::string_view preset = (record.flags & PageRecord::DICTIONARY) && dictionary
+                                            ? std::string_view(*dictionary) : std::string_view();
+        if (inflater.decompress(stored, preset, inflated) && inflated == body) return index;
+    }
+    return std::nullopt;
+}
+
+// Keeps the first bodies until there are enough to train the dictionary on. An empty
+// dictionary (nothing shared) also ends sampling
+void PageStoreWriter::sampleLocked(std::string_view body) {
+    if (dictionary_ || options_.dictionarySize == 0) return;
+    samples_.emplace_back(body);
+    if (samples_.size() < options_.dictionarySamples) return;
+    dictionary_ = std::make_shared<const std::string>(
+        trainDictionary(samples_, std::min<size_t>(options_.dictionarySize, 32 * 1024)));
+    std::vector<std::string>().swap(samples_);
+}
+
+uint32_t PageStoreWriter::appendLocked(uint64_t hash, size_t rawSize, bool withDictionary,
+                                       const std::string& compressed) {
+    const size_t recordSize = sizeof(SegmentRecordHeader) + compressed.size();
+    if (segmentOffset_ > 0 && segmentOffset_ + recordSize > options_.maxSegmentSize) {
+        openNextSegmentLocked();
+    }
+
+    SegmentRecordHeader header{};
+    std::memcpy(header.magic, RECORD_MAGIC, sizeof(RECORD_MAGIC));
+    header.flags = withDictionary ? PageRecord::DICTIONARY : 0;
+    header.contentHash = hash;
+    header.rawSize = rawSize;
+    header.storedSize = compressed.size();
+    if (std::fwrite(&header, sizeof(header), 1, segment_) != 1 ||
+        std::fwrite(compressed.data(), 1, compressed.size(), segment_) != compressed.size()) {
+        throw std::runtime_error("Failed to write page store segment: " + segmentName(directory_, segmentNumber_));
+    }
+
+    const auto index = static_cast<uint32_t>(records_.size());
+    records_.push_back({hash, rawSize, segmentNumber_, header.flags, segmentOffset_, compressed.size()});
+    recordsByHash_.emplace(hash, index);
+    segmentOffset_ += recordSize;
+    return index;
+}
+
+void PageStoreWriter::openNextSegmentLocked() {
+    if (segment_) {
+        std::fclose(segment_);
+        ++segmentNumber_;
+    }
+    const std::string name = segmentName(directory_, segmentNumber_);
+    segment_ = std::fopen(name.c_str(), "wb");
+    if (!segment_) {
+        throw std::runtime_error("Failed to open page store segment: " + name);
+    }
+    segmentOffset_ = 0;
+}
+
+void PageStoreWriter::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) return;
+    closed_ = true;
+    if (segment_ && std::fclose(segment_) != 0) {
+        segment_ = nullptr;
+        throw std::runtime_error("Failed to write page store segment: " + segmentName(directory_, segmentNumber_));
+    }
+    segment_ = nullptr;
+    writeIndexLocked();
+}
+
+void PageStoreWriter::writeIndexLocked() {
+    size_t slotCount = 16;
+    while (slotCount < 2 * urls_.size()) slotCount *= 2;
+    std::vector<PageStore::Slot> slots(slotCount, {0, 0, 0, PageStore::Slot::EMPTY});
+    std::string urlData;
+    for (const auto& [url, record] : urls_) {
+        const uint64_t hash = UrlStateStore::hashContent(url);
+        size_t slot = hash & (slotCount - 1);
+        while (slots[slot].record != PageStore::Slot::EMPTY) slot = (slot + 1) & (slotCount - 1);
+        slots[slot] = {hash, urlData.size(), static_cast<uint32_t>(url.size()), record};
+        urlData += url;
+    }
+    const std::string_view dictionary = dictionary_ ? std::string_view(*dictionary_) : std::string_view();
+
+    IndexFileHeader header{};
+    std::memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    header.version = INDEX_VERSION;
+    header.segmentCount = segmentNumber_ + 1;
+    header.recordCount = records_.size();
+    header.slotCount = slotCount;
+    header.urlCount = urls_.size();
+    header.recordsPos = alignUp(sizeof(IndexFileHeader));
+    header.slotsPos = alignUp(header.recordsPos + records_.size() * sizeof(PageRecord));
+    header.urlDataPos = alignUp(header.slotsPos + slotCount * sizeof(PageStore::Slot));
+    header.urlDataSize = urlData.size();
+    header.dictionaryPos = alignUp(header.urlDataPos + urlData.size());
+    header.dictionarySize = dictionary.size();
+
+    const std::string filename = indexName(directory_);
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("Failed to open page store index: " + filename);
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    writePadding(file, sizeof(header), header.recordsPos);
+    file.write(reinterpret_cast<const char*>(records_.data()),
+               static_cast<std::streamsize>(records_.size() * sizeof(PageRecord)));
+    writePadding(file, header.recordsPos + records_.size() * sizeof(PageRecord), header.slotsPos);
+    file.write(reinterpret_cast<const char*>(slots.data()),
+               static_cast<std::streamsize>(slots.size() * sizeof(PageStore::Slot)));
+    writePadding(file, header.slotsPos + slots.size() * sizeof(PageStore::Slot), header.urlDataPos);
+    file.write(urlData.data(), static_cast<std::streamsize>(urlData.size()));
+    writePadding(file, header.urlDataPos + urlData.size(), header.dictionaryPos);
+    file.write(dictionary.data(), static_cast<std::streamsize>(dictionary.size()));
+    file.close();
+    if (!file) {
+        throw std::runtime_error("Failed to write page store index: " + filename);
+    }
+}
+
+PageStoreWriter::Stats PageStoreWriter::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.pages = urls_.size();
+    stats.bodies = records_.size();
+    stats.rawBytes = rawBytes_;
+    for (const auto& record : records_) {
+        stats.storedBytes += sizeof(SegmentRecordHeader) + record.storedSize;
+    }
+    return stats;
+}
+
+PageStore::PageStore() = default;
+PageStore::~PageStore() = default;
+PageStore::PageStore(PageStore&&) noexcept = default;
+PageStore& PageStore::operator=(PageStore&&) noexcept = default;
+
+PageStore PageStore::open(const std::string& directory) {
+    const std::string filename = indexName(directory);
+    auto mapped = std::make_unique<MappedFile>(filename);
+    const char* base = mapped->data();
+    const size_t size = mapped->size();
+
+    IndexFileHeader header{};
+    if (size < sizeof(header)) {
+        throw std::runtime_error("Page store index is truncated: " + filename);
+    }
+    std::memcpy(&header, base, sizeof(header));
+
+    if (std::memcmp(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 || header.version != INDEX_VERSION) {
+        throw std::runtime_error("Not a page store index: " + filename);
+    }
+    if (header.slotCount == 0 || (header.slotCount & (header.slotCount - 1)) != 0 ||
+        header.urlCount >= header.slotCount) {
+        throw std::runtime_error("Page store index is corrupt: " + filename);
+    }
+    if (!fitsIn(header.recordsPos, header.recordCount, sizeof(PageRecord), size) ||
+        !fitsIn(header.slotsPos, header.slotCount, sizeof(Slot), size) ||
+        !fitsIn(header.urlDataPos, header.urlDataSize, 1, size) ||
+        !fitsIn(header.dictionaryPos, header.dictionarySize, 1, size)) {
+        throw std::runtime_error("Page store index is truncated: " + filename);
+    }
+    // The arrays are viewed in place, which needs them aligned like the writer leaves them
+    if (header.recordsPos % alignof(PageRecord) != 0 || header.slotsPos % alignof(Slot) != 0 ||
+        reinterpret_cast<uintptr_t>(base) % alignof(PageRecord) != 0) {
+        throw std::runtime_error("Page store index is corrupt: " + filename);
+    }
+
+    PageStore store;
+    store.records_ = {reinterpret_cast<const PageRecord*>(base + header.recordsPos), header.recordCount};
+    store.slots_ = {reinterpret_cast<const Slot*>(base + header.slotsPos), header.slotCount};
+    store.urlData_ = std::string_view(base + header.urlDataPos, header.urlDataSize);
+    store.dictionary_ = std::string_view(base + header.dictionaryPos, header.dictionarySize);
+    store.urlCount_ = header.urlCount;
+    store.segments_.reserve(header.segmentCount);
+    for (uint32_t segment = 0; segment < header.segmentCount; ++segment) {
+        store.segments_.emplace_back(segmentName(directory, segment));
+    }
+    store.index_ = std::move(mapped);
+    return store;
+}
+
+// Slot contents are only checked when they are used, which keeps open() O(1). A slot
+// pointing outside the index throws rather than reading past it
+std::string_view PageStore::slotUrl(const Slot& slot) const {
+    if (slot.record >= records_.size() || slot.urlOffset > urlData_.size() ||
+        slot.urlLength > urlData_.size() - slot.urlOffset) {
+        throw std::runtime_error("Page store index is corrupt: slot out of bounds");
+    }
+    return urlData_.substr(slot.urlOffset, slot.urlLength);
+}
+
+const PageRecord* PageStore::find(std::string_view url) const {
+    if (slots_.empty()) return nullptr;
+    const uint64_t hash = UrlStateStore::hashContent(url);
+    const size_t mask = slots_.size() - 1;
+    // Bounded, so a corrupt table with no free slot cannot loop forever
+    size_t slot = hash & mask;
+    for (size_t probe = 0; probe < slots_.size(); ++probe, slot = (slot + 1) & mask) {
+        const Slot& entry = slots_[slot];
+        if (entry.record == Slot::EMPTY) return nullptr;
+        if (entry.urlHash == hash && slotUrl(entry) == url) {
+            return &records_[entry.record];
+        }
+    }
+    return nullptr;
+}
+
+std::optional<PageRecord> PageStore::record(std::string_view url) const {
+    const PageRecord* record = find(url);
+    if (!record) return std::nullopt;
+    return *record;
+}
+
+std::optional<std::string> PageStore::get(std::string_view url) const {
+    const PageRecord* record = find(url);
+    if (!record) return std::nullopt;
+
+    SegmentRecordHeader header{};
+    const MappedFile* segment = record->segment < segments_.size() ? &segments_[record->segment] : nullptr;
+    if (!segment || !fitsIn(record->offset, 1, sizeof(header), segment->size()) ||
+        !fitsIn(record->offset + sizeof(header), record->storedSize, 1, segment->size())) {
+        throw std::runtime_error("Page store record is out of bounds: " + std::string(url));
+    }
+    std::memcpy(&header, segment->data() + record->offset, sizeof(header));
+    if (std::memcmp(header.magic, RECORD_MAGIC, sizeof(RECORD_MAGIC)) != 0 ||
+        header.contentHash != record->contentHash || header.storedSize != record->storedSize) {
+        throw std::runtime_error("Page store record is corrupt: " + std::string(url));
+    }
+
+    std::string body(record->rawSize, '\0');
+    if (body.empty()) return body;
+    thread_local Inflater inflater;
+    const std::string_view data(segment->data() + record->offset + sizeof(header), record->storedSize);
+    if (!inflater.decompress(data, (record->flags & PageRecord::DICTIONARY) ? dictionary_ : std::string_view(), body)) {
+        throw std::runtime_error("Page store record does not decompress: " + std::string(url));
+    }
+    return body;
+}
+
+std::vector<std::string_view> PageStore::urls() const {
+    std::vector<std::string_view> urls;
+    urls.reserve(urlCount_);
+    for (const auto& slot : slots_) {
+        if (slot.record != Slot::EMPTY) urls.push_back(slotUrl(slot));
+    }
+    return urls;
+}
@@ -0,0 +1,155 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class MappedFile;
+
+// Where one stored body lives: its segment record, which holds a small header and the
+// deflated bytes. Also the on-disk form of an index entry
+struct PageRecord {
+    static constexpr uint32_t DICTIONARY = 1;  // Deflated with the store's preset dictionary
+
+    uint64_t contentHash;
+    uint64_t rawSize;
+    uint32_t segment;
+    uint32_t flags;
+    uint64_t offset;
+    uint64_t storedSize;
+};
+
+// Writes fetched bodies to a directory as a content-addressed page store. Each distinct
+// body is deflated once into an append-only segment file (segment-NNNNN.pages, rotated at
+// maxSegmentSize); further URLs with the same body only add an index entry. Bodies are
+// looked up by content hash and length, and a match is read back and compared byte for
+// byte before it is shared, since the 64-bit hash is not collision-resistant. Small HTML
+// pages compress poorly alone, so once dictionarySamples bodies have been seen a preset
+// dictionary is built from the lines they share and used for every later body. close()
+// writes the index read by PageStore.
+class PageStoreWriter
+{
+public:
+    struct Options {
+        size_t maxSegmentSize = 1024ull * 1024 * 1024;
+        int compressionLevel = 6;
+        size_t dictionarySize = 32 * 1024;  // Deflate looks back at most 32 KiB; 0 = no dictionary
+        size_t dictionarySamples = 128;
+    };
+
+    struct Stats {
+        size_t pages = 0;        // URLs stored
+        size_t bodies = 0;       // Distinct bodies written
+        uint64_t rawBytes = 0;   // Body bytes passed to put()
+        uint64_t storedBytes = 0;
+    };
+
+    // Creates the directory if needed; an existing store in it is replaced
+    PageStoreWriter(std::string directory, const Options& options);
+    explicit PageStoreWriter(std::string directory) : PageStoreWriter(std::move(directory), Options{}) {}
+    ~PageStoreWriter();
+
+    PageStoreWriter(const PageStoreWriter&) = delete;
+    PageStoreWriter& operator=(const PageStoreWriter&) = delete;
+
+    // Thread-safe. Compression happens on the calling thread, outside the lock. Storing a
+    // URL again points it at the new body
+    void put(std::string_view url, std::string_view body);
+    // Points url at the body stored for storedUrl, as another name for it (a redirect's
+    // source and target). Counts no body bytes. False if storedUrl is not in the store
+    bool alias(std::string_view url, std::string_view storedUrl);
+    void close();
+
+    [[nodiscard]] Stats stats() const;
+
+private:
+    // A stored body that may equal a new one: same content hash and length
+    struct Candidate {
+        uint32_t index;
+        PageRecord record;
+    };
+
+    std::string directory_;
+    Options options_;
+
+    mutable std::mutex mutex_;
+    std::FILE* segment_ = nullptr;
+    uint32_t segmentNumber_ = 0;
+    uint64_t segmentOffset_ = 0;
+    std::vector<PageRecord> records_;
+    std::unordered_multimap<uint64_t, uint32_t> recordsByHash_;
+    std::unordered_map<std::string, uint32_t> urls_;
+    std::vector<std::string> samples_;
+    std::shared_ptr<const std::string> dictionary_;  // Null until trained
+    uint64_t rawBytes_ = 0;
+    bool closed_ = false;
+
+    std::vector<Candidate> candidatesLocked(uint64_t hash, size_t size, size_t fromRecord);
+    std::optional<uint32_t> findMatch(const std::vector<Candidate>& candidates, std::string_view body,
+                                      const std::string* dictionary) const;
+    void sampleLocked(std::string_view body);
+    uint32_t appendLocked(uint64_t hash, size_t rawSize, bool withDictionary, const std::string& compressed);
+    void openNextSegmentLocked();
+    void writeIndexLocked();
+};
+
+// Read side of a page store: the index is mapped and used in place, so opening is O(1)
+// in the number of pages and a lookup costs one hash probe sequence plus the inflate of
+// one body, read straight from the mapped segment. Immutable and thread-safe.
+class PageStore
+{
+public:
+    PageStore();
+    ~PageStore();
+    PageStore(PageStore&&) noexcept;
+    PageStore& operator=(PageStore&&) noexcept;
+
+    // Throws std::runtime_error if the directory holds no complete store
+    static PageStore open(const std::string& directory);
+
+    [[nodiscard]] size_t pageCount() const { return urlCount_; }
+    [[nodiscard]] size_t bodyCount() const { return records_.size(); }
+
+    [[nodiscard]] bool contains(std::string_view url) const { return find(url) != nullptr; }
+    // Where the body of url is stored; its contentHash is shared by every URL with that body
+    [[nodiscard]] std::optional<PageRecord> record(std::string_view url) const;
+    // The decompressed body stored for url; nullopt if the URL is not in the store.
+    // Throws std::runtime_error if its index entry or segment record is damaged
+    [[nodiscard]] std::optional<std::string> get(std::string_view url) const;
+    // Every stored URL, in index order
+    [[nodiscard]] std::vector<std::string_view> urls() const;
+
+private:
+    friend class PageStoreWriter;
+
+    // Open-addressing hash table entry from URL to record; record is EMPTY for a free slot
+    struct Slot {
+        static constexpr uint32_t EMPTY = UINT32_MAX;
+
+        uint64_t urlHash;
+        uint64_t urlOffset;
+        uint32_t urlLength;
+        uint32_t record;
+    };
+
+    std::unique_ptr<MappedFile> index_;
+    std::vector<MappedFile> segments_;
+    std::span<const PageRecord> records_;
+    std::span<const Slot> slots_;
+    std::string_view urlData_;
+    std::string_view dictionary_;
+    size_t urlCount_ = 0;
+
+    [[nodiscard]] std::string_view slotUrl(const Slot& slot) const;
+    [[nodiscard]] const PageRecord* find(std::string_view url) const;
+};
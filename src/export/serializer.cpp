@@ -0,0 +1,144 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#include "serializer.h"
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SERIALIZER_HAVE_SSE2 1
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+    bool needsJsonEscape(unsigned char c) {
+        return c < 0x20 || c == '"' || c == '\\';
+    }
+
+#ifdef SERIALIZER_HAVE_SSE2
+    unsigned firstSetBit(unsigned mask) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return static_cast<unsigned>(index);
+#else
+        return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+    }
+#endif
+}
+
+size_t Serializer::findJsonEscape(std::string_view value) {
+    const char* data = value.data();
+    const size_t size = value.size();
+    size_t i = 0;
+
+#ifdef SERIALIZER_HAVE_SSE2
+    // 16 bytes per step: flag quotes, backslashes and bytes below 0x20 (top three bits clear)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i highBits = _mm_set1_epi8(static_cast<char>(0xE0));
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; i + 16 <= size; i += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m128i hits = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+            _mm_cmpeq_epi8(_mm_and_si128(chunk, highBits), zero));
+        const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hits));
+        if (mask != 0) {
+            return i + firstSetBit(mask);
+        }
+    }
+#endif
+
+    for (; i < size; ++i) {
+        if (needsJsonEscape(static_cast<unsigned char>(data[i]))) return i;
+    }
+    return size;
+}
+
+void Serializer::appendJsonString(std::string& out, std::string_view value) {
+    static constexpr char hex[] = "0123456789abcdef";
+    out += '"';
+
+    while (!value.empty()) {
+        // Copy the clean run in one go, then escape the byte that stopped it
+        const size_t clean = findJsonEscape(value);
+        out.append(value.data(), clean);
+        if (clean == value.size()) break;
+
+        const auto c = static_cast<unsigned char>(value[clean]);
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            default:
+                out += "\\u00";
+                out += hex[c >> 4];
+                out += hex[c & 0xF];
+        }
+        value.remove_prefix(clean + 1);
+    }
+
+    out += '"';
+}
+
+void Serializer::appendCsvField(std::string& out, std::string_view value) {
+    out += '"';
+    while (!value.empty()) {
+        const void* quote = std::memchr(value.data(), '"', value.size());
+        if (!quote) {
+            out.append(value.data(), value.size());
+            break;
+        }
+        const size_t run = static_cast<const char*>(quote) - value.data() + 1;
+        out.append(value.data(), run);
+        out += '"';
+        value.remove_prefix(run);
+    }
+    out += '"';
+}
+
+BlockWriter::BlockWriter(const std::string& filename, size_t blockSize)
+    : filename_(filename), blockSize_(blockSize) {
+    file_ = std::fopen(filename.c_str(), "wb");
+    if (!file_) {
+        throw std::runtime_error("Failed to open export file: " + filename);
+    }
+    std::setvbuf(file_, nullptr, _IONBF, 0);
+    buffer_.reserve(blockSize_ + blockSize_ / 4);
+}
+
+BlockWriter::~BlockWriter() {
+    try {
+        close();
+    } catch (const std::exception&) {
+        // Destructors must not throw; call close() directly to see write errors
+    }
+}
+
+void BlockWriter::flush() {
+    if (buffer_.empty() || !file_) return;
+    if (std::fwrite(buffer_.data(), 1, buffer_.size(), file_) != buffer_.size()) {
+        throw std::runtime_error("Failed to write export file: " + filename_);
+    }
+    bytesWritten_ += buffer_.size();
+    buffer_.clear();
+}
+
+void BlockWriter::close() {
+    if (!file_) return;
+    flush();
+    std::fclose(file_);
+    file_ = nullptr;
+}
@@ -0,0 +1,70 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#pragma once
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Appends JSON and CSV tokens to a caller-owned byte buffer. Shared by every exporter
+// so escaping is done the same way everywhere.
+class Serializer
+{
+public:
+    // Quoted JSON string; escapes '"', '\' and control characters
+    static void appendJsonString(std::string& out, std::string_view value);
+    // Quoted CSV field; embedded quotes are doubled
+    static void appendCsvField(std::string& out, std::string_view value);
+
+    // NaN and infinity have no JSON spelling, so they are written as null
+    template <typename T>
+    static void appendNumber(std::string& out, T value) {
+        static_assert(std::is_arithmetic_v<T>);
+        if constexpr (std::is_floating_point_v<T>) {
+            if (!std::isfinite(value)) {
+                out += "null";
+                return;
+            }
+        }
+        char digits[32];
+        const auto [end, error] = std::to_chars(digits, digits + sizeof(digits), value);
+        out.append(digits, end);
+    }
+
+    static void appendBool(std::string& out, bool value) { out += value ? "true" : "false"; }
+
+    // Offset of the first byte in value that needs JSON escaping, or value.size()
+    static size_t findJsonEscape(std::string_view value);
+};
+
+// Buffered file output for exporters: callers serialize into buffer() and call
+// commit(), which writes the buffer out in one block once it passes blockSize.
+class BlockWriter
+{
+public:
+    explicit BlockWriter(const std::string& filename, size_t blockSize = 1 << 20);
+    ~BlockWriter();
+
+    BlockWriter(const BlockWriter&) = delete;
+    BlockWriter& operator=(const BlockWriter&) = delete;
+
+    [[nodiscard]] std::string& buffer() { return buffer_; }
+    void commit() {
+        if (buffer_.size() >= blockSize_) flush();
+    }
+    void flush();
+    void close();
+
+    [[nodiscard]] size_t bytesWritten() const { return bytesWritten_; }
+
+private:
+    std::FILE* file_ = nullptr;
+    std::string filename_;
+    std::string buffer_;
+    size_t blockSize_;
+    size_t bytesWritten_ = 0;
+};
@@ -0,0 +1,195 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#include "streamexport.h"
+#include "serializer.h"
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+StreamingExport::StreamingExport(const std::string& filename, const Options& options)
+    : options_(options) {
+    file_ = std::fopen(filename.c_str(), "wb");
+    if (!file_) {
+        throw std::runtime_error("Failed to open export file: " + filename);
+    }
+    // Writes are already batched into large buffers
+    std::setvbuf(file_, nullptr, _IONBF, 0);
+
+    active_.reserve(options_.bufferSize);
+    if (options_.format == Format::Csv) {
+        active_ += "URL,Status Code,Success,Links Found,Content Length,Error\n";
+    }
+
+    writer_ = std::thread(&StreamingExport::writerLoop, this);
+}
+
+StreamingExport::~StreamingExport() {
+    close();
+}
+
+StreamingExport::Format StreamingExport::formatForFile(const std::string& filename) {
+    const std::string extension = ".csv";
+    if (filename.size() >= extension.size() &&
+        filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0) {
+        return Format::Csv;
+    }
+    return Format::JsonLines;
+}
+
+void StreamingExport::write(const WebCrawler::CrawlResult& result) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (closing_) return;
+
+    appendRecord(active_, result);
+    ++records_;
+
+    if (active_.size() >= options_.bufferSize) {
+        // Backpressure: never queue more than maxPendingBuffers for the writer
+        producerCv_.wait(lock, [this] { return pending_.size() < options_.maxPendingBuffers || closing_; });
+
+        pending_.push_back(std::move(active_));
+        if (!spare_.empty()) {
+            active_ = std::move(spare_.front());
+            spare_.pop_front();
+        } else {
+            active_ = std::string();
+            active_.reserve(options_.bufferSize);
+        }
+        writerCv_.notify_one();
+    }
+}
+
+void StreamingExport::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closing_) return;
+        closing_ = true;
+    }
+    writerCv_.notify_one();
+    producerCv_.notify_all();
+
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+    if (file_) {
+        syncFile();
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+size_t StreamingExport::recordsWritten() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return records_;
+}
+
+void StreamingExport::appendRecord(std::string& out, const WebCrawler::CrawlResult& result) const {
+    if (options_.format == Format::Csv) {
+        Serializer::appendCsvField(out, result.url);
+        out += ',';
+        Serializer::appendNumber(out, result.statusCode);
+        out += ',';
+        Serializer::appendBool(out, result.success);
+        out += ',';
+        Serializer::appendNumber(out, result.linksFound());
+        out += ',';
+        Serializer::appendNumber(out, result.contentSize());
+        out += ',';
+        Serializer::appendCsvField(out, result.errorMessage);
+        out += '\n';
+        return;
+    }
+
+    out += "{\"url\":";
+    Serializer::appendJsonString(out, result.url);
+    out += ",\"status_code\":";
+    Serializer::appendNumber(out, result.statusCode);
+    out += ",\"success\":";
+    Serializer::appendBool(out, result.success);
+    out += ",\"links_found\":";
+    Serializer::appendNumber(out, result.linksFound());
+    out += ",\"content_length\":";
+    Serializer::appendNumber(out, result.contentSize());
+    if (!result.redirects.empty()) {
+        out += ",\"redirects\":[";
+        for (size_t i = 0; i < result.redirects.size(); ++i) {
+            const auto& redirect = result.redirects[i];
+            out += i == 0 ? "{\"from\":" : ",{\"from\":";
+            Serializer::appendJsonString(out, redirect.from);
+            out += ",\"to\":";
+            Serializer::appendJsonString(out, redirect.to);
+            out += ",\"status_code\":";
+            Serializer::appendNumber(out, redirect.statusCode);
+            out += '}';
+        }
+        out += ']';
+    }
+    if (!result.errorMessage.empty()) {
+        out += ",\"error\":";
+        Serializer::appendJsonString(out, result.errorMessage);
+    }
+    out += "}\n";
+}
+
+void StreamingExport::writerLoop() {
+    auto lastSync = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (true) {
+        writerCv_.wait_for(lock, options_.syncInterval, [this] { return !pending_.empty() || closing_; });
+
+        // On a quiet interval, push out the partial buffer so readers see recent records
+        const bool intervalElapsed = std::chrono::steady_clock::now() - lastSync >= options_.syncInterval;
+        if ((intervalElapsed || closing_) && !active_.empty()) {
+            pending_.push_back(std::move(active_));
+            active_ = std::string();
+            active_.reserve(options_.bufferSize);
+        }
+
+        while (!pending_.empty()) {
+            std::string buffer = std::move(pending_.front());
+            pending_.pop_front();
+            producerCv_.notify_all();
+
+            lock.unlock();
+            writeBuffer(buffer);
+            buffer.clear();
+            lock.lock();
+
+            if (spare_.size() < options_.maxPendingBuffers) {
+                spare_.push_back(std::move(buffer));
+            }
+        }
+
+        if (intervalElapsed) {
+            lock.unlock();
+            syncFile();
+            lock.lock();
+            lastSync = std::chrono::steady_clock::now();
+        }
+
+        if (closing_ && pending_.empty() && active_.empty()) break;
+    }
+}
+
+void StreamingExport::writeBuffer(const std::string& buffer) {
+    if (buffer.empty()) return;
+    if (std::fwrite(buffer.data(), 1, buffer.size(), file_) != buffer.size()) {
+        std::perror("StreamingExport write failed");
+    }
+}
+
+void StreamingExport::syncFile() {
+    std::fflush(file_);
+#ifdef _WIN32
+    _commit(_fileno(file_));
+#else
+    ::fsync(fileno(file_));
+#endif
+}
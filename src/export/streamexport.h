@@ -0,0 +1,68 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#pragma once
+#include "../crawler/webcrawler.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Appends one record per crawl result while the crawl runs. Records are formatted
+// into a buffer on the calling thread; full buffers are handed to a writer thread
+// that issues large writes and syncs to disk periodically. Memory stays bounded by
+// a few buffers however long the crawl runs.
+class StreamingExport
+{
+public:
+    enum class Format { JsonLines, Csv };
+
+    struct Options {
+        Format format = Format::JsonLines;
+        size_t bufferSize = 1 << 20;
+        // At most this many full buffers wait for the writer before write() blocks
+        size_t maxPendingBuffers = 4;
+        // Partial buffers are flushed and the file synced at least this often
+        std::chrono::milliseconds syncInterval{1000};
+    };
+
+    StreamingExport(const std::string& filename, const Options& options);
+    explicit StreamingExport(const std::string& filename) : StreamingExport(filename, Options{}) {}
+    ~StreamingExport();
+
+    StreamingExport(const StreamingExport&) = delete;
+    StreamingExport& operator=(const StreamingExport&) = delete;
+
+    // Thread-safe
+    void write(const WebCrawler::CrawlResult& result);
+    // Flushes everything, syncs and stops the writer thread
+    void close();
+
+    [[nodiscard]] size_t recordsWritten() const;
+
+    // Picks CSV for a .csv filename, JSON Lines otherwise
+    static Format formatForFile(const std::string& filename);
+
+private:
+    Options options_;
+    std::FILE* file_ = nullptr;
+
+    mutable std::mutex mutex_;
+    std::condition_variable writerCv_;
+    std::condition_variable producerCv_;
+    std::string active_;
+    std::deque<std::string> pending_;
+    std::deque<std::string> spare_;
+    size_t records_ = 0;
+    bool closing_ = false;
+    std::thread writer_;
+
+    void appendRecord(std::string& out, const WebCrawler::CrawlResult& result) const;
+    void writerLoop();
+    void writeBuffer(const std::string& buffer);
+    void syncFile();
+};
@@ -0,0 +1,324 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#include "warcwriter.h"
+#include "../crawler/urlparser.h"
+#include <algorithm>
+#include <ctime>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string_view>
+#include <zlib.h>
+
+namespace {
+    // Compresses a sequence of buffers into one gzip member, appended to out. Input is
+    // fed to zlib straight from the caller's buffers, so bodies are never concatenated
+    class GzipMember
+    {
+    public:
+        explicit GzipMember(int level) : level_(level) {
+            if (deflateInit2(&stream_, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+                throw std::runtime_error("Failed to initialize zlib");
+            }
+        }
+        ~GzipMember() { deflateEnd(&stream_); }
+
+        GzipMember(const GzipMember&) = delete;
+        GzipMember& operator=(const GzipMember&) = delete;
+
+        void begin(std::string& out) {
+            deflateReset(&stream_);
+            out_ = &out;
+        }
+
+        [[nodiscard]] int level() const { return level_; }
+
+        void add(std::string_view data) { deflateChunk(data, Z_NO_FLUSH); }
+        void finish() { deflateChunk({}, Z_FINISH); }
+
+    private:
+        z_stream stream_{};
+        int level_;
+        std::string* out_ = nullptr;
+
+        void deflateChunk(std::string_view data, int flush) {
+            stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+            stream_.avail_in = static_cast<uInt>(data.size());
+
+            int status;
+            do {
+                const size_t used = out_->size();
+                const size_t room = std::max<size_t>(deflateBound(&stream_, stream_.avail_in), 16 * 1024);
+                out_->resize(used + room);
+                stream_.next_out = reinterpret_cast<Bytef*>(out_->data() + used);
+                stream_.avail_out = static_cast<uInt>(room);
+
+                status = deflate(&stream_, flush);
+                out_->resize(used + room - stream_.avail_out);
+            } while (stream_.avail_in > 0 || (flush == Z_FINISH && status != Z_STREAM_END));
+        }
+    };
+
+    std::string recordId() {
+        thread_local std::mt19937_64 rng{std::random_device{}()};
+        const uint64_t high = rng();
+        const uint64_t low = rng();
+
+        // Random (version 4) UUID
+        char uuid[37];
+        std::snprintf(uuid, sizeof(uuid), "%08x-%04x-4%03x-%04x-%012llx",
+                      static_cast<unsigned>(high >> 32), static_cast<unsigned>((high >> 16) & 0xFFFF),
+                      static_cast<unsigned>(high & 0x0FFF), static_cast<unsigned>(((low >> 48) & 0x3FFF) | 0x8000),
+                      static_cast<unsigned long long>(low & 0xFFFFFFFFFFFFull));
+        return std::string("<urn:uuid:") + uuid + ">";
+    }
+
+    std::tm toUtc(std::chrono::system_clock::time_point time) {
+        const std::time_t seconds = std::chrono::system_clock::to_time_t(time);
+        std::tm utc{};
+#ifdef _WIN32
+        gmtime_s(&utc, &seconds);
+#else
+        gmtime_r(&seconds, &utc);
+#endif
+        return utc;
+    }
+
+    std::string warcDate(std::chrono::system_clock::time_point time) {
+        const std::tm utc = toUtc(time);
+        char buffer[32];
+        std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &utc);
+        return buffer;
+    }
+
+    std::string cdxTimestamp(std::chrono::system_clock::time_point time) {
+        const std::tm utc = toUtc(time);
+        char buffer[16];
+        std::strftime(buffer, sizeof(buffer), "%Y%m%d%H%M%S", &utc);
+        return buffer;
+    }
+
+    // SURT-style sort key: "https://www.Example.com/a?b" -> "com,example,www)/a?b"
+    std::string surtKey(const std::string& url) {
+        const auto parsed = UrlParser::parse(url);
+        if (!parsed.valid) return url;
+
+        std::string host = parsed.host;
+        std::transform(host.begin(), host.end(), host.begin(), ::tolower);
+
+        std::string key;
+        if (host.find_first_not_of("0123456789.") == std::string::npos) {
+            key = host;  // IP addresses are not reversed
+        } else {
+            size_t end = host.size();
+            while (true) {
+                const size_t dot = host.rfind('.', end - 1);
+                const size_t start = dot == std::string::npos ? 0 : dot + 1;
+                if (!key.empty()) key += ',';
+                key.append(host, start, end - start);
+                if (dot == std::string::npos || dot == 0) break;
+                end = dot;
+            }
+        }
+        if (parsed.port != -1 && parsed.port != (parsed.scheme == "https" ? 443 : 80)) {
+            key += ':' + std::to_string(parsed.port);
+        }
+        key += ')';
+        key += parsed.path;
+        if (!parsed.query.empty()) {
+            key += '?';
+            key += parsed.query;
+        }
+        return key;
+    }
+
+    std::string headerValue(const std::string& rawHeaders, const std::string& name) {
+        size_t lineStart = 0;
+        while (lineStart < rawHeaders.size()) {
+            size_t lineEnd = rawHeaders.find('\n', lineStart);
+            if (lineEnd == std::string::npos) lineEnd = rawHeaders.size();
+            const std::string_view line(rawHeaders.data() + lineStart, lineEnd - lineStart);
+
+            if (line.size() > name.size() && line[name.size()] == ':' &&
+                std::equal(name.begin(), name.end(), line.begin(),
+                           [](char a, char b) { return ::tolower(a) == ::tolower(b); })) {
+                std::string_view value = line.substr(name.size() + 1);
+                while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+                while (!value.empty() && (value.back() == '\r' || value.back() == ' ')) value.remove_suffix(1);
+                return std::string(value);
+            }
+            lineStart = lineEnd + 1;
+        }
+        return "";
+    }
+
+    std::string recordHeader(const std::string& type, const std::string& id, const std::string& date,
+                             const std::string& targetUri, const std::string& contentType,
+                             size_t contentLength, const std::string& extra) {
+        std::string header = "WARC/1.1\r\nWARC-Type: " + type + "\r\nWARC-Record-ID: " + id +
+                             "\r\nWARC-Date: " + date + "\r\n";
+        if (!targetUri.empty()) header += "WARC-Target-URI: " + targetUri + "\r\n";
+        header += extra;
+        header += "Content-Type: " + contentType + "\r\nContent-Length: " + std::to_string(contentLength) + "\r\n\r\n";
+        return header;
+    }
+}
+
+WarcWriter::WarcWriter(std::string prefix, const Options& options)
+    : prefix_(std::move(prefix)), options_(options) {
+    index_ = std::fopen((prefix_ + ".cdx").c_str(), "wb");
+    if (!index_) {
+        throw std::runtime_error("Failed to open WARC index: " + prefix_ + ".cdx");
+    }
+    std::fputs(" CDX N b a m s k r M S V g\n", index_);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    openNextFileLocked();
+}
+
+WarcWriter::~WarcWriter() {
+    close();
+}
+
+void WarcWriter::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+    if (index_) {
+        std::fclose(index_);
+        index_ = nullptr;
+    }
+}
+
+size_t WarcWriter::recordsWritten() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return records_;
+}
+
+void WarcWriter::openNextFileLocked() {
+    if (file_) {
+        std::fclose(file_);
+    }
+
+    char suffix[32];
+    std::snprintf(suffix, sizeof(suffix), "-%05zu.warc.gz", fileNumber_++);
+    currentName_ = prefix_ + suffix;
+    file_ = std::fopen(currentName_.c_str(), "wb");
+    if (!file_) {
+        throw std::runtime_error("Failed to open WARC file: " + currentName_);
+    }
+    fileOffset_ = 0;
+
+    // Each file opens with a warcinfo record describing the crawler
+    const std::string fields = "software: WebCrawler/1.0\r\nformat: WARC File Format 1.1\r\n"
+                               "http-header-user-agent: " + options_.userAgent + "\r\n";
+    const std::string name = currentName_.substr(currentName_.find_last_of("/\\") + 1);
+    const std::string header = recordHeader("warcinfo", recordId(), warcDate(std::chrono::system_clock::now()), "",
+                                            "application/warc-fields", fields.size(),
+                                            "WARC-Filename: " + name + "\r\n");
+
+    std::string compressed;
+    GzipMember gzip(options_.compressionLevel);
+    gzip.begin(compressed);
+    gzip.add(header);
+    gzip.add(fields);
+    gzip.add("\r\n\r\n");
+    gzip.finish();
+    writeLocked(compressed);
+}
+
+void WarcWriter::writeLocked(const std::string& data) {
+    if (std::fwrite(data.data(), 1, data.size(), file_) != data.size()) {
+        throw std::runtime_error("Failed to write WARC file: " + currentName_);
+    }
+    fileOffset_ += data.size();
+}
+
+void WarcWriter::write(const WebCrawler::CrawlResult& result) {
+    // A chain cut short ends on a hop whose 3xx is the result's own response
+    const std::string& url = result.fetchedUrl();
+    for (const auto& redirect : result.redirects) {
+        if (redirect.responseHeaders.empty() || redirect.from == url) continue;
+        writeExchange(redirect.from, redirect.responseHeaders, std::string(), redirect.fetchTime,
+                      redirect.statusCode, redirect.to);
+    }
+    // Nothing was received, so there is no response to archive
+    if (result.responseHeaders.empty()) return;
+    const bool endsOnHop = !result.redirects.empty() && result.redirects.back().from == url;
+    writeExchange(url, result.responseHeaders, result.content, result.fetchTime, result.statusCode,
+                  endsOnHop ? result.redirects.back().to : std::string());
+}
+
+// One response/request record pair and the response's CDX line; location fills the CDX
+// redirect field
+void WarcWriter::writeExchange(const std::string& url, const std::string& responseHeaders, const std::string& body,
+                               std::chrono::system_clock::time_point fetchTime, int statusCode,
+                               const std::string& location) {
+    thread_local std::string responseMember;
+    thread_local std::string requestMember;
+    responseMember.clear();
+    requestMember.clear();
+
+    const std::string date = warcDate(fetchTime);
+    const std::string responseId = recordId();
+    const std::string requestId = recordId();
+
+    // zlib state is reused per thread; only the output buffers change
+    thread_local std::unique_ptr<GzipMember> compressor;
+    if (!compressor || compressor->level() != options_.compressionLevel) {
+        compressor = std::make_unique<GzipMember>(options_.compressionLevel);
+    }
+    GzipMember& gzip = *compressor;
+
+    // Response record: the HTTP header block and the body, fed to zlib separately
+    const std::string responseHeader = recordHeader(
+        "response", responseId, date, url, "application/http; msgtype=response",
+        responseHeaders.size() + body.size(),
+        "WARC-Concurrent-To: " + requestId + "\r\n");
+    gzip.begin(responseMember);
+    gzip.add(responseHeader);
+    gzip.add(responseHeaders);
+    gzip.add(body);
+    gzip.add("\r\n\r\n");
+    gzip.finish();
+
+    // Request record, reconstructed from what the client sends
+    const auto parsed = UrlParser::parse(url);
+    std::string request = "GET " + (parsed.valid ? parsed.path : std::string("/")) +
+                          (parsed.valid && !parsed.query.empty() ? "?" + parsed.query : std::string()) +
+                          " HTTP/1.1\r\nHost: " + (parsed.valid ? parsed.host : std::string()) +
+                          "\r\nUser-Agent: " + options_.userAgent + "\r\nAccept: */*\r\n\r\n";
+    const std::string requestHeader = recordHeader(
+        "request", requestId, date, url, "application/http; msgtype=request", request.size(),
+        "WARC-Concurrent-To: " + responseId + "\r\n");
+    gzip.begin(requestMember);
+    gzip.add(requestHeader);
+    gzip.add(request);
+    gzip.add("\r\n\r\n");
+    gzip.finish();
+
+    std::string mime = headerValue(responseHeaders, "Content-Type");
+    mime = mime.substr(0, mime.find(';'));
+    if (mime.empty()) mime = "-";
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_) return;
+    if (fileOffset_ > 0 && fileOffset_ + responseMember.size() + requestMember.size() > options_.maxFileSize) {
+        openNextFileLocked();
+    }
+
+    const size_t responseOffset = fileOffset_;
+    writeLocked(responseMember);
+    writeLocked(requestMember);
+    records_ += 2;
+
+    // CDX 11: key, timestamp, URL, MIME, status, digest, redirect, meta tags, size, offset, file
+    const std::string name = currentName_.substr(currentName_.find_last_of("/\\") + 1);
+    std::fprintf(index_, "%s %s %s %s %d - %s - %zu %zu %s\n",
+                 surtKey(url).c_str(), cdxTimestamp(fetchTime).c_str(), url.c_str(), mime.c_str(), statusCode,
+                 location.empty() ? "-" : location.c_str(), responseMember.size(), responseOffset, name.c_str());
+}
@@ -0,0 +1,186 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#include "bfs.h"
+#include "../util/parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+
+namespace {
+    using NodeId = GraphBfs::NodeId;
+
+    // Bitmap chunks are multiples of 64 nodes, so no two threads ever write the same word
+    constexpr size_t BITMAP_CHUNK = 64 * 64;
+
+    bool testBit(const std::vector<uint64_t>& bits, NodeId node) {
+        return (bits[node >> 6] >> (node & 63)) & 1;
+    }
+
+    void setBit(std::vector<uint64_t>& bits, NodeId node) {
+        bits[node >> 6] |= uint64_t{1} << (node & 63);
+    }
+}
+
+GraphBfs::Result GraphBfs::run(const CsrGraph& graph, const std::vector<NodeId>& sources, const Options& options) {
+    return run(graph, graph.transpose(), sources, options);
+}
+
+GraphBfs::Result GraphBfs::run(const CsrGraph& graph, const CsrGraph& reversed,
+                               const std::vector<NodeId>& sources, const Options& options) {
+    const auto startTime = std::chrono::steady_clock::now();
+    const size_t nodes = graph.nodeCount();
+    const size_t threads = resolveThreadCount(options.threads);
+
+    Result result;
+    result.depth.assign(nodes, -1);
+    std::vector<std::atomic<NodeId>> parent(nodes);
+    parallelFor(threads, 0, nodes, [&parent](size_t node) {
+        parent[node].store(NO_PARENT, std::memory_order_relaxed);
+    });
+
+    std::vector<NodeId> frontier;
+    for (NodeId source : sources) {
+        if (source < nodes && parent[source].load(std::memory_order_relaxed) == NO_PARENT) {
+            parent[source].store(source, std::memory_order_relaxed);
+            result.depth[source] = 0;
+            frontier.push_back(source);
+        }
+    }
+
+    std::vector<uint64_t> frontierBits((nodes + 63) / 64, 0);
+    std::vector<uint64_t> nextBits((nodes + 63) / 64, 0);
+    std::vector<std::vector<NodeId>> localNext(threads);
+    std::vector<size_t> localEdges(threads, 0);
+    std::vector<size_t> localCount(threads, 0);
+
+    size_t reached = frontier.size();
+    size_t frontierSize = frontier.size();
+    size_t unexploredEdges = graph.edgeCount();
+    bool bottomUp = false;
+    int32_t level = 0;
+
+    while (frontierSize > 0) {
+        ++level;
+
+        // Out-edges of the current frontier, used by the direction heuristic
+        size_t frontierEdges = 0;
+        if (!bottomUp) {
+            for (NodeId node : frontier) frontierEdges += graph.degree(node);
+        }
+
+        if (!bottomUp && static_cast<double>(frontierEdges) > static_cast<double>(unexploredEdges) / options.alpha) {
+            bottomUp = true;
+            std::fill(frontierBits.begin(), frontierBits.end(), 0);
+            for (NodeId node : frontier) setBit(frontierBits, node);
+        } else if (bottomUp && static_cast<double>(frontierSize) < static_cast<double>(nodes) / options.beta) {
+            bottomUp = false;
+            frontier.clear();
+            for (size_t word = 0; word < frontierBits.size(); ++word) {
+                for (uint64_t bits = frontierBits[word]; bits; bits &= bits - 1) {
+                    frontier.push_back(static_cast<NodeId>(word * 64 + std::countr_zero(bits)));
+                }
+            }
+        }
+
+        std::fill(localEdges.begin(), localEdges.end(), 0);
+        std::fill(localCount.begin(), localCount.end(), 0);
+
+        if (bottomUp) {
+            // Every unvisited page looks for any in-link from the frontier and stops at the first
+            std::fill(nextBits.begin(), nextBits.end(), 0);
+            parallelForChunks(threads, 0, nodes, [&](size_t t, size_t begin, size_t end) {
+                size_t edges = 0;
+                size_t found = 0;
+                for (size_t i = begin; i < end; ++i) {
+                    const auto node = static_cast<NodeId>(i);
+                    if (parent[node].load(std::memory_order_relaxed) != NO_PARENT) continue;
+                    for (NodeId source : reversed.neighbors(node)) {
+                        ++edges;
+                        if (testBit(frontierBits, source)) {
+                            parent[node].store(source, std::memory_order_relaxed);
+                            result.depth[node] = level;
+                            setBit(nextBits, node);
+                            ++found;
+                            break;
+                        }
+                    }
+                }
+                localEdges[t] += edges;
+                localCount[t] += found;
+            }, BITMAP_CHUNK);
+            std::swap(frontierBits, nextBits);
+        } else {
+            // Every frontier page claims its unvisited out-links with a CAS on the parent slot
+            parallelForChunks(threads, 0, frontier.size(), [&](size_t t, size_t begin, size_t end) {
+                auto& next = localNext[t];
+                size_t edges = 0;
+                for (size_t i = begin; i < end; ++i) {
+                    const NodeId node = frontier[i];
+                    for (NodeId neighbor : graph.neighbors(node)) {
+                        ++edges;
+                        NodeId expected = NO_PARENT;
+                        if (parent[neighbor].load(std::memory_order_relaxed) == NO_PARENT &&
+                            parent[neighbor].compare_exchange_strong(expected, node, std::memory_order_relaxed)) {
+                            result.depth[neighbor] = level;
+                            next.push_back(neighbor);
+                        }
+                    }
+                }
+                localEdges[t] += edges;
+            }, 256);
+
+            frontier.clear();
+            for (size_t t = 0; t < threads; ++t) {
+                frontier.insert(frontier.end(), localNext[t].begin(), localNext[t].end());
+                localCount[t] = localNext[t].size();
+                localNext[t].clear();
+            }
+        }
+
+        frontierSize = 0;
+        for (size_t t = 0; t < threads; ++t) {
+            frontierSize += localCount[t];
+            result.edgesExamined += localEdges[t];
+        }
+        reached += frontierSize;
+        unexploredEdges -= std::min(unexploredEdges, frontierEdges);
+    }
+
+    result.parent.resize(nodes);
+    for (NodeId node = 0; node < nodes; ++node) {
+        result.parent[node] = parent[node].load(std::memory_order_relaxed);
+    }
+    result.reached = reached;
+    result.elapsed = std::chrono::steady_clock::now() - startTime;
+    return result;
+}
+
+std::vector<GraphBfs::NodeId> GraphBfs::pathTo(const Result& result, NodeId target) {
+    std::vector<NodeId> path;
+    if (target >= result.parent.size() || result.parent[target] == NO_PARENT) return path;
+
+    for (NodeId node = target; ; node = result.parent[node]) {
+        path.push_back(node);
+        if (result.parent[node] == node) break;
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+std::vector<std::string_view> GraphBfs::shortestPath(const CsrGraph& graph, std::string_view from,
+                                                     std::string_view to, size_t threads) {
+    std::vector<std::string_view> urls;
+    const auto source = graph.findNode(from);
+    const auto target = graph.findNode(to);
+    if (!source || !target) return urls;
+
+    Options options;
+    options.threads = threads;
+    const Result result = run(graph, {*source}, options);
+    for (NodeId node : pathTo(result, *target)) {
+        urls.push_back(graph.url(node));
+    }
+    return urls;
+}
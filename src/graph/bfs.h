@@ -0,0 +1,46 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#pragma once
+#include "linkgraph.h"
+#include <chrono>
+#include <string_view>
+#include <vector>
+
+class GraphBfs
+{
+public:
+    using NodeId = CsrGraph::NodeId;
+    static constexpr NodeId NO_PARENT = UINT32_MAX;
+
+    struct Options {
+        size_t threads = 0;  // 0 uses every hardware thread
+        // Switch to bottom-up once the frontier's out-edges exceed unexplored edges / alpha,
+        // and back to top-down once the frontier holds fewer than nodes / beta pages
+        double alpha = 15.0;
+        double beta = 18.0;
+    };
+
+    struct Result {
+        std::vector<int32_t> depth;   // Clicks from the nearest source, -1 if unreachable
+        std::vector<NodeId> parent;   // Predecessor on one shortest path; sources are their own parent
+        size_t reached = 0;
+        size_t edgesExamined = 0;
+        std::chrono::duration<double> elapsed{};
+    };
+
+    // Direction-optimizing BFS from every source at once. `reversed` must be
+    // graph.transpose(); it drives the bottom-up steps
+    static Result run(const CsrGraph& graph, const CsrGraph& reversed,
+                      const std::vector<NodeId>& sources, const Options& options);
+    static Result run(const CsrGraph& graph, const std::vector<NodeId>& sources, const Options& options);
+
+    // Nodes from the BFS source to target along parent pointers; empty if unreachable
+    static std::vector<NodeId> pathTo(const Result& result, NodeId target);
+
+    // Shortest click path between two URLs in the graph; empty if either is unknown or
+    // there is no path
+    static std::vector<std::string_view> shortestPath(const CsrGraph& graph, std::string_view from,
+                                                      std::string_view to, size_t threads = 0);
+};
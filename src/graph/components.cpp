@@ -0,0 +1,345 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#include "components.h"
+#include "../util/parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+
+namespace {
+    using NodeId = CsrGraph::NodeId;
+    constexpr NodeId UNASSIGNED = UINT32_MAX;
+
+    // Turns representative node IDs into dense labels ordered by component size
+    GraphComponents::Result relabelBySize(const std::vector<NodeId>& representatives) {
+        const size_t nodes = representatives.size();
+        std::vector<size_t> counts(nodes, 0);
+        for (NodeId rep : representatives) {
+            ++counts[rep];
+        }
+
+        std::vector<NodeId> roots;
+        for (NodeId node = 0; node < nodes; ++node) {
+            if (counts[node] > 0) roots.push_back(node);
+        }
+        std::stable_sort(roots.begin(), roots.end(), [&counts](NodeId a, NodeId b) {
+            return counts[a] > counts[b];
+        });
+
+        GraphComponents::Result result;
+        std::vector<NodeId> labelOf(nodes, UNASSIGNED);
+        result.sizes.reserve(roots.size());
+        for (size_t i = 0; i < roots.size(); ++i) {
+            labelOf[roots[i]] = static_cast<NodeId>(i);
+            result.sizes.push_back(counts[roots[i]]);
+        }
+
+        result.labels.resize(nodes);
+        for (NodeId node = 0; node < nodes; ++node) {
+            result.labels[node] = labelOf[representatives[node]];
+        }
+        return result;
+    }
+
+    NodeId findRoot(std::vector<std::atomic<NodeId>>& parent, NodeId node) {
+        while (true) {
+            NodeId up = parent[node].load(std::memory_order_relaxed);
+            if (up == node) return node;
+            NodeId grandparent = parent[up].load(std::memory_order_relaxed);
+            // Path halving; losing this race only costs a longer path next time
+            if (up != grandparent) {
+                parent[node].compare_exchange_weak(up, grandparent, std::memory_order_relaxed);
+            }
+            node = grandparent;
+        }
+    }
+
+    void unite(std::vector<std::atomic<NodeId>>& parent, NodeId a, NodeId b) {
+        while (true) {
+            a = findRoot(parent, a);
+            b = findRoot(parent, b);
+            if (a == b) return;
+            // Always hang the larger root under the smaller one, which rules out cycles
+            if (a > b) std::swap(a, b);
+            NodeId expected = b;
+            if (parent[b].compare_exchange_strong(expected, a, std::memory_order_relaxed)) return;
+        }
+    }
+
+    // Level-synchronous BFS from source that only enters nodes accepted by allowed(),
+    // setting `mark` in marks[] for every node reached
+    template <typename Allowed>
+    void markReachable(const CsrGraph& graph, NodeId source, Allowed&& allowed,
+                       std::vector<std::atomic<uint8_t>>& marks, uint8_t mark, size_t threads) {
+        marks[source].fetch_or(mark, std::memory_order_relaxed);
+        std::vector<NodeId> frontier{source};
+        std::vector<std::vector<NodeId>> next(resolveThreadCount(threads));
+
+        while (!frontier.empty()) {
+            parallelForChunks(threads, 0, frontier.size(), [&](size_t t, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    for (NodeId neighbor : graph.neighbors(frontier[i])) {
+                        if ((marks[neighbor].load(std::memory_order_relaxed) & mark) || !allowed(neighbor)) continue;
+                        if (!(marks[neighbor].fetch_or(mark, std::memory_order_relaxed) & mark)) {
+                            next[t].push_back(neighbor);
+                        }
+                    }
+                }
+            }, 256);
+
+            frontier.clear();
+            for (auto& local : next) {
+                frontier.insert(frontier.end(), local.begin(), local.end());
+                local.clear();
+            }
+        }
+    }
+
+    // Tarjan's algorithm over the nodes accepted by active(), assigning each SCC found its
+    // root as representative. Iterative, so a long chain cannot overflow the stack
+    template <typename Active>
+    void tarjan(const CsrGraph& graph, Active&& active, std::vector<std::atomic<NodeId>>& component) {
+        const size_t nodes = graph.nodeCount();
+        std::vector<NodeId> index(nodes, UNASSIGNED);
+        std::vector<NodeId> low(nodes);
+        std::vector<uint8_t> onStack(nodes, 0);
+        std::vector<NodeId> stack;
+        std::vector<std::pair<NodeId, size_t>> calls;  // Node and its next edge to follow
+        NodeId nextIndex = 0;
+
+        auto enter = [&](NodeId node) {
+            index[node] = low[node] = nextIndex++;
+            stack.push_back(node);
+            onStack[node] = 1;
+            calls.emplace_back(node, 0);
+        };
+
+        for (NodeId start = 0; start < nodes; ++start) {
+            if (!active(start) || index[start] != UNASSIGNED) continue;
+            enter(start);
+            while (!calls.empty()) {
+                const NodeId node = calls.back().first;
+                const auto neighbors = graph.neighbors(node);
+                if (calls.back().second < neighbors.size()) {
+                    const NodeId neighbor = neighbors[calls.back().second++];
+                    if (!active(neighbor)) continue;  // In an SCC already found
+                    if (index[neighbor] == UNASSIGNED) {
+                        enter(neighbor);
+                    } else if (onStack[neighbor]) {
+                        low[node] = std::min(low[node], index[neighbor]);
+                    }
+                    continue;
+                }
+
+                calls.pop_back();
+                if (!calls.empty()) {
+                    const NodeId caller = calls.back().first;
+                    low[caller] = std::min(low[caller], low[node]);
+                }
+                if (low[node] != index[node]) continue;
+                NodeId member;
+                do {
+                    member = stack.back();
+                    stack.pop_back();
+                    onStack[member] = 0;
+                    component[member].store(node, std::memory_order_relaxed);
+                } while (member != node);
+            }
+        }
+    }
+}
+
+size_t GraphComponents::Result::singletonCount() const {
+    // Sizes are sorted descending, so the singletons are a suffix
+    return static_cast<size_t>(sizes.end() - std::lower_bound(sizes.begin(), sizes.end(), size_t{1}, std::greater<>()));
+}
+
+GraphComponents::Result GraphComponents::weak(const CsrGraph& graph, size_t threads) {
+    const size_t nodes = graph.nodeCount();
+    std::vector<std::atomic<NodeId>> parent(nodes);
+    parallelFor(threads, 0, nodes, [&parent](size_t node) {
+        parent[node].store(static_cast<NodeId>(node), std::memory_order_relaxed);
+    });
+
+    parallelFor(threads, 0, nodes, [&](size_t node) {
+        for (NodeId neighbor : graph.neighbors(static_cast<NodeId>(node))) {
+            unite(parent, static_cast<NodeId>(node), neighbor);
+        }
+    }, 256);
+
+    std::vector<NodeId> representatives(nodes);
+    parallelFor(threads, 0, nodes, [&](size_t node) {
+        representatives[node] = findRoot(parent, static_cast<NodeId>(node));
+    });
+
+    return relabelBySize(representatives);
+}
+
+GraphComponents::Result GraphComponents::strong(const CsrGraph& graph, size_t threads) {
+    const size_t nodes = graph.nodeCount();
+    if (nodes == 0) return {};
+
+    const CsrGraph reversed = graph.transpose();
+
+    // component[v] holds a representative node once v's SCC is known
+    std::vector<std::atomic<NodeId>> component(nodes);
+    parallelFor(threads, 0, nodes, [&component](size_t node) {
+        component[node].store(UNASSIGNED, std::memory_order_relaxed);
+    });
+    auto active = [&component](NodeId node) {
+        return component[node].load(std::memory_order_relaxed) == UNASSIGNED;
+    };
+
+    // Trim: a node with no live in-links or no live out-links is an SCC by itself, and
+    // removing it can leave its neighbours in the same state. Live degree counters and a
+    // queue peel them all, to a fixpoint, in O(n + m)
+    std::vector<uint32_t> liveIn(nodes);
+    std::vector<uint32_t> liveOut(nodes);
+    auto liveDegree = [&active](const CsrGraph& g, NodeId node) {
+        uint32_t degree = 0;
+        for (NodeId neighbor : g.neighbors(node)) {
+            if (neighbor != node && active(neighbor)) ++degree;
+        }
+        return degree;
+    };
+    auto trim = [&]() {
+        parallelFor(threads, 0, nodes, [&](size_t i) {
+            const auto node = static_cast<NodeId>(i);
+            if (!active(node)) return;
+            liveOut[node] = liveDegree(graph, node);
+            liveIn[node] = liveDegree(reversed, node);
+        }, 4096);
+        std::vector<NodeId> queue;
+        for (NodeId node = 0; node < nodes; ++node) {
+            if (active(node) && (liveIn[node] == 0 || liveOut[node] == 0)) queue.push_back(node);
+        }
+        while (!queue.empty()) {
+            const NodeId node = queue.back();
+            queue.pop_back();
+            if (!active(node)) continue;  // Queued twice, once per direction
+            component[node].store(node, std::memory_order_relaxed);
+            for (NodeId neighbor : graph.neighbors(node)) {
+                if (neighbor != node && active(neighbor) && --liveIn[neighbor] == 0) queue.push_back(neighbor);
+            }
+            for (NodeId neighbor : reversed.neighbors(node)) {
+                if (neighbor != node && active(neighbor) && --liveOut[neighbor] == 0) queue.push_back(neighbor);
+            }
+        }
+    };
+    trim();
+
+    // Forward-backward from the best-connected node usually removes the giant SCC at once
+    NodeId pivot = UNASSIGNED;
+    uint64_t bestScore = 0;
+    for (NodeId node = 0; node < nodes; ++node) {
+        if (!active(node)) continue;
+        const uint64_t score = static_cast<uint64_t>(graph.degree(node)) * reversed.degree(node);
+        if (pivot == UNASSIGNED || score > bestScore) {
+            pivot = node;
+            bestScore = score;
+        }
+    }
+
+    if (pivot != UNASSIGNED) {
+        std::vector<std::atomic<uint8_t>> marks(nodes);
+        constexpr uint8_t FORWARD = 1;
+        constexpr uint8_t BACKWARD = 2;
+
+        markReachable(graph, pivot, active, marks, FORWARD, threads);
+        markReachable(reversed, pivot, [&](NodeId node) {
+            return (marks[node].load(std::memory_order_relaxed) & FORWARD) != 0;
+        }, marks, BACKWARD, threads);
+
+        parallelFor(threads, 0, nodes, [&](size_t node) {
+            if (marks[node].load(std::memory_order_relaxed) == (FORWARD | BACKWARD)) {
+                component[node].store(pivot, std::memory_order_relaxed);
+            }
+        }, 4096);
+    }
+
+    // Colouring: push the largest node ID forward until nothing changes. Each node whose
+    // colour is its own ID then owns the SCC of the nodes sharing that colour that
+    // reach it backwards. Repeat on whatever is still unassigned, trimmed again first.
+    // A colour moves one edge per sweep against the node order, and a chain of SCCs can
+    // settle only one per round, so past MAX_COLOUR_SWEEPS sweeps the rest goes to
+    // Tarjan's algorithm, which is sequential but linear
+    constexpr size_t MAX_COLOUR_SWEEPS = 256;
+    size_t sweeps = 0;
+    std::vector<std::atomic<NodeId>> colour(nodes);
+    std::vector<std::atomic<uint8_t>> dirty(nodes);
+    std::vector<std::vector<NodeId>> stacks(resolveThreadCount(threads));
+
+    while (sweeps <= MAX_COLOUR_SWEEPS) {
+        trim();
+        std::vector<NodeId> remaining;
+        for (NodeId node = 0; node < nodes; ++node) {
+            if (active(node)) remaining.push_back(node);
+        }
+        if (remaining.empty()) break;
+
+        parallelFor(threads, 0, remaining.size(), [&](size_t i) {
+            const NodeId node = remaining[i];
+            colour[node].store(node, std::memory_order_relaxed);
+            dirty[node].store(1, std::memory_order_relaxed);
+        });
+
+        std::atomic<bool> changed{true};
+        while (changed.exchange(false) && ++sweeps <= MAX_COLOUR_SWEEPS) {
+            parallelFor(threads, 0, remaining.size(), [&](size_t i) {
+                const NodeId node = remaining[i];
+                if (!dirty[node].exchange(0, std::memory_order_relaxed)) return;
+
+                const NodeId mine = colour[node].load(std::memory_order_relaxed);
+                for (NodeId neighbor : graph.neighbors(node)) {
+                    if (!active(neighbor)) continue;
+                    NodeId theirs = colour[neighbor].load(std::memory_order_relaxed);
+                    while (theirs < mine) {
+                        if (colour[neighbor].compare_exchange_weak(theirs, mine, std::memory_order_relaxed)) {
+                            dirty[neighbor].store(1, std::memory_order_relaxed);
+                            changed.store(true, std::memory_order_relaxed);
+                            break;
+                        }
+                    }
+                }
+            }, 1024);
+        }
+
+        if (sweeps > MAX_COLOUR_SWEEPS) break;  // Colours not settled; they prove nothing
+
+        std::vector<NodeId> roots;
+        for (NodeId node : remaining) {
+            if (colour[node].load(std::memory_order_relaxed) == node) roots.push_back(node);
+        }
+
+        // Colour classes are disjoint, so the backward searches never touch the same node
+        parallelForChunks(threads, 0, roots.size(), [&](size_t t, size_t begin, size_t end) {
+            auto& stack = stacks[t];
+            for (size_t r = begin; r < end; ++r) {
+                const NodeId root = roots[r];
+                component[root].store(root, std::memory_order_relaxed);
+                stack.push_back(root);
+
+                while (!stack.empty()) {
+                    const NodeId node = stack.back();
+                    stack.pop_back();
+                    for (NodeId neighbor : reversed.neighbors(node)) {
+                        if (active(neighbor) && colour[neighbor].load(std::memory_order_relaxed) == root) {
+                            component[neighbor].store(root, std::memory_order_relaxed);
+                            stack.push_back(neighbor);
+                        }
+                    }
+                }
+            }
+        }, 64);
+    }
+
+    tarjan(graph, active, component);
+
+    std::vector<NodeId> representatives(nodes);
+    for (NodeId node = 0; node < nodes; ++node) {
+        representatives[node] = component[node].load(std::memory_order_relaxed);
+    }
+    return relabelBySize(representatives);
+}
@@ -0,0 +1,28 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#pragma once
+#include "linkgraph.h"
+#include <vector>
+
+class GraphComponents
+{
+public:
+    // Component labels are dense and ordered by size: component 0 is the largest
+    struct Result {
+        std::vector<uint32_t> labels;  // Component of each node
+        std::vector<size_t> sizes;     // Node count of each component, descending
+
+        [[nodiscard]] size_t count() const { return sizes.size(); }
+        [[nodiscard]] size_t singletonCount() const;
+    };
+
+    // Weakly connected components (link direction ignored), via a lock-free union-find
+    static Result weak(const CsrGraph& graph, size_t threads = 0);
+
+    // Strongly connected components: trimming, forward-backward search from a pivot for
+    // the giant component, then colour propagation for the rest. All traversals are
+    // iterative, so deep link chains cannot exhaust the stack.
+    static Result strong(const CsrGraph& graph, size_t threads = 0);
+};
@@ -0,0 +1,308 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#include "linkgraph.h"
+#include "../util/mappedfile.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+    // On-disk layout: header, then offsets (u64 x n+1), targets (u32 x m), URL offsets
+    // (u64 x n+1) and the URL bytes. Every array starts 8-byte aligned so the mapped
+    // file can be viewed directly. Integers are stored in host byte order.
+    constexpr char GRAPH_MAGIC[8] = {'W', 'C', 'G', 'R', 'A', 'P', 'H', '1'};
+    constexpr uint32_t GRAPH_VERSION = 1;
+
+    struct GraphFileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t reserved;
+        uint64_t nodeCount;
+        uint64_t edgeCount;
+        uint64_t offsetsPos;
+        uint64_t targetsPos;
+        uint64_t urlOffsetsPos;
+        uint64_t urlDataPos;
+        uint64_t urlDataSize;
+    };
+
+    uint64_t alignUp(uint64_t value) {
+        return (value + 7) & ~uint64_t{7};
+    }
+
+    // Whether count elements of elementSize bytes at pos lie inside a file of fileSize
+    // bytes, without overflowing on hostile header values
+    bool fitsIn(uint64_t pos, uint64_t count, uint64_t elementSize, uint64_t fileSize) {
+        return pos <= fileSize && count <= (fileSize - pos) / elementSize;
+    }
+
+    void writePadding(std::ofstream& file, uint64_t from, uint64_t to) {
+        static constexpr char zeros[8] = {};
+        file.write(zeros, static_cast<std::streamsize>(to - from));
+    }
+}
+
+CsrGraph::CsrGraph() : index_(std::make_unique<UrlIndex>()) {
+    bindOwned();
+}
+
+CsrGraph::~CsrGraph() = default;
+CsrGraph::CsrGraph(CsrGraph&&) noexcept = default;
+CsrGraph& CsrGraph::operator=(CsrGraph&&) noexcept = default;
+
+void CsrGraph::bindOwned() {
+    if (ownedOffsets_.empty()) ownedOffsets_.push_back(0);
+    if (ownedUrlOffsets_.empty()) ownedUrlOffsets_.push_back(0);
+    offsets_ = ownedOffsets_;
+    targets_ = ownedTargets_;
+    urlOffsets_ = ownedUrlOffsets_;
+    urlData_ = std::string_view(ownedUrlData_.data(), ownedUrlData_.size());
+}
+
+std::string_view CsrGraph::url(NodeId node) const {
+    return urlData_.substr(urlOffsets_[node], urlOffsets_[node + 1] - urlOffsets_[node]);
+}
+
+std::optional<CsrGraph::NodeId> CsrGraph::findNode(std::string_view url) const {
+    std::call_once(index_->once, [this] {
+        index_->ids.reserve(nodeCount());
+        for (NodeId node = 0; node < nodeCount(); ++node) {
+            index_->ids.emplace(this->url(node), node);
+        }
+    });
+
+    auto it = index_->ids.find(url);
+    if (it == index_->ids.end()) return std::nullopt;
+    return it->second;
+}
+
+void CsrGraph::save(const std::string& filename) const {
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("Failed to open graph file for writing: " + filename);
+    }
+
+    GraphFileHeader header{};
+    std::memcpy(header.magic, GRAPH_MAGIC, sizeof(GRAPH_MAGIC));
+    header.version = GRAPH_VERSION;
+    header.nodeCount = nodeCount();
+    header.edgeCount = edgeCount();
+    header.offsetsPos = alignUp(sizeof(GraphFileHeader));
+    header.targetsPos = alignUp(header.offsetsPos + offsets_.size_bytes());
+    header.urlOffsetsPos = alignUp(header.targetsPos + targets_.size_bytes());
+    header.urlDataPos = alignUp(header.urlOffsetsPos + urlOffsets_.size_bytes());
+    header.urlDataSize = urlData_.size();
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    writePadding(file, sizeof(header), header.offsetsPos);
+    file.write(reinterpret_cast<const char*>(offsets_.data()), static_cast<std::streamsize>(offsets_.size_bytes()));
+    writePadding(file, header.offsetsPos + offsets_.size_bytes(), header.targetsPos);
+    file.write(reinterpret_cast<const char*>(targets_.data()), static_cast<std::streamsize>(targets_.size_bytes()));
+    writePadding(file, header.targetsPos + targets_.size_bytes(), header.urlOffsetsPos);
+    file.write(reinterpret_cast<const char*>(urlOffsets_.data()), static_cast<std::streamsize>(urlOffsets_.size_bytes()));
+    writePadding(file, header.urlOffsetsPos + urlOffsets_.size_bytes(), header.urlDataPos);
+    file.write(urlData_.data(), static_cast<std::streamsize>(urlData_.size()));
+
+    if (!file) {
+        throw std::runtime_error("Failed to write graph file: " + filename);
+    }
+}
+
+CsrGraph CsrGraph::load(const std::string& filename) {
+    auto mapped = std::make_shared<MappedFile>(filename);
+    const char* base = mapped->data();
+    const size_t size = mapped->size();
+
+    GraphFileHeader header{};
+    if (size < sizeof(header)) {
+        throw std::runtime_error("Graph file is truncated: " + filename);
+    }
+    std::memcpy(&header, base, sizeof(header));
+
+    if (std::memcmp(header.magic, GRAPH_MAGIC, sizeof(GRAPH_MAGIC)) != 0 || header.version != GRAPH_VERSION) {
+        throw std::runtime_error("Not a link graph file: " + filename);
+    }
+
+    // Node IDs are 32-bit, so a larger count cannot be a graph this code wrote
+    if (header.nodeCount > std::numeric_limits<NodeId>::max()) {
+        throw std::runtime_error("Graph file is corrupt: " + filename);
+    }
+    if (!fitsIn(header.offsetsPos, header.nodeCount + 1, sizeof(uint64_t), size) ||
+        !fitsIn(header.targetsPos, header.edgeCount, sizeof(NodeId), size) ||
+        !fitsIn(header.urlOffsetsPos, header.nodeCount + 1, sizeof(uint64_t), size) ||
+        !fitsIn(header.urlDataPos, header.urlDataSize, 1, size)) {
+        throw std::runtime_error("Graph file is truncated: " + filename);
+    }
+    // The arrays are viewed in place, which needs them aligned like save() leaves them
+    if (header.offsetsPos % alignof(uint64_t) != 0 || header.targetsPos % alignof(NodeId) != 0 ||
+        header.urlOffsetsPos % alignof(uint64_t) != 0 || reinterpret_cast<uintptr_t>(base) % alignof(uint64_t) != 0) {
+        throw std::runtime_error("Graph file is corrupt: " + filename);
+    }
+
+    CsrGraph graph;
+    graph.offsets_ = {reinterpret_cast<const uint64_t*>(base + header.offsetsPos), header.nodeCount + 1};
+    graph.targets_ = {reinterpret_cast<const NodeId*>(base + header.targetsPos), header.edgeCount};
+    graph.urlOffsets_ = {reinterpret_cast<const uint64_t*>(base + header.urlOffsetsPos), header.nodeCount + 1};
+    graph.urlData_ = std::string_view(base + header.urlDataPos, header.urlDataSize);
+
+    // One pass over the arrays, so the algorithms can index them without checks: rows and
+    // URLs must tile their arrays in order, and every edge must name a node
+    bool valid = graph.offsets_.front() == 0 && graph.offsets_.back() == header.edgeCount &&
+                 graph.urlOffsets_.front() == 0 && graph.urlOffsets_.back() == header.urlDataSize;
+    for (size_t i = 0; valid && i < header.nodeCount; ++i) {
+        valid = graph.offsets_[i] <= graph.offsets_[i + 1] && graph.urlOffsets_[i] <= graph.urlOffsets_[i + 1];
+    }
+    for (size_t e = 0; valid && e < header.edgeCount; ++e) {
+        valid = graph.targets_[e] < header.nodeCount;
+    }
+    if (!valid) {
+        throw std::runtime_error("Graph file is corrupt: " + filename);
+    }
+
+    graph.file_ = std::move(mapped);
+    return graph;
+}
+
+template <typename EdgeVisitor>
+void CsrGraph::buildRows(size_t nodeCount, size_t edgeCount, EdgeVisitor&& forEachEdge) {
+    ownedOffsets_.assign(nodeCount + 1, 0);
+    auto& offsets = ownedOffsets_;
+
+    // Counting sort of the edges by source node
+    forEachEdge([&offsets](NodeId source, NodeId) { ++offsets[source + 1]; });
+    for (size_t i = 0; i < nodeCount; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+
+    std::vector<NodeId> targets(edgeCount);
+    std::vector<uint64_t> cursor(offsets.begin(), offsets.end() - 1);
+    forEachEdge([&targets, &cursor](NodeId source, NodeId target) { targets[cursor[source]++] = target; });
+
+    // Sort each row and drop repeated links, compacting in place
+    uint64_t write = 0;
+    for (size_t i = 0; i < nodeCount; ++i) {
+        auto rowBegin = targets.begin() + static_cast<std::ptrdiff_t>(offsets[i]);
+        auto rowEnd = targets.begin() + static_cast<std::ptrdiff_t>(offsets[i + 1]);
+        std::sort(rowBegin, rowEnd);
+        rowEnd = std::unique(rowBegin, rowEnd);
+
+        offsets[i] = write;
+        write = std::copy(rowBegin, rowEnd, targets.begin() + static_cast<std::ptrdiff_t>(write)) - targets.begin();
+    }
+    offsets[nodeCount] = write;
+    targets.resize(write);
+    targets.shrink_to_fit();
+    ownedTargets_ = std::move(targets);
+}
+
+CsrGraph CsrGraph::transpose() const {
+    const size_t nodes = nodeCount();
+
+    CsrGraph reversed;
+    reversed.ownedOffsets_.assign(nodes + 1, 0);
+    for (NodeId target : targets_) {
+        ++reversed.ownedOffsets_[target + 1];
+    }
+    for (size_t i = 0; i < nodes; ++i) {
+        reversed.ownedOffsets_[i + 1] += reversed.ownedOffsets_[i];
+    }
+
+    // Visiting sources in ascending order leaves every reversed row already sorted
+    reversed.ownedTargets_.resize(targets_.size());
+    std::vector<uint64_t> cursor(reversed.ownedOffsets_.begin(), reversed.ownedOffsets_.end() - 1);
+    for (NodeId source = 0; source < nodes; ++source) {
+        for (NodeId target : neighbors(source)) {
+            reversed.ownedTargets_[cursor[target]++] = source;
+        }
+    }
+
+    reversed.bindOwned();
+    reversed.urlOffsets_ = urlOffsets_;
+    reversed.urlData_ = urlData_;
+    reversed.file_ = file_;
+    return reversed;
+}
+
+CsrGraph CsrGraph::fromEdges(size_t nodeCount, const std::vector<std::pair<NodeId, NodeId>>& edges) {
+    CsrGraph graph;
+    graph.buildRows(nodeCount, edges.size(), [&edges](auto&& emit) {
+        for (const auto& [source, target] : edges) {
+            emit(source, target);
+        }
+    });
+    graph.ownedUrlOffsets_.assign(nodeCount + 1, 0);
+    graph.bindOwned();
+    return graph;
+}
+
+LinkGraphBuilder::NodeId LinkGraphBuilder::addNode(std::string_view url) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return internLocked(url);
+}
+
+void LinkGraphBuilder::addPage(const std::string& url, const std::vector<std::string>& links) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const NodeId source = internLocked(url);
+
+    for (const auto& link : links) {
+        const NodeId target = internLocked(link);
+
+        if (edgeChunks_.empty() || edgeChunks_.back().size() == EDGE_CHUNK_SIZE) {
+            edgeChunks_.emplace_back().reserve(EDGE_CHUNK_SIZE);
+        }
+        edgeChunks_.back().push_back({source, target});
+        ++edgeCount_;
+    }
+}
+
+LinkGraphBuilder::NodeId LinkGraphBuilder::internLocked(std::string_view url) {
+    auto it = ids_.find(url);
+    if (it != ids_.end()) return it->second;
+
+    const auto id = static_cast<NodeId>(urls_.size());
+    auto inserted = ids_.emplace(std::string(url), id).first;
+    urls_.push_back(&inserted->first);
+    return id;
+}
+
+size_t LinkGraphBuilder::nodeCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return urls_.size();
+}
+
+size_t LinkGraphBuilder::edgeCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return edgeCount_;
+}
+
+CsrGraph LinkGraphBuilder::finalize() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t nodes = urls_.size();
+
+    CsrGraph graph;
+    graph.buildRows(nodes, edgeCount_, [this](auto&& emit) {
+        for (const auto& chunk : edgeChunks_) {
+            for (const auto& edge : chunk) {
+                emit(edge.source, edge.target);
+            }
+        }
+    });
+
+    graph.ownedUrlOffsets_.assign(nodes + 1, 0);
+    size_t urlBytes = 0;
+    for (size_t i = 0; i < nodes; ++i) {
+        urlBytes += urls_[i]->size();
+        graph.ownedUrlOffsets_[i + 1] = urlBytes;
+    }
+    graph.ownedUrlData_.reserve(urlBytes);
+    for (const auto* url : urls_) {
+        graph.ownedUrlData_.insert(graph.ownedUrlData_.end(), url->begin(), url->end());
+    }
+
+    graph.bindOwned();
+    return graph;
+}
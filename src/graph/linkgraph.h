@@ -0,0 +1,123 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class MappedFile;
+
+// Immutable link graph in compressed sparse row form: the out-links of node i are
+// targets()[offsets()[i] .. offsets()[i + 1]). Either owns its arrays or views a
+// graph file mapped with CsrGraph::load, so large graphs open without parsing.
+class CsrGraph
+{
+public:
+    using NodeId = uint32_t;
+
+    CsrGraph();
+    ~CsrGraph();
+    CsrGraph(CsrGraph&&) noexcept;
+    CsrGraph& operator=(CsrGraph&&) noexcept;
+
+    [[nodiscard]] size_t nodeCount() const { return urlOffsets_.empty() ? 0 : urlOffsets_.size() - 1; }
+    [[nodiscard]] size_t edgeCount() const { return targets_.size(); }
+
+    [[nodiscard]] std::span<const NodeId> neighbors(NodeId node) const {
+        return targets_.subspan(offsets_[node], offsets_[node + 1] - offsets_[node]);
+    }
+    [[nodiscard]] size_t degree(NodeId node) const { return offsets_[node + 1] - offsets_[node]; }
+
+    [[nodiscard]] std::span<const uint64_t> offsets() const { return offsets_; }
+    [[nodiscard]] std::span<const NodeId> targets() const { return targets_; }
+
+    [[nodiscard]] std::string_view url(NodeId node) const;
+    // Looks a URL up by exact match; the lookup table is built on first use
+    [[nodiscard]] std::optional<NodeId> findNode(std::string_view url) const;
+
+    // Reverses every edge: row i of the result lists the pages linking to node i.
+    // URLs are shared with this graph, which must outlive the result
+    [[nodiscard]] CsrGraph transpose() const;
+
+    // Builds a graph from raw (source, target) pairs; nodes have empty URLs
+    static CsrGraph fromEdges(size_t nodeCount, const std::vector<std::pair<NodeId, NodeId>>& edges);
+
+    // Writes the graph in the binary format read by load()
+    void save(const std::string& filename) const;
+    // Maps a graph file written by save(); arrays are used in place, not copied, after one
+    // O(n + m) pass that checks them. Throws std::runtime_error for a truncated or corrupt file
+    static CsrGraph load(const std::string& filename);
+
+private:
+    friend class LinkGraphBuilder;
+
+    struct UrlIndex {
+        std::once_flag once;
+        std::unordered_map<std::string_view, NodeId> ids;
+    };
+
+    // Backing storage: owned vectors for in-memory graphs, the mapping for loaded ones
+    std::vector<uint64_t> ownedOffsets_;
+    std::vector<NodeId> ownedTargets_;
+    std::vector<uint64_t> ownedUrlOffsets_;
+    std::vector<char> ownedUrlData_;
+    std::shared_ptr<MappedFile> file_;
+
+    std::span<const uint64_t> offsets_;
+    std::span<const NodeId> targets_;
+    std::span<const uint64_t> urlOffsets_;
+    std::string_view urlData_;
+
+    std::unique_ptr<UrlIndex> index_;
+
+    void bindOwned();
+    template <typename EdgeVisitor>
+    void buildRows(size_t nodeCount, size_t edgeCount, EdgeVisitor&& forEachEdge);
+};
+
+// Accumulates pages and their out-links while a crawl runs, assigning each URL a
+// dense NodeId on first sight. Thread-safe; edges go into fixed-size chunks so
+// appending never relocates what is already stored.
+class LinkGraphBuilder
+{
+public:
+    using NodeId = CsrGraph::NodeId;
+
+    NodeId addNode(std::string_view url);
+    void addPage(const std::string& url, const std::vector<std::string>& links);
+
+    [[nodiscard]] size_t nodeCount() const;
+    [[nodiscard]] size_t edgeCount() const;
+
+    // Builds a CSR snapshot with each adjacency row sorted and de-duplicated
+    [[nodiscard]] CsrGraph finalize() const;
+
+private:
+    struct Edge {
+        NodeId source;
+        NodeId target;
+    };
+
+    struct StringHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+    };
+
+    static constexpr size_t EDGE_CHUNK_SIZE = 1 << 16;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, NodeId, StringHash, std::equal_to<>> ids_;
+    std::vector<const std::string*> urls_;
+    std::vector<std::vector<Edge>> edgeChunks_;
+    size_t edgeCount_ = 0;
+
+    NodeId internLocked(std::string_view url);
+};
@@ -0,0 +1,199 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#include "pagerank.h"
+#include "../util/parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <cmath>
+#include <thread>
+
+namespace {
+    using NodeId = CsrGraph::NodeId;
+
+    // In-edges grouped by source block: for block b, dests[destOffsets[b]..destOffsets[b+1])
+    // are the pages with an in-link from that block, ascending, and the sources of dests[i]
+    // are sources[edgeOffsets[i]..edgeOffsets[i+1]). Pulling one block at a time keeps the
+    // random reads of the contribution array inside a cache-sized window.
+    struct BlockedInEdges {
+        size_t blockCount = 0;
+        std::vector<uint64_t> destOffsets;
+        std::vector<NodeId> dests;
+        std::vector<uint64_t> edgeOffsets;
+        std::vector<NodeId> sources;
+    };
+
+    BlockedInEdges buildBlockedInEdges(const CsrGraph& reversed, size_t blockSize) {
+        const size_t nodes = reversed.nodeCount();
+        BlockedInEdges blocked;
+        blocked.blockCount = std::max<size_t>(1, (nodes + blockSize - 1) / blockSize);
+
+        // Each in-row is sorted by source, so the sources from one block form one run
+        std::vector<uint64_t> destCounts(blocked.blockCount, 0);
+        std::vector<uint64_t> edgeCounts(blocked.blockCount, 0);
+        for (NodeId dest = 0; dest < nodes; ++dest) {
+            size_t previousBlock = SIZE_MAX;
+            for (NodeId source : reversed.neighbors(dest)) {
+                const size_t block = source / blockSize;
+                if (block != previousBlock) {
+                    ++destCounts[block];
+                    previousBlock = block;
+                }
+                ++edgeCounts[block];
+            }
+        }
+
+        blocked.destOffsets.assign(blocked.blockCount + 1, 0);
+        std::vector<uint64_t> edgeStart(blocked.blockCount + 1, 0);
+        for (size_t b = 0; b < blocked.blockCount; ++b) {
+            blocked.destOffsets[b + 1] = blocked.destOffsets[b] + destCounts[b];
+            edgeStart[b + 1] = edgeStart[b] + edgeCounts[b];
+        }
+
+        blocked.dests.resize(blocked.destOffsets.back());
+        blocked.edgeOffsets.resize(blocked.dests.size() + 1);
+        blocked.sources.resize(edgeStart.back());
+
+        std::vector<uint64_t> destCursor(blocked.destOffsets.begin(), blocked.destOffsets.end() - 1);
+        std::vector<uint64_t> edgeCursor(edgeStart.begin(), edgeStart.end() - 1);
+        for (NodeId dest = 0; dest < nodes; ++dest) {
+            size_t previousBlock = SIZE_MAX;
+            for (NodeId source : reversed.neighbors(dest)) {
+                const size_t block = source / blockSize;
+                if (block != previousBlock) {
+                    const uint64_t slot = destCursor[block]++;
+                    blocked.dests[slot] = dest;
+                    blocked.edgeOffsets[slot] = edgeCursor[block];
+                    previousBlock = block;
+                }
+                blocked.sources[edgeCursor[block]++] = source;
+            }
+        }
+        blocked.edgeOffsets.back() = blocked.sources.size();
+
+        return blocked;
+    }
+
+    // Splits [0, nodes) into contiguous ranges with roughly equal in-edge work
+    std::vector<NodeId> partitionNodes(const CsrGraph& reversed, size_t parts) {
+        const size_t nodes = reversed.nodeCount();
+        const auto offsets = reversed.offsets();
+        const uint64_t totalWork = reversed.edgeCount() + nodes;
+
+        std::vector<NodeId> bounds(parts + 1, static_cast<NodeId>(nodes));
+        bounds[0] = 0;
+        NodeId node = 0;
+        for (size_t part = 1; part < parts; ++part) {
+            const uint64_t goal = totalWork * part / parts;
+            while (node < nodes && offsets[node] + node < goal) ++node;
+            bounds[part] = node;
+        }
+        return bounds;
+    }
+}
+
+PageRank::Result PageRank::compute(const CsrGraph& graph, const Options& options) {
+    const auto startTime = std::chrono::steady_clock::now();
+    const size_t nodes = graph.nodeCount();
+
+    Result result;
+    if (nodes == 0) return result;
+
+    const CsrGraph reversed = graph.transpose();
+    const BlockedInEdges blocked = buildBlockedInEdges(reversed, std::max<size_t>(1, options.blockSize));
+
+    const size_t threadCount = std::min(resolveThreadCount(options.threads), nodes);
+    const std::vector<NodeId> bounds = partitionNodes(reversed, threadCount);
+
+    std::vector<double> scores(nodes, 1.0 / static_cast<double>(nodes));
+    std::vector<double> contributions(nodes, 0.0);
+    std::vector<double> sums(nodes, 0.0);
+
+    std::vector<double> danglingParts(threadCount, 0.0);
+    std::vector<double> residualParts(threadCount, 0.0);
+    double danglingTotal = 0.0;
+    bool done = options.maxIterations == 0;
+    const double invNodes = 1.0 / static_cast<double>(nodes);
+
+    std::barrier afterScatter(static_cast<std::ptrdiff_t>(threadCount), [&]() noexcept {
+        danglingTotal = 0.0;
+        for (double part : danglingParts) danglingTotal += part;
+    });
+
+    std::barrier afterUpdate(static_cast<std::ptrdiff_t>(threadCount), [&]() noexcept {
+        double residual = 0.0;
+        for (double part : residualParts) residual += part;
+        result.residual = residual;
+        ++result.iterations;
+        result.converged = residual < options.tolerance;
+        done = result.converged || result.iterations >= options.maxIterations;
+    });
+
+    auto worker = [&](size_t threadIndex) {
+        const NodeId begin = bounds[threadIndex];
+        const NodeId end = bounds[threadIndex + 1];
+
+        // Where this thread's destinations start within each block
+        std::vector<std::pair<uint64_t, uint64_t>> blockRanges(blocked.blockCount);
+        for (size_t b = 0; b < blocked.blockCount; ++b) {
+            const auto first = blocked.dests.begin() + static_cast<std::ptrdiff_t>(blocked.destOffsets[b]);
+            const auto last = blocked.dests.begin() + static_cast<std::ptrdiff_t>(blocked.destOffsets[b + 1]);
+            blockRanges[b] = {
+                std::lower_bound(first, last, begin) - blocked.dests.begin(),
+                std::lower_bound(first, last, end) - blocked.dests.begin()
+            };
+        }
+
+        while (!done) {
+            double dangling = 0.0;
+            for (NodeId node = begin; node < end; ++node) {
+                const size_t degree = graph.degree(node);
+                if (degree == 0) {
+                    dangling += scores[node];
+                    contributions[node] = 0.0;
+                } else {
+                    contributions[node] = scores[node] / static_cast<double>(degree);
+                }
+                sums[node] = 0.0;
+            }
+            danglingParts[threadIndex] = dangling;
+            afterScatter.arrive_and_wait();
+
+            for (const auto& [first, last] : blockRanges) {
+                for (uint64_t slot = first; slot < last; ++slot) {
+                    double sum = 0.0;
+                    for (uint64_t e = blocked.edgeOffsets[slot]; e < blocked.edgeOffsets[slot + 1]; ++e) {
+                        sum += contributions[blocked.sources[e]];
+                    }
+                    sums[blocked.dests[slot]] += sum;
+                }
+            }
+
+            const double base = (1.0 - options.damping) * invNodes + options.damping * danglingTotal * invNodes;
+            double residual = 0.0;
+            for (NodeId node = begin; node < end; ++node) {
+                const double updated = base + options.damping * sums[node];
+                residual += std::abs(updated - scores[node]);
+                scores[node] = updated;
+            }
+            residualParts[threadIndex] = residual;
+            afterUpdate.arrive_and_wait();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (size_t t = 1; t < threadCount; ++t) {
+        threads.emplace_back(worker, t);
+    }
+    worker(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    result.scores = std::move(scores);
+    result.elapsed = std::chrono::steady_clock::now() - startTime;
+    return result;
+}
@@ -0,0 +1,35 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#pragma once
+#include "linkgraph.h"
+#include <chrono>
+#include <vector>
+
+class PageRank
+{
+public:
+    struct Options {
+        double damping = 0.85;
+        // Stop once the L1 change of the score vector drops below this
+        double tolerance = 1e-6;
+        size_t maxIterations = 100;
+        // 0 uses every hardware thread
+        size_t threads = 0;
+        // Source nodes per cache block; each block's contributions are pulled in one pass
+        size_t blockSize = 1 << 18;
+    };
+
+    struct Result {
+        std::vector<double> scores;
+        size_t iterations = 0;
+        double residual = 0.0;
+        bool converged = false;
+        std::chrono::duration<double> elapsed{};
+    };
+
+    // Scores sum to 1. Rank held by pages without out-links is spread evenly over all pages
+    static Result compute(const CsrGraph& graph, const Options& options);
+    static Result compute(const CsrGraph& graph) { return compute(graph, Options{}); }
+};
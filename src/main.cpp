@@ -6,9 +6,18 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <memory>
+#include <csignal>
 #include "crawler/urlparser.h"
 #include "crawler/webcrawler.h"
 #include "export/crawlexport.h"
+#include "export/streamexport.h"
+#include "export/warcwriter.h"
+#include "export/pagestore.h"
+#include "graph/linkgraph.h"
+#include "graph/pagerank.h"
+#include "graph/components.h"
+#include "graph/bfs.h"
 
 void printUsage() {
     std::cout << "Usage: WebCrawler [options]\n"
@@ -17,11 +26,48 @@ void printUsage() {
               << "  -p, --pages <number>     Maximum pages to crawl (default: 100)\n"
               << "  -t, --threads <number>   Number of threads (default: 4)\n"
               << "  -o, --output <file>      Output file (JSON format)\n"
+              << "  -s, --stream <file>      Stream results while crawling (JSON Lines, or CSV for .csv)\n"
+              << "  --warc <prefix>          Archive raw responses to <prefix>-NNNNN.warc.gz with a CDX index\n"
+              << "  --warc-level <0-9>       zlib level of the WARC files (default: 1, fastest)\n"
+              << "  --store <dir>            Keep page bodies in a compressed, deduplicated page store in <dir>\n"
+              << "  --metrics <file>         Write Prometheus-format metrics to <file> every 5s\n"
+              << "  --trace <file>           Write a Chrome/Perfetto trace of worker activity to <file>\n"
+              << "  --trace-sample <rate>    Fraction of URLs to trace (default: 1.0)\n"
+              << "  -g, --graph <file>       Save the crawled link graph (CSR binary format)\n"
+              << "  --path <url>             Print the shortest click path from the start URL to <url>\n"
+              << "  --allow-host <host>      Also crawl <host> ('*.example.com' covers its subdomains); repeatable\n"
+              << "  --include <glob>         Only crawl URLs matching <glob> ('*' any run, '?' any char); repeatable\n"
+              << "  --exclude <glob>         Never crawl URLs matching <glob>; repeatable\n"
+              << "  --strip-param <name>     Also drop query parameter <name> ('*' suffix matches any ending); repeatable\n"
+              << "  --max-per-pattern <n>    URLs admitted per URL pattern before it counts as a crawler trap (default: 5000)\n"
+              << "  --trap-log <file>        Write every link dropped as a crawler trap to <file>, with the reason\n"
+              << "  --no-trap-detection      Follow every link however generated its URL looks\n"
+              << "  --sitemap <url>          Seed the frontier from this sitemap or sitemap index; repeatable\n"
+              << "  --no-sitemaps            Do not look for sitemaps in robots.txt and the usual locations\n"
+              << "  --dns-server <ip[:port]> Resolve hosts with this DNS server instead of the system resolver; repeatable\n"
+              << "  --no-dns-prefetch        Let curl resolve each host when it is fetched\n"
+              << "  --state <file>           Keep per-URL fetch history in <file> across runs\n"
+              << "  --recrawl                Crawl continuously, revisiting pages as often as they change\n"
+              << "  --budget <pages/s>       Fetch rate of --recrawl (default: 1)\n"
+              << "  --duration <s>           Stop --recrawl after <s> seconds (default: until Ctrl-C)\n"
+              << "  --min-revisit <s>        Shortest interval between fetches of a page (default: 300)\n"
+              << "  --memory <MB>            Slow the crawl and spill the frontier to disk past this much memory\n"
               << "  --delay <ms>             Delay between requests in ms (default: 1000)\n"
               << "  --help                   Show this help message\n"
               << "\nIf parameters are not provided, you will be prompted to enter them.\n";
 }
 
+// "out.json" + ".csv" -> "out.csv"; names without ".json" just get the suffix appended
+std::string siblingFile(const std::string& filename, const std::string& suffix) {
+    std::string sibling = filename;
+    if (sibling.find(".json") != std::string::npos) {
+        sibling.replace(sibling.find(".json"), 5, suffix);
+    } else {
+        sibling += suffix;
+    }
+    return sibling;
+}
+
 std::string promptForUrl() {
     std::string url;
     std::cout << "Enter the starting URL to crawl: ";
@@ -72,6 +118,15 @@ std::string promptForOutput() {
     return output.empty() ? "crawl_results.json" : output;
 }
 
+// Set while a continuous crawl runs, so Ctrl-C can end it cleanly
+WebCrawler* activeCrawler = nullptr;
+
+void handleStopSignal(int) {
+    if (activeCrawler) {
+        activeCrawler->requestStop();
+    }
+}
+
 int main(int argc, char* argv[]) {
     std::string startUrl;
     int maxDepth = -1;  // Use -1 to indicate not set
@@ -79,6 +134,32 @@ int main(int argc, char* argv[]) {
     int numThreads = -1;
     int delay = -1;
     std::string outputFile;
+    std::string graphFile;
+    std::string pathTarget;
+    std::string streamFile;
+    std::string warcPrefix;
+    int warcLevel = WarcWriter::Options{}.compressionLevel;
+    std::string storeDirectory;
+    std::string metricsFile;
+    std::string traceFile;
+    double traceSampleRate = 1.0;
+    std::vector<std::string> allowedHosts;
+    std::vector<std::string> includePatterns;
+    std::vector<std::string> excludePatterns;
+    std::vector<std::string> stripParams;
+    std::vector<std::string> dnsServers;
+    std::vector<std::string> sitemapUrls;
+    bool discoverSitemaps = true;
+    bool dnsPrefetch = true;
+    std::string stateFile;
+    bool recrawl = false;
+    double recrawlBudget = 1.0;
+    int recrawlDuration = 0;
+    int minRevisit = 300;
+    size_t memoryMb = 0;
+    bool trapDetection = true;
+    size_t maxPerPattern = 5000;
+    std::string trapLog;
 
     bool urlProvided = false;
     bool depthProvided = false;
@@ -116,6 +197,102 @@ int main(int argc, char* argv[]) {
                 outputFile = argv[++i];
                 outputProvided = true;
             }
+        } else if (arg == "-g" || arg == "--graph") {
+            if (i + 1 < argc) {
+                graphFile = argv[++i];
+            }
+        } else if (arg == "-s" || arg == "--stream") {
+            if (i + 1 < argc) {
+                streamFile = argv[++i];
+            }
+        } else if (arg == "--store") {
+            if (i + 1 < argc) {
+                storeDirectory = argv[++i];
+            }
+        } else if (arg == "--warc") {
+            if (i + 1 < argc) {
+                warcPrefix = argv[++i];
+            }
+        } else if (arg == "--warc-level") {
+            if (i + 1 < argc) {
+                warcLevel = std::stoi(argv[++i]);
+            }
+        } else if (arg == "--metrics") {
+            if (i + 1 < argc) {
+                metricsFile = argv[++i];
+            }
+        } else if (arg == "--trace") {
+            if (i + 1 < argc) {
+                traceFile = argv[++i];
+            }
+        } else if (arg == "--trace-sample") {
+            if (i + 1 < argc) {
+                traceSampleRate = std::stod(argv[++i]);
+            }
+        } else if (arg == "--allow-host") {
+            if (i + 1 < argc) {
+                allowedHosts.emplace_back(argv[++i]);
+            }
+        } else if (arg == "--include") {
+            if (i + 1 < argc) {
+                includePatterns.emplace_back(argv[++i]);
+            }
+        } else if (arg == "--exclude") {
+            if (i + 1 < argc) {
+                excludePatterns.emplace_back(argv[++i]);
+            }
+        } else if (arg == "--strip-param") {
+            if (i + 1 < argc) {
+                stripParams.emplace_back(argv[++i]);
+            }
+        } else if (arg == "--sitemap") {
+            if (i + 1 < argc) {
+                sitemapUrls.emplace_back(argv[++i]);
+            }
+        } else if (arg == "--no-sitemaps") {
+            discoverSitemaps = false;
+        } else if (arg == "--dns-server") {
+            if (i + 1 < argc) {
+                dnsServers.emplace_back(argv[++i]);
+            }
+        } else if (arg == "--no-dns-prefetch") {
+            dnsPrefetch = false;
+        } else if (arg == "--state") {
+            if (i + 1 < argc) {
+                stateFile = argv[++i];
+            }
+        } else if (arg == "--recrawl") {
+            recrawl = true;
+        } else if (arg == "--budget") {
+            if (i + 1 < argc) {
+                recrawlBudget = std::stod(argv[++i]);
+            }
+        } else if (arg == "--duration") {
+            if (i + 1 < argc) {
+                recrawlDuration = std::stoi(argv[++i]);
+            }
+        } else if (arg == "--min-revisit") {
+            if (i + 1 < argc) {
+                minRevisit = std::stoi(argv[++i]);
+            }
+        } else if (arg == "--max-per-pattern") {
+            if (i + 1 < argc) {
+                maxPerPattern = std::stoul(argv[++i]);
+            }
+        } else if (arg == "--trap-log") {
+            if (i + 1 < argc) {
+                trapLog = argv[++i];
+            }
+        } else if (arg == "--no-trap-detection") {
+            trapDetection = false;
+        } else if (arg == "--memory") {
+            if (i + 1 < argc) {
+                memoryMb = std::stoul(argv[++i]);
+            }
+        } else if (arg == "--path") {
+            if (i + 1 < argc) {
+                pathTarget = argv[++i];
+            }
         } else if (arg == "--delay") {
             if (i + 1 < argc) {
                 delay = std::stoi(argv[++i]);
@@ -170,51 +347,210 @@ int main(int argc, char* argv[]) {
         config.maxPages = maxPages;
         config.maxDepth = maxDepth;
         config.delayBetweenRequests = std::chrono::milliseconds(delay);
+        config.metricsFile = metricsFile;
+        config.traceFile = traceFile;
+        config.traceSampleRate = traceSampleRate;
+        config.allowedHosts = allowedHosts;
+        config.includePatterns = includePatterns;
+        config.excludePatterns = excludePatterns;
+        config.stripQueryParams.insert(config.stripQueryParams.end(), stripParams.begin(), stripParams.end());
+        config.dnsServers = dnsServers;
+        config.sitemapUrls = sitemapUrls;
+        config.discoverSitemaps = discoverSitemaps;
+        config.dnsPrefetch = dnsPrefetch;
+        config.stateFile = stateFile;
+        config.continuous = recrawl;
+        config.recrawlPagesPerSecond = recrawlBudget;
+        config.recrawlDuration = std::chrono::seconds(recrawlDuration);
+        config.recrawlMinInterval = std::chrono::seconds(minRevisit);
+        config.memoryBudget = memoryMb * 1024 * 1024;
+        config.trapDetection = trapDetection;
+        config.trapMaxPerPattern = maxPerPattern;
+        config.trapLogFile = trapLog;
 
         std::vector<WebCrawler::CrawlResult> results;
+        LinkGraphBuilder graphBuilder;
+
+        // In streaming mode records go straight to disk instead of piling up in results
+        std::unique_ptr<StreamingExport> stream;
+        if (!streamFile.empty()) {
+            StreamingExport::Options streamOptions;
+            streamOptions.format = StreamingExport::formatForFile(streamFile);
+            stream = std::make_unique<StreamingExport>(streamFile, streamOptions);
+        }
+
+        std::unique_ptr<WarcWriter> warc;
+        if (!warcPrefix.empty()) {
+            WarcWriter::Options warcOptions;
+            warcOptions.userAgent = config.httpConfig.userAgent;
+            warcOptions.compressionLevel = warcLevel;
+            warc = std::make_unique<WarcWriter>(warcPrefix, warcOptions);
+        }
+
+        std::unique_ptr<PageStoreWriter> store;
+        if (!storeDirectory.empty()) {
+            store = std::make_unique<PageStoreWriter>(storeDirectory);
+        }
 
         WebCrawler crawler(config);
         crawler.setThreadCount(numThreads);
 
-        crawler.setCrawlCallback([&results](const WebCrawler::CrawlResult& result) {
-            std::cout << "Crawled: " << result.url
-                      << " | Status: " << result.statusCode
-                      << " | Links: " << result.extractedLinks.size() << std::endl;
-            results.push_back(result);
+        // Archiving and the page store are thread-safe, so bodies are compressed on the
+        // workers that fetched them rather than on the consumer thread
+        if (warc || store) {
+            crawler.setWorkerCallback([&warc, &store](const WebCrawler::CrawlResult& result) {
+                if (warc) warc->write(result);
+                if (store && result.success && result.statusCode == 200) {
+                    // Both names share the one stored body, counted once
+                    store->put(result.fetchedUrl(), result.content);
+                    if (result.fetchedUrl() != result.url) store->alias(result.url, result.fetchedUrl());
+                }
+            });
+        }
+
+        // Batches arrive on the crawler's consumer thread, so no locking is needed here
+        // A continuous crawl never ends on its own, so its results are only kept when streamed
+        const bool keepResults = !recrawl;
+        crawler.setBatchCallback([&results, &graphBuilder, &stream, &crawler, keepResults](std::vector<WebCrawler::CrawlResult>& batch) {
+            for (auto& result : batch) {
+                std::cout << "Crawled: " << result.url
+                          << " | Status: " << result.statusCode
+                          << " | Links: " << result.extractedLinks.size() << std::endl;
+                // Each redirect hop is an edge of its own; the links belong to the final URL
+                for (const auto& redirect : result.redirects) {
+                    graphBuilder.addPage(redirect.from, {redirect.to});
+                }
+                graphBuilder.addPage(result.fetchedUrl(), result.extractedLinks);
+                if (stream) {
+                    stream->write(result);
+                } else if (keepResults) {
+                    // Kept results only feed the exports, which need no bodies or link lists;
+                    // what is left is charged to the crawler's memory budget
+                    result.compact();
+                    crawler.memory().charge(MemoryBudget::Account::Results, result.memoryUsage());
+                    results.push_back(std::move(result));
+                }
+            }
         });
 
         std::cout << "\n=== Starting Crawl ===\n";
         std::cout << "URL: " << startUrl << std::endl;
         std::cout << "Max pages: " << maxPages << ", Max depth: " << maxDepth
                   << ", Threads: " << numThreads << ", Delay: " << delay << "ms" << std::endl;
-        std::cout << "Output file: " << outputFile << std::endl;
-
-        if (numThreads > 1) {
+        std::cout << "Output file: " << (stream ? streamFile : outputFile) << std::endl;
+
+        if (recrawl) {
+            activeCrawler = &crawler;
+            std::signal(SIGINT, handleStopSignal);
+            std::signal(SIGTERM, handleStopSignal);
+            crawler.startContinuous();
+            std::signal(SIGINT, SIG_DFL);
+            std::signal(SIGTERM, SIG_DFL);
+            activeCrawler = nullptr;
+        } else if (numThreads > 1) {
             crawler.startMultiThreaded();
         } else {
             crawler.start();
         }
 
+        const size_t pagesCrawled = stream ? stream->recordsWritten() : results.size();
+        if (stream) {
+            stream->close();
+        }
+        if (warc) {
+            warc->close();
+            std::cout << "WARC records written: " << warc->recordsWritten() << std::endl;
+        }
+        if (store) {
+            store->close();
+            const auto stats = store->stats();
+            std::cout << "Page store: " << stats.pages << " pages, " << stats.bodies << " distinct bodies, "
+                      << MemoryBudget::formatBytes(stats.rawBytes) << " stored in "
+                      << MemoryBudget::formatBytes(stats.storedBytes) << std::endl;
+        }
+
         std::cout << "\n=== Crawl Summary ===\n";
-        std::cout << "Total pages crawled: " << results.size() << std::endl;
+        std::cout << "Total pages crawled: " << pagesCrawled << std::endl;
+
+        CsrGraph graph = graphBuilder.finalize();
+        if (pagesCrawled > 0) {
+            PageRank::Options rankOptions;
+            rankOptions.threads = static_cast<size_t>(numThreads);
+            const auto ranks = PageRank::compute(graph, rankOptions);
+            const auto weak = GraphComponents::weak(graph, rankOptions.threads);
+            const auto strong = GraphComponents::strong(graph, rankOptions.threads);
+
+            GraphBfs::Options bfsOptions;
+            bfsOptions.threads = rankOptions.threads;
+            std::vector<CsrGraph::NodeId> seeds;
+            for (const auto& seedUrl : crawler.seedUrls()) {
+                if (auto node = graph.findNode(seedUrl)) seeds.push_back(*node);
+            }
+            const auto depths = GraphBfs::run(graph, seeds, bfsOptions);
+
+            std::cout << "PageRank: " << ranks.iterations << " iterations, residual " << ranks.residual
+                      << " (" << ranks.elapsed.count() << "s)" << std::endl;
+            std::cout << "Components: " << weak.count() << " weak, " << strong.count() << " strong ("
+                      << strong.singletonCount() << " single-page)" << std::endl;
 
-        if (!results.empty()) {
-            CrawlExport::exportToJSON(results, outputFile);
-            std::cout << "Results exported to: " << outputFile << std::endl;
+            std::string componentsFile;
+            if (stream) {
+                std::cout << "Results streamed to: " << streamFile << std::endl;
 
-            // Also create CSV
-            std::string csvFile = outputFile;
-            if (csvFile.find(".json") != std::string::npos) {
-                csvFile.replace(csvFile.find(".json"), 5, ".csv");
+                const std::string analysisFile = siblingFile(streamFile, ".analysis.csv");
+                CrawlExport::exportGraphAnalysis(graph, ranks.scores, weak, strong, depths.depth, analysisFile);
+                std::cout << "Per-page graph analysis saved to: " << analysisFile << std::endl;
+                componentsFile = siblingFile(streamFile, ".components.json");
             } else {
-                csvFile += ".csv";
+                for (auto& result : results) {
+                    if (auto node = graph.findNode(result.fetchedUrl())) {
+                        result.pageRank = ranks.scores[*node];
+                        result.weakComponent = weak.labels[*node];
+                        result.strongComponent = strong.labels[*node];
+                        result.clickDepth = depths.depth[*node];
+                    }
+                }
+
+                CrawlExport::exportToJSON(results, outputFile);
+                std::cout << "Results exported to: " << outputFile << std::endl;
+
+                // Also create CSV
+                const std::string csvFile = siblingFile(outputFile, ".csv");
+                CrawlExport::exportToCSV(results, csvFile);
+                std::cout << "CSV export saved to: " << csvFile << std::endl;
+                componentsFile = siblingFile(outputFile, ".components.json");
             }
-            CrawlExport::exportToCSV(results, csvFile);
-            std::cout << "CSV export saved to: " << csvFile << std::endl;
+
+            CrawlExport::exportComponentSummary(weak, strong, componentsFile);
+            std::cout << "Component summary saved to: " << componentsFile << std::endl;
+        } else if (!keepResults && !stream) {
+            std::cout << "Continuous crawl results are not kept; use --stream to record them." << std::endl;
         } else {
             std::cout << "No pages were successfully crawled." << std::endl;
         }
 
+        if (!pathTarget.empty()) {
+            // Graph nodes are named by canonical URL, so both ends are looked up that way
+            const auto& canonicalizer = crawler.canonicalizer();
+            const auto path = GraphBfs::shortestPath(graph, canonicalizer.canonicalize(startUrl).value_or(startUrl),
+                                                     canonicalizer.canonicalize(pathTarget).value_or(pathTarget),
+                                                     static_cast<size_t>(numThreads));
+            if (path.empty()) {
+                std::cout << "No click path from " << startUrl << " to " << pathTarget << std::endl;
+            } else {
+                std::cout << "Click path (" << path.size() - 1 << " clicks):" << std::endl;
+                for (const auto& url : path) {
+                    std::cout << "  " << url << std::endl;
+                }
+            }
+        }
+
+        if (!graphFile.empty()) {
+            graph.save(graphFile);
+            std::cout << "Link graph (" << graph.nodeCount() << " nodes, " << graph.edgeCount()
+                      << " edges) saved to: " << graphFile << std::endl;
+        }
+
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
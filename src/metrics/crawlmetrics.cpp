@@ -0,0 +1,211 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#include "crawlmetrics.h"
+#include "../util/memorybudget.h"
+#include <bit>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+size_t LatencyHistogram::bucketFor(uint64_t value) {
+    if (value < 32) return static_cast<size_t>(value);
+    const int msb = std::bit_width(value) - 1;  // 5..63
+    const int shift = msb - 4;
+    return 32 + static_cast<size_t>(msb - 5) * 16 + static_cast<size_t>((value >> shift) - 16);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t bucket) {
+    if (bucket < 32) return bucket;
+    const size_t octave = (bucket - 32) / 16;
+    const uint64_t sub = (bucket - 32) % 16;
+    const int shift = static_cast<int>(octave) + 1;
+    return ((16 + sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value) {
+    buckets_[bucketFor(value)].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::mergeFrom(const LatencyHistogram& other) {
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        const uint64_t n = other.buckets_[i].load(std::memory_order_relaxed);
+        if (n) buckets_[i].fetch_add(n, std::memory_order_relaxed);
+    }
+    sum_.fetch_add(other.sum(), std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::count() const {
+    uint64_t total = 0;
+    for (const auto& bucket : buckets_) {
+        total += bucket.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t LatencyHistogram::quantile(double q) const {
+    const uint64_t total = count();
+    if (total == 0) return 0;
+
+    const auto rank = static_cast<uint64_t>(q * static_cast<double>(total - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) return bucketUpperBound(i);
+    }
+    return bucketUpperBound(BUCKET_COUNT - 1);
+}
+
+CrawlMetrics::CrawlMetrics() : startTime_(std::chrono::steady_clock::now()) {
+    setWorkerCount(1);
+}
+
+CrawlMetrics::~CrawlMetrics() {
+    stopReporting();
+}
+
+void CrawlMetrics::setWorkerCount(size_t workers) {
+    // Shards are only ever added, so totals survive a second crawl on the same crawler
+    while (shards_.size() < workers) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+}
+
+void CrawlMetrics::beginHostRequest(const std::string& host) {
+    std::lock_guard<std::mutex> lock(hostMutex_);
+    ++hostInFlight_[host];
+}
+
+void CrawlMetrics::endHostRequest(const std::string& host) {
+    std::lock_guard<std::mutex> lock(hostMutex_);
+    auto it = hostInFlight_.find(host);
+    if (it != hostInFlight_.end() && --it->second <= 0) {
+        hostInFlight_.erase(it);
+    }
+}
+
+uint64_t CrawlMetrics::total(Counter counter) const {
+    uint64_t sum = 0;
+    for (const auto& shard : shards_) {
+        sum += shard->counters[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+LatencyHistogram CrawlMetrics::merged(Stage stage) const {
+    LatencyHistogram histogram;
+    for (const auto& shard : shards_) {
+        histogram.mergeFrom(shard->stages[static_cast<size_t>(stage)]);
+    }
+    return histogram;
+}
+
+std::string CrawlMetrics::toPrometheus() const {
+    static constexpr const char* stageNames[] = {
+        "dns", "connect", "tls", "first_byte", "total", "parse"
+    };
+    static constexpr const char* counterNames[] = {
+        "pages", "errors", "downloaded_bytes", "links_extracted", "revisits", "unchanged_revisits", "trap_dropped_urls",
+        "canonicalized_links", "canonical_duplicates", "redirects_followed", "redirect_duplicates"
+    };
+
+    std::ostringstream out;
+    const double uptime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime_).count();
+
+    for (size_t c = 0; c < static_cast<size_t>(Counter::Count); ++c) {
+        out << "# TYPE webcrawler_" << counterNames[c] << "_total counter\n"
+            << "webcrawler_" << counterNames[c] << "_total " << total(static_cast<Counter>(c)) << "\n";
+    }
+
+    out << "# TYPE webcrawler_stage_seconds summary\n";
+    for (size_t s = 0; s < static_cast<size_t>(Stage::Count); ++s) {
+        const LatencyHistogram histogram = merged(static_cast<Stage>(s));
+        for (double q : {0.5, 0.9, 0.99}) {
+            out << "webcrawler_stage_seconds{stage=\"" << stageNames[s] << "\",quantile=\"" << q << "\"} "
+                << static_cast<double>(histogram.quantile(q)) / 1e6 << "\n";
+        }
+        out << "webcrawler_stage_seconds_sum{stage=\"" << stageNames[s] << "\"} "
+            << static_cast<double>(histogram.sum()) / 1e6 << "\n"
+            << "webcrawler_stage_seconds_count{stage=\"" << stageNames[s] << "\"} " << histogram.count() << "\n";
+    }
+
+    out << "# TYPE webcrawler_frontier_urls gauge\n"
+        << "webcrawler_frontier_urls " << frontierSize_.load(std::memory_order_relaxed) << "\n"
+        << "# TYPE webcrawler_frontier_spilled_urls gauge\n"
+        << "webcrawler_frontier_spilled_urls " << spilledCount_.load(std::memory_order_relaxed) << "\n"
+        << "# TYPE webcrawler_visited_urls gauge\n"
+        << "webcrawler_visited_urls " << visitedCount_.load(std::memory_order_relaxed) << "\n"
+        << "# TYPE webcrawler_uptime_seconds gauge\n"
+        << "webcrawler_uptime_seconds " << uptime << "\n"
+        << "# TYPE webcrawler_pages_per_second gauge\n"
+        << "webcrawler_pages_per_second "
+        << (uptime > 0 ? static_cast<double>(total(Counter::Pages)) / uptime : 0.0) << "\n";
+
+    if (memory_) {
+        out << "# TYPE webcrawler_memory_bytes gauge\n";
+        for (size_t a = 0; a < static_cast<size_t>(MemoryBudget::Account::Count); ++a) {
+            const auto account = static_cast<MemoryBudget::Account>(a);
+            out << "webcrawler_memory_bytes{account=\"" << MemoryBudget::accountName(account) << "\"} "
+                << memory_->usage(account) << "\n";
+        }
+        out << "# TYPE webcrawler_memory_limit_bytes gauge\n"
+            << "webcrawler_memory_limit_bytes " << memory_->limit() << "\n"
+            << "# TYPE webcrawler_memory_pressure gauge\n"
+            << "webcrawler_memory_pressure " << static_cast<int>(memory_->pressure()) << "\n";
+    }
+
+    out << "# TYPE webcrawler_host_in_flight gauge\n";
+    {
+        std::lock_guard<std::mutex> lock(hostMutex_);
+        for (const auto& [host, inFlight] : hostInFlight_) {
+            out << "webcrawler_host_in_flight{host=\"" << host << "\"} " << inFlight << "\n";
+        }
+    }
+
+    return out.str();
+}
+
+void CrawlMetrics::writeFile(const std::string& filename) const {
+    const std::string temporary = filename + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::trunc);
+        file << toPrometheus();
+    }
+    // Rename so readers never see a half-written file
+#ifdef _WIN32
+    std::remove(filename.c_str());  // rename() does not replace on Windows
+#endif
+    std::rename(temporary.c_str(), filename.c_str());
+}
+
+void CrawlMetrics::startReporting(const std::string& filename, std::chrono::milliseconds interval) {
+    stopReporting();
+    {
+        std::lock_guard<std::mutex> lock(reportMutex_);
+        reporting_ = true;
+    }
+
+    reporter_ = std::thread([this, filename, interval]() {
+        std::unique_lock<std::mutex> lock(reportMutex_);
+        while (reporting_) {
+            reportCv_.wait_for(lock, interval, [this] { return !reporting_; });
+            lock.unlock();
+            writeFile(filename);
+            lock.lock();
+        }
+    });
+}
+
+void CrawlMetrics::stopReporting() {
+    {
+        std::lock_guard<std::mutex> lock(reportMutex_);
+        if (!reporting_) return;
+        reporting_ = false;
+    }
+    reportCv_.notify_all();
+    if (reporter_.joinable()) {
+        reporter_.join();
+    }
+}
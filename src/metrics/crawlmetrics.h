@@ -0,0 +1,128 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class MemoryBudget;
+
+// Log-linear latency histogram in the spirit of HdrHistogram: values below 32 get
+// their own bucket, and every power of two above that is split into 16 buckets, so
+// any recorded value is within about 6% of its bucket. Recording is a single relaxed
+// atomic increment, safe from any thread.
+class LatencyHistogram
+{
+public:
+    static constexpr size_t BUCKET_COUNT = 32 + 59 * 16;
+
+    LatencyHistogram() = default;
+    // Snapshot copy; the source may still be recording
+    LatencyHistogram(const LatencyHistogram& other) { mergeFrom(other); }
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(uint64_t value);
+    // Adds other's counts to this histogram
+    void mergeFrom(const LatencyHistogram& other);
+
+    [[nodiscard]] uint64_t count() const;
+    [[nodiscard]] uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+    // Upper bound of the bucket holding the q-th quantile (q in [0, 1])
+    [[nodiscard]] uint64_t quantile(double q) const;
+
+    static size_t bucketFor(uint64_t value);
+    static uint64_t bucketUpperBound(size_t bucket);
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets_{};
+    std::atomic<uint64_t> sum_{0};
+};
+
+// Crawl instrumentation. Each worker thread records into its own cache-aligned shard,
+// so the hot path never contends; readers merge the shards when they export.
+class CrawlMetrics
+{
+public:
+    // Stage latencies in microseconds. The curl stages are measured from the start of
+    // the request, as curl reports them (connect includes DNS, and so on)
+    enum class Stage { Dns, Connect, Tls, FirstByte, Total, Parse, Count };
+    // Revisits are fetches of a URL already in the state store; Unchanged counts those
+    // whose content was the same as last time. TrapDropped counts links refused by the
+    // crawler-trap detector. LinksCanonicalized counts links whose canonical form differs
+    // from their plain resolution, CanonicalDuplicates those of them that canonicalization
+    // turned into an already visited URL, i.e. fetches it saved. Redirects counts redirect
+    // hops followed, RedirectDuplicates the chains cut short at an already visited target
+    enum class Counter {
+        Pages, Errors, BytesDownloaded, LinksExtracted, Revisits, Unchanged, TrapDropped, LinksCanonicalized,
+        CanonicalDuplicates, Redirects, RedirectDuplicates, Count
+    };
+
+    CrawlMetrics();
+
+    // Must be called before the worker threads start
+    void setWorkerCount(size_t workers);
+
+    void record(size_t worker, Stage stage, uint64_t micros) {
+        shards_[worker]->stages[static_cast<size_t>(stage)].record(micros);
+    }
+    void add(size_t worker, Counter counter, uint64_t amount = 1) {
+        shards_[worker]->counters[static_cast<size_t>(counter)].fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    void setFrontierSize(size_t size) { frontierSize_.store(size, std::memory_order_relaxed); }
+    void setVisitedCount(size_t count) { visitedCount_.store(count, std::memory_order_relaxed); }
+    // Frontier URLs held on disk rather than in memory, included in the frontier size
+    void setSpilledCount(size_t count) { spilledCount_.store(count, std::memory_order_relaxed); }
+    // Exports the budget's per-account usage; it must outlive the reporting
+    void setMemoryBudget(const MemoryBudget* budget) { memory_ = budget; }
+    void beginHostRequest(const std::string& host);
+    void endHostRequest(const std::string& host);
+
+    [[nodiscard]] uint64_t total(Counter counter) const;
+    [[nodiscard]] LatencyHistogram merged(Stage stage) const;
+
+    // Metrics in the Prometheus text exposition format
+    [[nodiscard]] std::string toPrometheus() const;
+
+    // Writes toPrometheus() to filename (via a temporary file and rename) every interval
+    // until stopReporting(), plus once more on stop. The file suits node_exporter's
+    // textfile collector or a plain `cat`.
+    void startReporting(const std::string& filename, std::chrono::milliseconds interval);
+    void stopReporting();
+
+    ~CrawlMetrics();
+
+private:
+    struct alignas(64) Shard {
+        std::array<LatencyHistogram, static_cast<size_t>(Stage::Count)> stages;
+        std::array<std::atomic<uint64_t>, static_cast<size_t>(Counter::Count)> counters{};
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::chrono::steady_clock::time_point startTime_;
+
+    std::atomic<size_t> frontierSize_{0};
+    std::atomic<size_t> visitedCount_{0};
+    std::atomic<size_t> spilledCount_{0};
+    const MemoryBudget* memory_ = nullptr;
+
+    mutable std::mutex hostMutex_;
+    std::map<std::string, int> hostInFlight_;
+
+    std::mutex reportMutex_;
+    std::condition_variable reportCv_;
+    bool reporting_ = false;
+    std::thread reporter_;
+
+    void writeFile(const std::string& filename) const;
+};
@@ -0,0 +1,112 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#include "crawltrace.h"
+#include "../export/serializer.h"
+#include <cmath>
+#include <functional>
+
+void CrawlTrace::enable(const Options& options, size_t threads) {
+    options_ = options;
+    if (options_.sampleRate >= 1.0) {
+        sampleThreshold_ = UINT64_MAX;
+    } else if (options_.sampleRate <= 0.0) {
+        sampleThreshold_ = 0;
+    } else {
+        sampleThreshold_ = static_cast<uint64_t>(std::ldexp(options_.sampleRate, 64));
+    }
+    while (buffers_.size() < threads) {
+        auto buffer = std::make_unique<Buffer>();
+        buffer->threadName = "thread " + std::to_string(buffers_.size());
+        buffers_.push_back(std::move(buffer));
+    }
+    if (!enabled_) {
+        origin_ = Clock::now();
+    }
+    enabled_ = true;
+}
+
+bool CrawlTrace::sampled(std::string_view url) const {
+    if (!enabled_) return false;
+    if (sampleThreshold_ == UINT64_MAX) return true;
+
+    // Finalise the hash so the threshold comparison sees well-mixed high bits
+    uint64_t h = std::hash<std::string_view>{}(url);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h < sampleThreshold_;
+}
+
+void CrawlTrace::nameThread(size_t thread, std::string name) {
+    buffers_[thread]->threadName = std::move(name);
+}
+
+void CrawlTrace::record(size_t thread, const char* name, Clock::time_point start, Clock::time_point end,
+                        std::string_view detail) {
+    Buffer& buffer = *buffers_[thread];
+    if (buffer.events.size() >= options_.maxEventsPerThread) {
+        ++buffer.dropped;
+        return;
+    }
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    buffer.events.push_back({name, duration_cast<microseconds>(start - origin_).count(),
+                             duration_cast<microseconds>(end - start).count(), std::string(detail)});
+}
+
+size_t CrawlTrace::eventCount() const {
+    size_t total = 0;
+    for (const auto& buffer : buffers_) total += buffer->events.size();
+    return total;
+}
+
+size_t CrawlTrace::droppedCount() const {
+    size_t total = 0;
+    for (const auto& buffer : buffers_) total += buffer->dropped;
+    return total;
+}
+
+void CrawlTrace::write(const std::string& filename) const {
+    BlockWriter writer(filename);
+    std::string& out = writer.buffer();
+    out += "{\"traceEvents\":[\n";
+    out += R"({"name":"process_name","ph":"M","pid":1,"tid":0,"args":{"name":"WebCrawler"}})";
+
+    for (size_t tid = 0; tid < buffers_.size(); ++tid) {
+        const Buffer& buffer = *buffers_[tid];
+        out += ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":";
+        Serializer::appendNumber(out, tid);
+        out += ",\"args\":{\"name\":";
+        Serializer::appendJsonString(out, buffer.threadName);
+        out += "}}";
+
+        for (const auto& event : buffer.events) {
+            out += ",\n{\"name\":\"";
+            out += event.name;
+            out += "\",\"cat\":\"crawl\",\"ph\":\"X\",\"pid\":1,\"tid\":";
+            Serializer::appendNumber(out, tid);
+            out += ",\"ts\":";
+            Serializer::appendNumber(out, event.start);
+            out += ",\"dur\":";
+            Serializer::appendNumber(out, event.duration);
+            if (!event.detail.empty()) {
+                out += ",\"args\":{\"url\":";
+                Serializer::appendJsonString(out, event.detail);
+                out += '}';
+            }
+            out += '}';
+            writer.commit();
+        }
+    }
+
+    out += "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"sample_rate\":";
+    Serializer::appendNumber(out, options_.sampleRate);
+    out += ",\"dropped_spans\":";
+    Serializer::appendNumber(out, droppedCount());
+    out += "}}\n";
+    writer.close();
+}
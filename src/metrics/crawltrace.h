@@ -0,0 +1,85 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Span timeline of a crawl, written as Chrome trace-event JSON (chrome://tracing, Perfetto).
+// Every thread appends to its own buffer, so recording takes no locks; the buffers are only
+// read by write(), after the threads have finished. Sampling is decided per URL from a hash
+// of the URL, so a sampled URL keeps all of its stage spans and an unsampled one costs a
+// single branch per stage.
+class CrawlTrace
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        double sampleRate = 1.0;               // Fraction of URLs traced
+        size_t maxEventsPerThread = 1 << 20;   // Further spans are counted as dropped
+    };
+
+    // Records [start of scope, end of scope) on destruction if active
+    class Span {
+    public:
+        Span(CrawlTrace& trace, size_t thread, const char* name, bool active)
+            : trace_(active ? &trace : nullptr), thread_(thread), name_(name),
+              start_(active ? Clock::now() : Clock::time_point{}) {}
+        ~Span() {
+            if (trace_) trace_->record(thread_, name_, start_, Clock::now());
+        }
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+    private:
+        CrawlTrace* trace_;
+        size_t thread_;
+        const char* name_;
+        Clock::time_point start_;
+    };
+
+    CrawlTrace() = default;
+
+    // Turns tracing on with one buffer per thread index; must be called before those threads start
+    void enable(const Options& options, size_t threads);
+    [[nodiscard]] bool enabled() const { return enabled_; }
+    [[nodiscard]] bool sampled(std::string_view url) const;
+
+    void nameThread(size_t thread, std::string name);
+    // name must outlive the trace (a string literal); detail becomes the span's "url" argument
+    void record(size_t thread, const char* name, Clock::time_point start, Clock::time_point end,
+                std::string_view detail = {});
+
+    [[nodiscard]] size_t eventCount() const;
+    [[nodiscard]] size_t droppedCount() const;
+
+    // Writes every buffered span; call once the recording threads have stopped
+    void write(const std::string& filename) const;
+
+private:
+    struct Event {
+        const char* name;
+        int64_t start;     // Microseconds since enable()
+        int64_t duration;
+        std::string detail;
+    };
+
+    struct alignas(64) Buffer {
+        std::string threadName;
+        std::vector<Event> events;
+        size_t dropped = 0;
+    };
+
+    bool enabled_ = false;
+    Options options_;
+    uint64_t sampleThreshold_ = 0;
+    Clock::time_point origin_;
+    std::vector<std::unique_ptr<Buffer>> buffers_;
+};
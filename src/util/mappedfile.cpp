@@ -0,0 +1,118 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#include "mappedfile.h"
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& filename)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Failed to open file: " + filename);
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        throw std::runtime_error("Failed to stat file: " + filename);
+    }
+
+    fileHandle_ = file;
+    size_ = static_cast<size_t>(fileSize.QuadPart);
+    opened_ = true;
+    if (size_ == 0) return;
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        close();
+        throw std::runtime_error("Failed to map file: " + filename);
+    }
+    mappingHandle_ = mapping;
+
+    data_ = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!data_) {
+        close();
+        throw std::runtime_error("Failed to map file: " + filename);
+    }
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open file: " + filename);
+    }
+
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Failed to stat file: " + filename);
+    }
+
+    size_ = static_cast<size_t>(st.st_size);
+    opened_ = true;
+    if (size_ > 0) {
+        void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapped == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Failed to map file: " + filename);
+        }
+        data_ = static_cast<const char*>(mapped);
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    ::close(fd);
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other) {
+        close();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        opened_ = std::exchange(other.opened_, false);
+#ifdef _WIN32
+        fileHandle_ = std::exchange(other.fileHandle_, nullptr);
+        mappingHandle_ = std::exchange(other.mappingHandle_, nullptr);
+#endif
+    }
+    return *this;
+}
+
+void MappedFile::close()
+{
+#ifdef _WIN32
+    if (data_) UnmapViewOfFile(data_);
+    if (mappingHandle_) CloseHandle(mappingHandle_);
+    if (fileHandle_) CloseHandle(fileHandle_);
+    mappingHandle_ = nullptr;
+    fileHandle_ = nullptr;
+#else
+    if (data_) ::munmap(const_cast<char*>(data_), size_);
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    opened_ = false;
+}
@@ -0,0 +1,36 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#pragma once
+#include <string>
+#include <cstddef>
+
+// Read-only memory mapping of a whole file. Move-only; unmaps on destruction.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    [[nodiscard]] const char* data() const { return data_; }
+    [[nodiscard]] size_t size() const { return size_; }
+    [[nodiscard]] bool isOpen() const { return opened_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool opened_ = false;
+#ifdef _WIN32
+    void* fileHandle_ = nullptr;
+    void* mappingHandle_ = nullptr;
+#endif
+
+    void close();
+};
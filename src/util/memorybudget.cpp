@@ -0,0 +1,94 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#include "memorybudget.h"
+#include <cstdio>
+
+MemoryBudget::MemoryBudget(size_t limit, double highWater) {
+    setLimit(limit, highWater);
+}
+
+void MemoryBudget::setLimit(size_t limit, double highWater) {
+    limit_ = limit;
+    highWater_ = static_cast<size_t>(static_cast<double>(limit) * highWater);
+}
+
+void MemoryBudget::charge(Account account, size_t bytes) {
+    accounts_[static_cast<size_t>(account)].fetch_add(bytes, std::memory_order_relaxed);
+    raisePeak(total_.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+}
+
+void MemoryBudget::release(Account account, size_t bytes) {
+    accounts_[static_cast<size_t>(account)].fetch_sub(bytes, std::memory_order_relaxed);
+    total_.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void MemoryBudget::set(Account account, size_t bytes) {
+    const size_t previous = accounts_[static_cast<size_t>(account)].exchange(bytes, std::memory_order_relaxed);
+    if (bytes >= previous) {
+        const size_t grown = bytes - previous;
+        raisePeak(total_.fetch_add(grown, std::memory_order_relaxed) + grown);
+    } else {
+        total_.fetch_sub(previous - bytes, std::memory_order_relaxed);
+    }
+}
+
+void MemoryBudget::raisePeak(size_t now) {
+    size_t peak = peak_.load(std::memory_order_relaxed);
+    while (now > peak && !peak_.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {
+    }
+}
+
+MemoryBudget::Pressure MemoryBudget::pressure() const {
+    if (limit_ == 0) return Pressure::Normal;
+    const size_t used = total();
+    if (used >= limit_) return Pressure::Critical;
+    if (used >= highWater_) return Pressure::High;
+    return Pressure::Normal;
+}
+
+std::string MemoryBudget::summary() const {
+    std::string out;
+    for (size_t i = 0; i < static_cast<size_t>(Account::Count); ++i) {
+        if (i > 0) out += ", ";
+        out += accountName(static_cast<Account>(i));
+        out += ' ';
+        out += formatBytes(accounts_[i].load(std::memory_order_relaxed));
+    }
+    return out;
+}
+
+const char* MemoryBudget::accountName(Account account) {
+    switch (account) {
+        case Account::Frontier: return "frontier";
+        case Account::Visited: return "visited";
+        case Account::Bodies: return "bodies";
+        case Account::Results: return "results";
+        case Account::UrlState: return "url_state";
+        case Account::Count: break;
+    }
+    return "unknown";
+}
+
+size_t MemoryBudget::stringBytes(size_t length) {
+    // libstdc++ and MSVC keep 15 characters inline; longer strings allocate length + 1,
+    // rounded up to the allocator's 16-byte granularity
+    constexpr size_t INLINE_CAPACITY = 15;
+    if (length <= INLINE_CAPACITY) return sizeof(std::string);
+    return sizeof(std::string) + ((length + 1 + 15) & ~size_t{15});
+}
+
+std::string MemoryBudget::formatBytes(size_t bytes) {
+    char text[32];
+    if (bytes >= (size_t{1} << 30)) {
+        std::snprintf(text, sizeof(text), "%.2f GB", static_cast<double>(bytes) / (1 << 30));
+    } else if (bytes >= (size_t{1} << 20)) {
+        std::snprintf(text, sizeof(text), "%.1f MB", static_cast<double>(bytes) / (1 << 20));
+    } else if (bytes >= 1024) {
+        std::snprintf(text, sizeof(text), "%.1f KB", static_cast<double>(bytes) / 1024);
+    } else {
+        std::snprintf(text, sizeof(text), "%zu B", bytes);
+    }
+    return text;
+}
@@ -0,0 +1,56 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+// Byte accounting for the crawler's large in-memory structures against one limit. Each
+// subsystem charges what it holds to its own account; nothing is ever refused, and callers
+// react to pressure() instead, by throttling or spilling, so an overrun slows the crawl
+// down rather than failing it. Charging is a relaxed atomic add, safe from any thread.
+class MemoryBudget
+{
+public:
+    enum class Account { Frontier, Visited, Bodies, Results, UrlState, Count };
+    // High from highWater of the limit up; Critical at or over the limit
+    enum class Pressure { Normal, High, Critical };
+
+    // A zero limit means unlimited: usage is still tracked, pressure stays Normal
+    explicit MemoryBudget(size_t limit = 0, double highWater = 0.8);
+
+    void setLimit(size_t limit, double highWater = 0.8);
+
+    void charge(Account account, size_t bytes);
+    void release(Account account, size_t bytes);
+    // For accounts measured as a whole rather than charged piecemeal
+    void set(Account account, size_t bytes);
+
+    [[nodiscard]] size_t usage(Account account) const {
+        return accounts_[static_cast<size_t>(account)].load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] size_t total() const { return total_.load(std::memory_order_relaxed); }
+    [[nodiscard]] size_t peak() const { return peak_.load(std::memory_order_relaxed); }
+    [[nodiscard]] size_t limit() const { return limit_; }
+    [[nodiscard]] Pressure pressure() const;
+
+    // "frontier 1.2 MB, visited 300 KB, ..." for logs
+    [[nodiscard]] std::string summary() const;
+
+    static const char* accountName(Account account);
+    // Heap bytes behind a std::string of this length, counting the object itself
+    static size_t stringBytes(size_t length);
+    static std::string formatBytes(size_t bytes);
+
+private:
+    std::array<std::atomic<size_t>, static_cast<size_t>(Account::Count)> accounts_{};
+    std::atomic<size_t> total_{0};
+    std::atomic<size_t> peak_{0};
+    size_t limit_ = 0;
+    size_t highWater_ = 0;
+
+    void raisePeak(size_t now);
+};
@@ -0,0 +1,54 @@
+//
+// Created by docto on 10/19/2026.
+//
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Number of worker threads to use when the caller asks for `requested` (0 = all cores)
+inline size_t resolveThreadCount(size_t requested) {
+    if (requested > 0) return requested;
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Calls body(threadIndex, chunkBegin, chunkEnd) over [begin, end) split into chunks that
+// the threads claim from a shared counter, so uneven chunks balance themselves. The
+// calling thread works as thread 0; returns once every chunk is done.
+template <typename Body>
+void parallelForChunks(size_t threads, size_t begin, size_t end, Body&& body, size_t chunkSize = 1024) {
+    if (begin >= end) return;
+    threads = std::min(resolveThreadCount(threads), (end - begin + chunkSize - 1) / chunkSize);
+
+    std::atomic<size_t> next{begin};
+    auto worker = [&](size_t threadIndex) {
+        while (true) {
+            const size_t chunkBegin = next.fetch_add(chunkSize, std::memory_order_relaxed);
+            if (chunkBegin >= end) break;
+            body(threadIndex, chunkBegin, std::min(end, chunkBegin + chunkSize));
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads > 0 ? threads - 1 : 0);
+    for (size_t t = 1; t < threads; ++t) {
+        pool.emplace_back(worker, t);
+    }
+    worker(0);
+    for (auto& thread : pool) {
+        thread.join();
+    }
+}
+
+// Calls body(index) for every index in [begin, end)
+template <typename Body>
+void parallelFor(size_t threads, size_t begin, size_t end, Body&& body, size_t chunkSize = 1024) {
+    parallelForChunks(threads, begin, end, [&body](size_t, size_t chunkBegin, size_t chunkEnd) {
+        for (size_t i = chunkBegin; i < chunkEnd; ++i) {
+            body(i);
+        }
+    }, chunkSize);
+}